@@ -543,4 +543,114 @@ module mrv1_core
     );
     ////////////////////////////////////////////////////////////////////////////////
 
-endmodule
\ No newline at end of file
+`ifdef SIM_ENABLED
+    ////////////////////////////////////////////////////////////////////////////////
+    // Performance counters
+    ////////////////////////////////////////////////////////////////////////////////
+    logic [MRV_PERF_NUM-1:0][63:0]                          perf_cnt_q;
+    logic [NUM_THREADS_P-1:0][MRV_TH_PERF_NUM-1:0][63:0]    th_perf_cnt_q;
+    ////////////////////////////////////////////////////////////////////////////////
+    wire                     perf_sched_vld_w = if_i.sched_fetch_req_lo;
+    wire [TID_WIDTH_LP-1:0]  perf_sched_tid_w = if_i.sched_tid_lo;
+    wire [NUM_THREADS_P-1:0] perf_active_w    = if_i.th_sched_i.active_threads_q;
+    wire [NUM_THREADS_P-1:0] perf_stalled_w   = if_i.th_sched_i.stalled_threads_q & perf_active_w;
+    wire [NUM_THREADS_P-1:0] perf_ready_w     = perf_active_w & ~perf_stalled_w;
+    wire                     perf_issue_w     = |issue_fu_req_lo;
+    ////////////////////////////////////////////////////////////////////////////////
+    always_ff @(posedge clk_i) begin
+        if (rst_i) begin
+            perf_cnt_q      <= '0;
+            th_perf_cnt_q   <= '0;
+        end
+        else begin
+            perf_cnt_q[MRV_PERF_CYCLES] <= perf_cnt_q[MRV_PERF_CYCLES] + 1'b1;
+            ////////////////////////////////////////////////////////////////////////////////
+            if (perf_sched_vld_w)
+                perf_cnt_q[MRV_PERF_SCHED_USED] <= perf_cnt_q[MRV_PERF_SCHED_USED] + 1'b1;
+            else if (|perf_ready_w)
+                perf_cnt_q[MRV_PERF_SCHED_IDLE_REFILL] <= perf_cnt_q[MRV_PERF_SCHED_IDLE_REFILL] + 1'b1;
+            else if (|perf_stalled_w)
+                perf_cnt_q[MRV_PERF_SCHED_IDLE_STALLED] <= perf_cnt_q[MRV_PERF_SCHED_IDLE_STALLED] + 1'b1;
+            else
+                perf_cnt_q[MRV_PERF_SCHED_IDLE_NONE] <= perf_cnt_q[MRV_PERF_SCHED_IDLE_NONE] + 1'b1;
+            ////////////////////////////////////////////////////////////////////////////////
+            perf_cnt_q[MRV_PERF_IMEM_STALL] <= perf_cnt_q[MRV_PERF_IMEM_STALL] +
+                64'(imem_req_vld_o & ~imem_req_rdy_i);
+            perf_cnt_q[MRV_PERF_ISSUE_USED] <= perf_cnt_q[MRV_PERF_ISSUE_USED] +
+                64'(perf_issue_w);
+            perf_cnt_q[MRV_PERF_ISSUE_FU_BUSY] <= perf_cnt_q[MRV_PERF_ISSUE_FU_BUSY] +
+                64'(|(issue_fu_req_lo & ~exec_fu_rdy_lo));
+            perf_cnt_q[MRV_PERF_DMEM_STALL] <= perf_cnt_q[MRV_PERF_DMEM_STALL] +
+                64'(dmem_req_vld_o & ~dmem_req_rdy_i);
+            perf_cnt_q[MRV_PERF_BRANCH_REDIRECT] <= perf_cnt_q[MRV_PERF_BRANCH_REDIRECT] +
+                64'(exec_b_pc_vld_lo);
+            ////////////////////////////////////////////////////////////////////////////////
+            for (int i = 0; i < NUM_THREADS_P; i++) begin
+                th_perf_cnt_q[i][MRV_TH_PERF_RETIRED] <= th_perf_cnt_q[i][MRV_TH_PERF_RETIRED] +
+                    64'(ret_retire_cnt_lo[i]);
+                th_perf_cnt_q[i][MRV_TH_PERF_SCHED] <= th_perf_cnt_q[i][MRV_TH_PERF_SCHED] +
+                    64'(perf_sched_vld_w & (perf_sched_tid_w == TID_WIDTH_LP'(i)));
+                th_perf_cnt_q[i][MRV_TH_PERF_ACTIVE] <= th_perf_cnt_q[i][MRV_TH_PERF_ACTIVE] +
+                    64'(perf_active_w[i]);
+                th_perf_cnt_q[i][MRV_TH_PERF_STALLED] <= th_perf_cnt_q[i][MRV_TH_PERF_STALLED] +
+                    64'(perf_stalled_w[i]);
+                th_perf_cnt_q[i][MRV_TH_PERF_SLOT_WAIT] <= th_perf_cnt_q[i][MRV_TH_PERF_SLOT_WAIT] +
+                    64'(perf_ready_w[i] & ~(perf_sched_vld_w & (perf_sched_tid_w == TID_WIDTH_LP'(i))));
+                th_perf_cnt_q[i][MRV_TH_PERF_ISSUED] <= th_perf_cnt_q[i][MRV_TH_PERF_ISSUED] +
+                    64'(perf_issue_w & (issue_tid_lo == TID_WIDTH_LP'(i)));
+                th_perf_cnt_q[i][MRV_TH_PERF_IQ_FULL] <= th_perf_cnt_q[i][MRV_TH_PERF_IQ_FULL] +
+                    64'(~issue_i.iq_rdy_lo[i]);
+                th_perf_cnt_q[i][MRV_TH_PERF_RAW] <= th_perf_cnt_q[i][MRV_TH_PERF_RAW] +
+                    64'(|ret_rs_conflict_lo[i]);
+            end
+        end
+    end
+    ////////////////////////////////////////////////////////////////////////////////
+    // Retired instructions of all threads
+    ////////////////////////////////////////////////////////////////////////////////
+    logic [63:0] perf_instret_r;
+    always_comb begin
+        perf_instret_r = '0;
+        for (int i = 0; i < NUM_THREADS_P; i++)
+            perf_instret_r = perf_instret_r + th_perf_cnt_q[i][MRV_TH_PERF_RETIRED];
+    end
+    ////////////////////////////////////////////////////////////////////////////////
+`endif
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Verification functions
+    ////////////////////////////////////////////////////////////////////////////////
+
+    function [31:0] get_num_threads;
+        /*verilator public*/
+        get_num_threads = NUM_THREADS_P;
+    endfunction
+
+    // Counter idx of mrv_perf_e, zero if performance counters are not built in
+    function [63:0] get_perf_counter;
+        /*verilator public*/
+        input [7:0] idx;
+`ifdef SIM_ENABLED
+        if (idx == MRV_PERF_INSTRET)
+            get_perf_counter = perf_instret_r;
+        else
+            get_perf_counter = (idx < MRV_PERF_NUM) ? perf_cnt_q[idx] : '0;
+`else
+        get_perf_counter = '0;
+`endif
+    endfunction
+
+    // Counter idx of mrv_th_perf_e of thread tid
+    function [63:0] get_th_perf_counter;
+        /*verilator public*/
+        input [7:0] tid;
+        input [7:0] idx;
+`ifdef SIM_ENABLED
+        get_th_perf_counter = (tid < NUM_THREADS_P && idx < MRV_TH_PERF_NUM) ?
+            th_perf_cnt_q[tid[TID_WIDTH_LP-1:0]][idx] : '0;
+`else
+        get_th_perf_counter = '0;
+`endif
+    endfunction
+
+endmodule
@@ -125,4 +125,41 @@ package mrv1_pkg;
         MRV_VEC_MODE2  = 3'b100
     } mrv_vec_mode_e;
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // Simulation performance counters, order must match mrv1_perf.hpp
+    ////////////////////////////////////////////////////////////////////////////////
+    localparam MRV_PERF_NUM = 11;
+    typedef enum bit [7:0] {
+        MRV_PERF_CYCLES             = 'd0,
+        MRV_PERF_INSTRET            = 'd1,
+        ////////////////////////////////////////////////////////////////////////////////
+        // Fetch slot of mrv1_th_sched, exactly one of these per cycle
+        ////////////////////////////////////////////////////////////////////////////////
+        MRV_PERF_SCHED_USED         = 'd2,
+        MRV_PERF_SCHED_IDLE_REFILL  = 'd3,  // ready threads, round robin table empty
+        MRV_PERF_SCHED_IDLE_STALLED = 'd4,  // all active threads wait for a branch
+        MRV_PERF_SCHED_IDLE_NONE    = 'd5,  // no active threads
+        ////////////////////////////////////////////////////////////////////////////////
+        MRV_PERF_IMEM_STALL         = 'd6,
+        MRV_PERF_ISSUE_USED         = 'd7,
+        MRV_PERF_ISSUE_FU_BUSY      = 'd8,
+        MRV_PERF_DMEM_STALL         = 'd9,
+        MRV_PERF_BRANCH_REDIRECT    = 'd10
+    } mrv_perf_e;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Per thread counters
+    ////////////////////////////////////////////////////////////////////////////////
+    localparam MRV_TH_PERF_NUM = 8;
+    typedef enum bit [7:0] {
+        MRV_TH_PERF_RETIRED         = 'd0,
+        MRV_TH_PERF_SCHED           = 'd1,
+        MRV_TH_PERF_ACTIVE          = 'd2,
+        MRV_TH_PERF_STALLED         = 'd3,  // active, waits for branch resolution
+        MRV_TH_PERF_SLOT_WAIT       = 'd4,  // ready, fetch slot went elsewhere
+        MRV_TH_PERF_ISSUED          = 'd5,
+        MRV_TH_PERF_IQ_FULL         = 'd6,
+        MRV_TH_PERF_RAW             = 'd7
+    } mrv_th_perf_e;
+
 endpackage
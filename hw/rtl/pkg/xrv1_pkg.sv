@@ -124,4 +124,41 @@ package xrv1_pkg;
         XRV_CSR_MTVEC = 12'h305
     } xrv_csr_e;
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // Simulation performance counters, order must match xrv1_perf.hpp
+    ////////////////////////////////////////////////////////////////////////////////
+    localparam XRV_PERF_NUM = 17;
+    ////////////////////////////////////////////////////////////////////////////////
+    typedef enum bit [7:0] {
+        XRV_PERF_CYCLES           = 'd0,
+        XRV_PERF_INSTRET          = 'd1,
+        ////////////////////////////////////////////////////////////////////////////////
+        // Decode slot per cycle, exactly one of these is counted
+        ////////////////////////////////////////////////////////////////////////////////
+        XRV_PERF_ISSUE            = 'd2,
+        XRV_PERF_STALL_FETCH      = 'd3,
+        XRV_PERF_STALL_REDIRECT   = 'd4,
+        XRV_PERF_STALL_IQ_FULL    = 'd5,
+        XRV_PERF_STALL_RAW        = 'd6,
+        XRV_PERF_STALL_LSU        = 'd7,
+        XRV_PERF_STALL_FU         = 'd8,
+        ////////////////////////////////////////////////////////////////////////////////
+        // Frontend
+        ////////////////////////////////////////////////////////////////////////////////
+        XRV_PERF_FETCH_BUBBLE     = 'd9,
+        XRV_PERF_IFQ_EMPTY        = 'd10,
+        ////////////////////////////////////////////////////////////////////////////////
+        // Backend
+        ////////////////////////////////////////////////////////////////////////////////
+        XRV_PERF_IQ_OCCUPANCY     = 'd11,
+        XRV_PERF_LSU_BUSY         = 'd12,
+        XRV_PERF_LSU_DMEM_STALL   = 'd13,
+        ////////////////////////////////////////////////////////////////////////////////
+        // Redirects
+        ////////////////////////////////////////////////////////////////////////////////
+        XRV_PERF_SPEC_REDIRECT    = 'd14,
+        XRV_PERF_JUMP_REDIRECT    = 'd15,
+        XRV_PERF_BRANCH_REDIRECT  = 'd16
+    } xrv_perf_e;
+
 endpackage
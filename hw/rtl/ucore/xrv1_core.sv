@@ -776,6 +776,82 @@ module xrv1_core
         ////////////////////////////////////////////////////////////////////////////////
     );
 
+`ifdef SIM_ENABLED
+    ////////////////////////////////////////////////////////////////////////////////
+    // Performance counters
+    ////////////////////////////////////////////////////////////////////////////////
+    logic [XRV_PERF_NUM-1:0][63:0]  perf_cnt_q;
+    logic [XRV_PERF_NUM-1:0]        perf_inc_r;
+    // Front end refills after a jump or branch redirect until the next issue
+    logic                           perf_redirect_q;
+    ////////////////////////////////////////////////////////////////////////////////
+    wire perf_issue_fu_w =
+        (idecode_alu_req_vld_lo & alu_rdy_lo) |
+        (idecode_b_req_vld_lo   & b_rdy_lo)   |
+        (idecode_lsu_req_vld_lo & lsu_rdy_lo) |
+        (idecode_mul_req_vld_lo & mul_rdy_lo) |
+        (idecode_div_req_vld_lo & div_rdy_lo) |
+        (idecode_csr_req_vld_lo & csr_rdy_lo);
+    wire perf_redirect_w = idecode_j_pc_vld_lo | exec_b_pc_vld_lo;
+    wire perf_spec_redirect_w = ifetch.fetch_next & ifetch.spec_pc_vld_w &
+        imem_resp_vld_i & ~perf_redirect_w;
+    ////////////////////////////////////////////////////////////////////////////////
+    always_comb begin
+        perf_inc_r = '0;
+        perf_inc_r[XRV_PERF_CYCLES]          = 1'b1;
+        ////////////////////////////////////////////////////////////////////////////////
+        // Decode slot, checked in the order issue_vld_o depends on them
+        ////////////////////////////////////////////////////////////////////////////////
+        if (idecode_issue_vld_lo)
+            perf_inc_r[XRV_PERF_ISSUE]          = 1'b1;
+        else if (~idecode_insn_vld_li & perf_redirect_q)
+            perf_inc_r[XRV_PERF_STALL_REDIRECT] = 1'b1;
+        else if (~idecode_insn_vld_li)
+            perf_inc_r[XRV_PERF_STALL_FETCH]    = 1'b1;
+        else if (exec_b_pc_vld_lo)
+            perf_inc_r[XRV_PERF_STALL_REDIRECT] = 1'b1;
+        else if (~iq_issue_rdy_lo)
+            perf_inc_r[XRV_PERF_STALL_IQ_FULL]  = 1'b1;
+        else if (|ret_rs_conflict_lo)
+            perf_inc_r[XRV_PERF_STALL_RAW]      = 1'b1;
+        else if (idecode_lsu_req_vld_lo & ~lsu_rdy_lo)
+            perf_inc_r[XRV_PERF_STALL_LSU]      = 1'b1;
+        else
+            perf_inc_r[XRV_PERF_STALL_FU]       = 1'b1;
+        ////////////////////////////////////////////////////////////////////////////////
+        perf_inc_r[XRV_PERF_FETCH_BUBBLE]    = ~ifetch_insn_vld_lo;
+        perf_inc_r[XRV_PERF_IFQ_EMPTY]       = ifetch.ifq_empty_lo;
+        perf_inc_r[XRV_PERF_LSU_BUSY]        = (lsu_i.n_req_q != '0) | (lsu_i.n_resp_q != '0);
+        perf_inc_r[XRV_PERF_LSU_DMEM_STALL]  = dmem_req_vld_o & ~dmem_req_rdy_i;
+        perf_inc_r[XRV_PERF_SPEC_REDIRECT]   = perf_spec_redirect_w;
+        perf_inc_r[XRV_PERF_JUMP_REDIRECT]   = idecode_j_pc_vld_lo & ~exec_b_pc_vld_lo;
+        perf_inc_r[XRV_PERF_BRANCH_REDIRECT] = exec_b_pc_vld_lo;
+    end
+    ////////////////////////////////////////////////////////////////////////////////
+    always_ff @(posedge clk_i) begin
+        if (rst_i | rst_down_w) begin
+            perf_cnt_q      <= '0;
+            perf_redirect_q <= 1'b0;
+        end
+        else begin
+            for (int i = 0; i < XRV_PERF_NUM; i++)
+                if (i != XRV_PERF_INSTRET && i != XRV_PERF_IQ_OCCUPANCY)
+                    perf_cnt_q[i] <= perf_cnt_q[i] + 64'(perf_inc_r[i]);
+            ////////////////////////////////////////////////////////////////////////////////
+            // Sums are wider than one bit, the loop leaves them out
+            ////////////////////////////////////////////////////////////////////////////////
+            perf_cnt_q[XRV_PERF_INSTRET]      <= perf_cnt_q[XRV_PERF_INSTRET] + 64'(ret_retire_cnt_lo);
+            perf_cnt_q[XRV_PERF_IQ_OCCUPANCY] <= perf_cnt_q[XRV_PERF_IQ_OCCUPANCY] + 64'($countones(iq_vld_lo));
+            ////////////////////////////////////////////////////////////////////////////////
+            if (perf_redirect_w)
+                perf_redirect_q <= 1'b1;
+            else if (idecode_issue_vld_lo)
+                perf_redirect_q <= 1'b0;
+        end
+    end
+    ////////////////////////////////////////////////////////////////////////////////
+`endif
+
     ////////////////////////////////////////////////////////////////////////////////
     // Verification functions
     ////////////////////////////////////////////////////////////////////////////////
@@ -865,6 +941,43 @@ module xrv1_core
         get_iq_retire_itag = 8'(iq_retire_itag_lo);
     endfunction
 
+    // All of the above packed into 9 words, so the host can sample a
+    // cycle with a single call. Layout must match xrv1_obs_snapshot.
+    function [287:0] get_obs_snapshot;
+        /*verilator public*/
+        get_obs_snapshot = {
+            wb_data_lo,                                 // word 8
+            ifetch_insn_data_q,                         // word 7
+            ifetch_insn_pc_q,                           // word 6
+            ifetch_insn_data_lo,                        // word 5
+            ifetch_insn_pc_lo,                          // word 4
+            imem_resp_data_i,                           // word 3
+            imem_req_addr_o,                            // word 2
+            24'b0, 8'(wb_rd_addr_lo),                   // word 1
+            8'(iq_retire_itag_lo),                      // word 0
+            8'(ret_retire_cnt_lo),
+            8'(idecode_itag_lo),
+            2'b0,
+            wb_data_vld_lo,
+            idecode_issue_vld_lo,
+            ifetch_insn_vld_q,
+            ifetch_insn_vld_lo,
+            imem_resp_vld_i,
+            imem_req_vld_o
+        };
+    endfunction
+
+    // Counter idx of xrv_perf_e, zero if performance counters are not built in
+    function [63:0] get_perf_counter;
+        /*verilator public*/
+        input [7:0] idx;
+`ifdef SIM_ENABLED
+        get_perf_counter = (idx < XRV_PERF_NUM) ? perf_cnt_q[idx] : '0;
+`else
+        get_perf_counter = '0;
+`endif
+    endfunction
+
 /*
     logic                           ifetch_insn_compressed_lo;
     logic                           ifetch_insn_illegal_lo;
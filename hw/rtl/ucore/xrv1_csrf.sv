@@ -71,5 +71,16 @@ module xrv1_csrf
         endcase
     end
     ////////////////////////////////////////////////////////////////////////////////
+    task write_csr;
+        /* verilator public */
+        input [11:0] addr;
+        input [31:0] val;
+        unique case (addr)
+            XRV_CSR_MTVEC: mtvec_q = val;
+            'h7b2: mscratch_q = val;
+            default:;
+        endcase
+    endtask
+    ////////////////////////////////////////////////////////////////////////////////
 
 endmodule
@@ -44,6 +44,25 @@ module xrv1_ifetch
     logic [31:0] fetch_addr_r;
     logic fetch_next;
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // Reset address
+    ////////////////////////////////////////////////////////////////////////////////
+`ifdef SIM_ENABLED
+    // Simulation may start the core from an arbitrary pc,
+    // e.g. after fast-forwarding a workload on the ISA model
+    logic [31:0] reset_addr_q = ifq_default_reset_addr;
+    wire [31:0]  reset_addr_w = reset_addr_q;
+    ////////////////////////////////////////////////////////////////////////////////
+    task set_reset_addr;
+        /* verilator public */
+        input [31:0] addr;
+        reset_addr_q = addr;
+    endtask
+`else
+    wire [31:0]  reset_addr_w = ifq_default_reset_addr;
+`endif
+    ////////////////////////////////////////////////////////////////////////////////
+
     ////////////////////////////////////////////////////////////////////////////////
     // Fetch address increment
     ////////////////////////////////////////////////////////////////////////////////
@@ -83,7 +102,7 @@ module xrv1_ifetch
     ////////////////////////////////////////////////////////////////////////////////
     always_comb begin
         if (rst_down_i)
-            fetch_addr_r = ifq_default_reset_addr;
+            fetch_addr_r = reset_addr_w;
         else if (exec_b_pc_vld_i)
             fetch_addr_r = exec_b_pc_i;
         else if (dec_j_pc_vld_i)
@@ -98,7 +117,7 @@ module xrv1_ifetch
     ////////////////////////////////////////////////////////////////////////////////
     always_ff @(posedge clk_i) begin
         if (rst_i)
-            fetch_addr_q <= ifq_default_reset_addr;
+            fetch_addr_q <= reset_addr_w;
         else if (exec_b_pc_vld_i)
             fetch_addr_q <= exec_b_pc_i;
         else if (dec_j_pc_vld_i)
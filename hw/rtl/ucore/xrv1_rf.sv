@@ -42,4 +42,11 @@ module xrv1_rf
         read_reg = rf_mem[reg_addr];
     endfunction
     ////////////////////////////////////////////////////////////////////////////////
+    task write_reg;
+        /* verilator public */
+        input integer reg_addr;
+        input [DATA_WIDTH_P - 1:0] val;
+        rf_mem[reg_addr] = val;
+    endtask
+    ////////////////////////////////////////////////////////////////////////////////
 endmodule
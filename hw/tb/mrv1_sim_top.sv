@@ -99,4 +99,78 @@ module mrv1_sim_top #(
     );
     ////////////////////////////////////////////////////////////////////////////////
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // tohost: stores to the tohost word are passed to mrv1_soc as they are
+    // accepted, so a run ends in the cycle the workload reports its result.
+    // The tohost address is read during reset, all ones if there is none.
+    ////////////////////////////////////////////////////////////////////////////////
+    import "DPI-C" context function int unsigned mrv1_tohost_addr();
+    import "DPI-C" context function void mrv1_tohost_write(input int unsigned data,
+                                                           input byte unsigned be);
+    ////////////////////////////////////////////////////////////////////////////////
+    logic [31:0]                    tohost_addr_q;
+    wire tohost_hit_w = dmem_req_vld & dmem_req_rdy & dmem_req_w_en & (tohost_addr_q != '1)
+                      & (dmem_req_addr[31:2] == tohost_addr_q[31:2]);
+    ////////////////////////////////////////////////////////////////////////////////
+    always @(posedge clk_i) begin
+        if (rst_i)
+            tohost_addr_q <= mrv1_tohost_addr();
+        else if (tohost_hit_w)
+            mrv1_tohost_write(dmem_req_w_data, {4'b0, dmem_req_w_be});
+    end
+    ////////////////////////////////////////////////////////////////////////////////
+
+export "DPI-C" task get_ram_size_bits;
+task get_ram_size_bits
+(
+    output int bits
+);
+    bits = mrv1_sim_top.tcm_i.itcm_size_p;
+endtask
+
+export "DPI-C" task get_num_threads;
+task get_num_threads
+(
+    output int num
+);
+    num = mrv1_sim_top.core_i.get_num_threads();
+endtask
+
+export "DPI-C" task write_u8;
+task write_u8
+(
+    input int addr,
+    input byte data
+);
+    mrv1_sim_top.tcm_i.itcm_i.write_u8(addr, data);
+endtask
+
+export "DPI-C" task read_u8;
+task read_u8
+(
+    input int addr,
+    output byte data
+);
+    data = mrv1_sim_top.tcm_i.itcm_i.read_u8(addr);
+endtask
+
+export "DPI-C" task get_perf_counter;
+task get_perf_counter
+(
+    input int idx,
+    output longint val
+);
+    val = mrv1_sim_top.core_i.get_perf_counter(idx[7:0]);
+endtask
+
+export "DPI-C" task get_th_perf_counter;
+task get_th_perf_counter
+(
+    input int tid,
+    input int idx,
+    output longint val
+);
+    val = mrv1_sim_top.core_i.get_th_perf_counter(tid[7:0], idx[7:0]);
+endtask
+
 endmodule
@@ -18,7 +18,8 @@ module xrv1_sim_ram
     ////////////////////////////////////////////////////////////////////////////////
 );
     ////////////////////////////////////////////////////////////////////////////////
-    logic [7:0] ram [depth_p-1:0];
+    // public so that the host can access the memory image directly
+    logic [7:0] ram [depth_p-1:0] /* verilator public */;
     ////////////////////////////////////////////////////////////////////////////////
     wire [addr_width_lp-1:0] addr_algn0_w = {addr_0_i[addr_width_lp-1:2], 2'b00};
     wire [addr_width_lp-1:0] addr_algn1_w = {addr_1_i[addr_width_lp-1:2], 2'b00};
@@ -0,0 +1,63 @@
+module xrv1_sim_sparse_ram
+#(
+    parameter depth_p = 1 << 16,
+    parameter addr_width_lp = $clog2(depth_p)
+)
+(
+    ////////////////////////////////////////////////////////////////////////////////
+    input  logic                        clk_i,
+    ////////////////////////////////////////////////////////////////////////////////
+    input  logic [addr_width_lp-1:0]    addr_0_i,
+    output logic [31:0]                 r_data_0_o,
+    ////////////////////////////////////////////////////////////////////////////////
+    input  logic [addr_width_lp-1:0]    addr_1_i,
+    output logic [31:0]                 r_data_1_o,
+    input  logic                        w_en_1_i,
+    input  logic [31:0]                 w_data_1_i,
+    input  logic [3:0]                  w_be_1_i
+    ////////////////////////////////////////////////////////////////////////////////
+);
+    ////////////////////////////////////////////////////////////////////////////////
+    // Same ports and timing as xrv1_sim_ram, but the memory lives in a paged
+    // C++ store (xrv1_sparse_mem) which allocates pages on first write. The
+    // store of this instance is found through the dpi scope.
+    ////////////////////////////////////////////////////////////////////////////////
+    import "DPI-C" context function int unsigned xrv1_sparse_read32(input int unsigned addr);
+    import "DPI-C" context function void xrv1_sparse_write32(input int unsigned addr,
+                                                             input int unsigned data,
+                                                             input byte unsigned be);
+    ////////////////////////////////////////////////////////////////////////////////
+    wire [31:0] addr_algn0_w = 32'({addr_0_i[addr_width_lp-1:2], 2'b00});
+    wire [31:0] addr_algn1_w = 32'({addr_1_i[addr_width_lp-1:2], 2'b00});
+    ////////////////////////////////////////////////////////////////////////////////
+    always @(posedge clk_i) begin
+        ////////////////////////////////////////////////////////////////////////////////
+        // reads return the data from before a write of the same cycle
+        r_data_0_o <= xrv1_sparse_read32(addr_algn0_w);
+        r_data_1_o <= xrv1_sparse_read32(addr_algn1_w);
+        ////////////////////////////////////////////////////////////////////////////////
+        if (w_en_1_i & |w_be_1_i) begin
+            xrv1_sparse_write32(addr_algn1_w, w_data_1_i, {4'b0000, w_be_1_i});
+        end
+        ////////////////////////////////////////////////////////////////////////////////
+    end
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ////////////////////////////////////////////////////////////////////////////////
+    function [7:0] read_u8;
+        /* verilator public */
+        input integer byte_addr;
+        logic [31:0] word;
+        word = xrv1_sparse_read32(byte_addr & ~32'h3);
+        read_u8 = word[byte_addr[1:0] * 8 +: 8];
+    endfunction
+    ////////////////////////////////////////////////////////////////////////////////
+    task write_u8;
+        /* verilator public */
+        input integer byte_addr;
+        input [7:0] val;
+        xrv1_sparse_write32(byte_addr & ~32'h3, {4{val}}, 8'h1 << byte_addr[1:0]);
+    endtask
+    ////////////////////////////////////////////////////////////////////////////////
+
+endmodule
@@ -8,6 +8,7 @@ module xrv1_sim_tcm
 (
     ////////////////////////////////////////////////////////////////////////////////
     input  logic                    clk_i,
+    input  logic                    rst_i,
     ////////////////////////////////////////////////////////////////////////////////
     // Instruction memory interface
     ////////////////////////////////////////////////////////////////////////////////
@@ -30,10 +31,52 @@ module xrv1_sim_tcm
     output  logic [31:0]            dmem_resp_r_data_o
     ////////////////////////////////////////////////////////////////////////////////
 );
+`ifdef MEM_TIMING
     ////////////////////////////////////////////////////////////////////////////////
-    // Dual-ported RAM sim model
+    // Timing from a C++ model (xrv1_mem_timing) attached to this scope.
+    // Instruction fetch asks for the same address every cycle until it gets
+    // data, so imem responses are just withheld until the access is done.
+    // Data requests are queued and answered in order once their latency has
+    // passed, the queue also limits requests in flight.
     ////////////////////////////////////////////////////////////////////////////////
+    import "DPI-C" context function bit xrv1_mem_imem_poll(input longint unsigned cycle,
+                                                           input int unsigned addr);
+    import "DPI-C" context function int unsigned xrv1_mem_dmem_access(input longint unsigned cycle,
+                                                                      input int unsigned addr,
+                                                                      input bit write);
+    import "DPI-C" context function int unsigned xrv1_mem_dmem_limit();
+    import "DPI-C" context function void xrv1_mem_dmem_stall();
+    import "DPI-C" context function void xrv1_mem_reset();
+    ////////////////////////////////////////////////////////////////////////////////
+    localparam dq_depth_lp = 16;
+    localparam dq_ptr_width_lp = $clog2(dq_depth_lp);
+    ////////////////////////////////////////////////////////////////////////////////
+    logic [63:0]                    cycle_q;
+    logic [31:0]                    dq_data_q [dq_depth_lp-1:0];
+    logic [63:0]                    dq_ready_q [dq_depth_lp-1:0];
+    logic [dq_ptr_width_lp-1:0]     dq_head_q;
+    logic [dq_ptr_width_lp-1:0]     dq_tail_q;
+    logic [dq_ptr_width_lp:0]       dq_cnt_q;
+    logic [63:0]                    dq_last_ready_q;
+    logic [63:0]                    dq_new_ready;
+    logic [dq_ptr_width_lp:0]       dq_limit_q;
+    // data of the entry pushed in the previous cycle is on the ram output
+    logic                           dq_fill_q;
+    logic [dq_ptr_width_lp-1:0]     dq_fill_idx_q;
+    logic [31:0]                    dram_r_data;
+    ////////////////////////////////////////////////////////////////////////////////
+    wire dmem_accept_w = dmem_req_vld_i & dmem_req_rdy_o;
+    wire dq_pop_w = dmem_resp_vld_o;
+    ////////////////////////////////////////////////////////////////////////////////
+`endif
+    ////////////////////////////////////////////////////////////////////////////////
+    // Dual-ported RAM sim model, SPARSE_RAM keeps it in a paged C++ store
+    ////////////////////////////////////////////////////////////////////////////////
+`ifdef SPARSE_RAM
+    xrv1_sim_sparse_ram #(
+`else
     xrv1_sim_ram #(
+`endif
         .depth_p(itcm_size_p)
     ) itcm_i (
         ////////////////////////////////////////////////////////////////////////////////
@@ -42,13 +85,76 @@ module xrv1_sim_tcm
         .addr_0_i                   (imem_req_addr_i[itcm_addr_width_lp-1:0]),
         .addr_1_i                   (dmem_req_addr_i[dtcm_addr_width_lp-1:0]),
         .r_data_0_o                 (imem_resp_data_o),
+`ifdef MEM_TIMING
+        .r_data_1_o                 (dram_r_data),
+`else
         .r_data_1_o                 (dmem_resp_r_data_o),
+`endif
         ////////////////////////////////////////////////////////////////////////////////
+`ifdef MEM_TIMING
+        .w_en_1_i                   (dmem_req_w_en_i & dmem_accept_w),
+`else
         .w_en_1_i                   (dmem_req_w_en_i),
+`endif
         .w_data_1_i                 (dmem_req_w_data_i),
         .w_be_1_i                   (dmem_req_w_be_i)
         ////////////////////////////////////////////////////////////////////////////////
     );
+`ifdef MEM_TIMING
+    ////////////////////////////////////////////////////////////////////////////////
+    assign imem_req_rdy_o = 1'b1;
+    assign dmem_req_rdy_o = dq_cnt_q < dq_limit_q;
+    assign dmem_resp_vld_o = (dq_cnt_q != '0) & (dq_ready_q[dq_head_q] <= cycle_q);
+    assign dmem_resp_r_data_o = (dq_fill_q & (dq_fill_idx_q == dq_head_q)) ? dram_r_data
+                                                                             : dq_data_q[dq_head_q];
+    ////////////////////////////////////////////////////////////////////////////////
+    always @(posedge clk_i) begin
+        if (rst_i) begin
+            xrv1_mem_reset();
+            dq_limit_q <= dq_limit_f(xrv1_mem_dmem_limit());
+            cycle_q <= '0;
+            imem_resp_vld_o <= 1'b0;
+            dq_head_q <= '0;
+            dq_tail_q <= '0;
+            dq_cnt_q <= '0;
+            dq_last_ready_q <= '0;
+            dq_fill_q <= 1'b0;
+        end else begin
+            cycle_q <= cycle_q + 64'd1;
+            imem_resp_vld_o <= imem_req_vld_i && xrv1_mem_imem_poll(cycle_q, imem_req_addr_i);
+            ////////////////////////////////////////////////////////////////////////////////
+            if (dq_fill_q)
+                dq_data_q[dq_fill_idx_q] <= dram_r_data;
+            dq_fill_q <= dmem_accept_w;
+            dq_fill_idx_q <= dq_tail_q;
+            ////////////////////////////////////////////////////////////////////////////////
+            if (dmem_accept_w) begin
+                // responses leave in order, at least a cycle apart
+                dq_new_ready = cycle_q + 64'(xrv1_mem_dmem_access(cycle_q, dmem_req_addr_i, dmem_req_w_en_i));
+                if (dq_new_ready <= dq_last_ready_q)
+                    dq_new_ready = dq_last_ready_q + 64'd1;
+                dq_ready_q[dq_tail_q] <= dq_new_ready;
+                dq_last_ready_q <= dq_new_ready;
+                dq_tail_q <= dq_tail_q + 1'b1;
+            end else if (dmem_req_vld_i) begin
+                xrv1_mem_dmem_stall();
+            end
+            if (dq_pop_w)
+                dq_head_q <= dq_head_q + 1'b1;
+            if (dmem_accept_w & ~dq_pop_w)
+                dq_cnt_q <= dq_cnt_q + 1'b1;
+            else if (~dmem_accept_w & dq_pop_w)
+                dq_cnt_q <= dq_cnt_q - 1'b1;
+        end
+    end
+    ////////////////////////////////////////////////////////////////////////////////
+    // 0 or more than the queue holds means no limit
+    function automatic logic [dq_ptr_width_lp:0] dq_limit_f(input int unsigned limit);
+        return (limit == 0 || limit > dq_depth_lp) ? (dq_ptr_width_lp+1)'(dq_depth_lp)
+                                                   : (dq_ptr_width_lp+1)'(limit);
+    endfunction
+    ////////////////////////////////////////////////////////////////////////////////
+`else
     ////////////////////////////////////////////////////////////////////////////////
     assign imem_req_rdy_o = 1'b1;
     assign dmem_req_rdy_o = 1'b1;
@@ -58,5 +164,33 @@ module xrv1_sim_tcm
         dmem_resp_vld_o <= dmem_req_vld_i;
     end
     ////////////////////////////////////////////////////////////////////////////////
+`endif
+    ////////////////////////////////////////////////////////////////////////////////
+    // HTIF: stores to the tohost word pair are passed to the C++ host model
+    // (xrv1_htif) attached to this scope, which ends the run on exit or
+    // prints console output. The tohost address is read during reset.
+    // Data is passed as driven by the LSU, the model merges it under be.
+    ////////////////////////////////////////////////////////////////////////////////
+    import "DPI-C" context function int unsigned xrv1_htif_tohost_addr();
+    import "DPI-C" context function void xrv1_htif_tohost_write(input bit upper,
+                                                                 input int unsigned data,
+                                                                 input byte unsigned be);
+    ////////////////////////////////////////////////////////////////////////////////
+    logic [31:0]                    tohost_addr_q;
+`ifdef MEM_TIMING
+    wire dmem_store_w = dmem_accept_w & dmem_req_w_en_i;
+`else
+    wire dmem_store_w = dmem_req_vld_i & dmem_req_w_en_i;
+`endif
+    wire tohost_hit_w = dmem_store_w & (tohost_addr_q != '1)
+                      & (dmem_req_addr_i[31:3] == tohost_addr_q[31:3]);
+    ////////////////////////////////////////////////////////////////////////////////
+    always @(posedge clk_i) begin
+        if (rst_i)
+            tohost_addr_q <= xrv1_htif_tohost_addr();
+        else if (tohost_hit_w)
+            xrv1_htif_tohost_write(dmem_req_addr_i[2], dmem_req_w_data_i, {4'b0, dmem_req_w_be_i});
+    end
+    ////////////////////////////////////////////////////////////////////////////////
 
 endmodule
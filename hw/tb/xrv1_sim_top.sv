@@ -59,9 +59,10 @@ module xrv1_sim_top
     ////////////////////////////////////////////////////////////////////////////////
     // TCM simulation model
     ////////////////////////////////////////////////////////////////////////////////
-    xrv1_sim_tcm #(.itcm_size_p(1 << `CPU_RAM_SIZE_BITS), .dtcm_size_p(1 << `CPU_RAM_SIZE_BITS)) tcm_i (
+    xrv1_sim_tcm #(.itcm_size_p(64'd1 << `CPU_RAM_SIZE_BITS), .dtcm_size_p(64'd1 << `CPU_RAM_SIZE_BITS)) tcm_i (
         ////////////////////////////////////////////////////////////////////////////////
         .clk_i                      (clk_i),
+        .rst_i                      (rst_i),
         ////////////////////////////////////////////////////////////////////////////////
         .imem_req_vld_i             (imem_req_vld),
         .imem_req_rdy_o             (imem_req_rdy),
@@ -91,12 +92,50 @@ task read_register
     val = xrv1_sim_top.core_i.rf.read_reg(reg_addr);
 endtask
 
+export "DPI-C" task write_register;
+task write_register
+(
+    input int reg_addr,
+    input int val
+);
+    xrv1_sim_top.core_i.rf.write_reg(reg_addr, val);
+endtask
+
+export "DPI-C" task write_csr;
+task write_csr
+(
+    input int csr_addr,
+    input int val
+);
+    xrv1_sim_top.core_i.csr_i.csrf.write_csr(csr_addr[11:0], val);
+endtask
+
+export "DPI-C" task set_reset_addr;
+task set_reset_addr
+(
+    input int addr
+);
+`ifdef SIM_ENABLED
+    xrv1_sim_top.core_i.ifetch.set_reset_addr(addr);
+`else
+    $display("set_reset_addr requires SIM_ENABLED");
+`endif
+endtask
+
 export "DPI-C" task get_ram_size_bits;
 task get_ram_size_bits
 (
     output int bits
 );
-    bits = xrv1_sim_top.tcm_i.itcm_size_p;
+    bits = 32'(xrv1_sim_top.tcm_i.itcm_size_p);
+endtask
+
+export "DPI-C" task get_reset_addr;
+task get_reset_addr
+(
+    output int addr
+);
+    addr = `CPU_RESET_ADDRESS;
 endtask
 
 export "DPI-C" task write_u8;
@@ -141,6 +180,14 @@ task get_imem_req_vld
     valid = xrv1_sim_top.core_i.get_imem_req_vld();
 endtask
 
+export "DPI-C" task get_imem_req_addr;
+task get_imem_req_addr
+(
+    output int addr
+);
+    addr = xrv1_sim_top.core_i.get_imem_req_addr();
+endtask
+
 export "DPI-C" task get_ifetch_insn_data;
 task get_ifetch_insn_data
 (
@@ -246,4 +293,21 @@ task get_iq_retire_itag
     itag = xrv1_sim_top.core_i.get_iq_retire_itag();
 endtask
 
+export "DPI-C" task get_obs_snapshot;
+task get_obs_snapshot
+(
+    output bit [287:0] snap
+);
+    snap = xrv1_sim_top.core_i.get_obs_snapshot();
+endtask
+
+export "DPI-C" task get_perf_counter;
+task get_perf_counter
+(
+    input int idx,
+    output longint val
+);
+    val = xrv1_sim_top.core_i.get_perf_counter(idx[7:0]);
+endtask
+
 endmodule
@@ -0,0 +1,34 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Workloads are freestanding, built with -DBENCH_HOST they run natively
+// which is used to get the expected checksums.
+#ifdef BENCH_HOST
+#include <stdio.h>
+#include <string.h>
+#endif
+
+// crc16 of one value, the same accumulation coremark uses for its results
+uint16_t bench_crc8(uint8_t data, uint16_t crc);
+uint16_t bench_crc16(int16_t data, uint16_t crc);
+uint16_t bench_crc32(uint32_t data, uint16_t crc);
+
+#ifndef BENCH_HOST
+void* memset(void* dst, int c, size_t n);
+void* memcpy(void* dst, const void* src, size_t n);
+int strcmp(const char* a, const char* b);
+char* strcpy(char* dst, const char* src);
+#endif
+
+// exit code of the workload, written to tohost by crt0
+static inline int bench_check(uint32_t crc, uint32_t expected) {
+#ifdef BENCH_HOST
+    printf("checksum 0x%08x\n", (unsigned)crc);
+#endif
+    return crc != expected;
+}
+
+#endif /* __BENCH_H__ */
@@ -0,0 +1,60 @@
+#include "bench.h"
+
+uint16_t bench_crc8(uint8_t data, uint16_t crc) {
+    for (int i = 0; i < 8; i++) {
+        uint8_t x16 = (data & 1) ^ (crc & 1);
+        data >>= 1;
+        if (x16) {
+            crc ^= 0x4002;
+            crc = (crc >> 1) | 0x8000;
+        } else {
+            crc >>= 1;
+        }
+    }
+    return crc;
+}
+
+uint16_t bench_crc16(int16_t data, uint16_t crc) {
+    uint16_t v = (uint16_t)data;
+    crc = bench_crc8((uint8_t)v, crc);
+    return bench_crc8((uint8_t)(v >> 8), crc);
+}
+
+uint16_t bench_crc32(uint32_t data, uint16_t crc) {
+    crc = bench_crc16((int16_t)data, crc);
+    return bench_crc16((int16_t)(data >> 16), crc);
+}
+
+#ifndef BENCH_HOST
+// the compiler may emit calls to these even without a libc
+
+void* memset(void* dst, int c, size_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    while (n--)
+        *d++ = (uint8_t)c;
+    return dst;
+}
+
+void* memcpy(void* dst, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    while (n--)
+        *d++ = *s++;
+    return dst;
+}
+
+int strcmp(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return (uint8_t)*a - (uint8_t)*b;
+}
+
+char* strcpy(char* dst, const char* src) {
+    char* d = dst;
+    while ((*d++ = *src++))
+        ;
+    return dst;
+}
+#endif
@@ -0,0 +1,164 @@
+// CoreMark style list kernel: find, reverse and merge sort of a linked
+// list, pointer chasing with data dependent branches.
+
+#include "bench.h"
+
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    40
+#endif
+
+#define LIST_ITEMS          64
+#define LIST_EXPECTED       0x00002c71u
+
+typedef struct list_data {
+    int16_t data16;
+    int16_t idx;
+} list_data;
+
+typedef struct list_head {
+    struct list_head* next;
+    list_data* info;
+} list_head;
+
+typedef int (*list_cmp)(const list_data* a, const list_data* b);
+
+static list_head g_nodes[LIST_ITEMS];
+static list_data g_data[LIST_ITEMS];
+
+// low byte is a small value folded by the iteration, like core_list_join
+static int16_t calc_value(int16_t data, int iter) {
+    int16_t v = data & 0xff;
+    int16_t kind = (data >> 8) & 0x3;
+    if (kind == 1)
+        v = (int16_t)(v * (iter + 3) & 0xff);
+    else if (kind == 2)
+        v = (int16_t)((v ^ iter) + 7);
+    return v;
+}
+
+static int cmp_value(const list_data* a, const list_data* b) {
+    return (a->data16 & 0xff) - (b->data16 & 0xff);
+}
+
+static int cmp_idx(const list_data* a, const list_data* b) {
+    return a->idx - b->idx;
+}
+
+static list_head* list_find(list_head* list, const list_data* info) {
+    if (info->idx >= 0) {
+        while (list && list->info->idx != info->idx)
+            list = list->next;
+    } else {
+        while (list && (list->info->data16 & 0xff) != info->data16)
+            list = list->next;
+    }
+    return list;
+}
+
+static list_head* list_reverse(list_head* list) {
+    list_head* next = 0;
+    while (list) {
+        list_head* tmp = list->next;
+        list->next = next;
+        next = list;
+        list = tmp;
+    }
+    return next;
+}
+
+// bottom up merge sort, no recursion
+static list_head* list_mergesort(list_head* list, list_cmp cmp) {
+    int insize = 1;
+    for (;;) {
+        list_head* p = list;
+        list_head* tail = 0;
+        int nmerges = 0;
+        list = 0;
+        while (p) {
+            list_head* q = p;
+            int psize = 0;
+            nmerges++;
+            for (int i = 0; i < insize && q; i++) {
+                psize++;
+                q = q->next;
+            }
+            int qsize = insize;
+            while (psize > 0 || (qsize > 0 && q)) {
+                list_head* e;
+                if (psize == 0) {
+                    e = q; q = q->next; qsize--;
+                } else if (qsize == 0 || !q) {
+                    e = p; p = p->next; psize--;
+                } else if (cmp(p->info, q->info) <= 0) {
+                    e = p; p = p->next; psize--;
+                } else {
+                    e = q; q = q->next; qsize--;
+                }
+                if (tail)
+                    tail->next = e;
+                else
+                    list = e;
+                tail = e;
+            }
+            p = q;
+        }
+        tail->next = 0;
+        if (nmerges <= 1)
+            return list;
+        insize *= 2;
+    }
+}
+
+static list_head* list_init(uint16_t seed) {
+    for (int i = 0; i < LIST_ITEMS; i++) {
+        seed = (uint16_t)(seed * 25173u + 13849u);
+        g_data[i].data16 = (int16_t)(seed & 0x3ff);
+        g_data[i].idx = (int16_t)i;
+        g_nodes[i].info = &g_data[i];
+        g_nodes[i].next = i + 1 < LIST_ITEMS ? &g_nodes[i + 1] : 0;
+    }
+    // scramble the order so that sorting by idx has work to do
+    return list_mergesort(&g_nodes[0], cmp_value);
+}
+
+int main(void) {
+    uint16_t crc = 0;
+    list_head* list = list_init(0x66);
+
+    for (int iter = 0; iter < BENCH_ITERATIONS; iter++) {
+        list_data info;
+        int found = 0, missed = 0;
+        for (int i = 0; i < LIST_ITEMS / 4; i++) {
+            info.idx = (int16_t)((i * 7 + iter) % (LIST_ITEMS + 8));
+            info.data16 = -1;
+            list_head* this_find = list_find(list, &info);
+            if (!this_find) {
+                missed++;
+                info.idx = -1;
+                info.data16 = (int16_t)((i + iter) & 0xff);
+                this_find = list_find(list, &info);
+            }
+            if (this_find) {
+                found++;
+                // move the found item after the head
+                if (this_find != list && this_find->next) {
+                    list_head* moved = this_find->next;
+                    this_find->next = moved->next;
+                    moved->next = list->next;
+                    list->next = moved;
+                }
+            }
+            list = list_reverse(list);
+        }
+        for (int i = 0; i < LIST_ITEMS; i++)
+            g_data[i].data16 = (int16_t)((g_data[i].data16 & 0x300) | (calc_value(g_data[i].data16, iter) & 0xff));
+
+        list = list_mergesort(list, cmp_value);
+        for (list_head* p = list; p; p = p->next)
+            crc = bench_crc16(p->info->data16, crc);
+        list = list_mergesort(list, cmp_idx);
+        crc = bench_crc16((int16_t)(found * 4 - missed), crc);
+        crc = bench_crc16(list->next->info->idx, crc);
+    }
+    return bench_check(crc, LIST_EXPECTED);
+}
@@ -0,0 +1,114 @@
+// CoreMark style matrix kernel: 16 bit matrix by constant, vector and
+// matrix products with 32 bit accumulators, multiply heavy.
+
+#include "bench.h"
+
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    4
+#endif
+
+#define MAT_N               16
+#define MATRIX_EXPECTED     0x00008d32u
+
+typedef int16_t mat_a[MAT_N][MAT_N];
+typedef int32_t mat_c[MAT_N][MAT_N];
+
+static mat_a g_a, g_b;
+static mat_c g_c;
+
+static int16_t matrix_sum(const mat_c c, int32_t clipval) {
+    int32_t tmp = 0, prev = 0;
+    int16_t ret = 0;
+    for (int i = 0; i < MAT_N; i++) {
+        for (int j = 0; j < MAT_N; j++) {
+            int32_t cur = c[i][j];
+            tmp += cur;
+            if (tmp > clipval) {
+                ret += 10;
+                tmp = 0;
+            } else {
+                ret += cur > prev ? 1 : 0;
+            }
+            prev = cur;
+        }
+    }
+    return ret;
+}
+
+static void matrix_add_const(mat_a a, int16_t val) {
+    for (int i = 0; i < MAT_N; i++)
+        for (int j = 0; j < MAT_N; j++)
+            a[i][j] += val;
+}
+
+static void matrix_mul_const(mat_c c, const mat_a a, int16_t val) {
+    for (int i = 0; i < MAT_N; i++)
+        for (int j = 0; j < MAT_N; j++)
+            c[i][j] = (int32_t)a[i][j] * (int32_t)val;
+}
+
+static void matrix_mul_vect(mat_c c, const mat_a a, const mat_a b) {
+    for (int i = 0; i < MAT_N; i++) {
+        int32_t acc = 0;
+        for (int j = 0; j < MAT_N; j++)
+            acc += (int32_t)a[i][j] * (int32_t)b[0][j];
+        c[0][i] = acc;
+    }
+}
+
+static void matrix_mul_matrix(mat_c c, const mat_a a, const mat_a b) {
+    for (int i = 0; i < MAT_N; i++) {
+        for (int j = 0; j < MAT_N; j++) {
+            int32_t acc = 0;
+            for (int k = 0; k < MAT_N; k++)
+                acc += (int32_t)a[i][k] * (int32_t)b[k][j];
+            c[i][j] = acc;
+        }
+    }
+}
+
+// products with a bit field of the operands, as matrix_mul_matrix_bitextract
+static void matrix_mul_bitextract(mat_c c, const mat_a a, const mat_a b) {
+    for (int i = 0; i < MAT_N; i++) {
+        for (int j = 0; j < MAT_N; j++) {
+            int32_t acc = 0;
+            for (int k = 0; k < MAT_N; k++) {
+                int32_t tmp = (int32_t)a[i][k] * (int32_t)b[k][j];
+                acc += ((tmp >> 2) & 0xf) * ((tmp >> 5) & 0x7f);
+            }
+            c[i][j] = acc;
+        }
+    }
+}
+
+static uint16_t matrix_test(int16_t val, uint16_t crc) {
+    int32_t clipval = (int32_t)0xf000 | val;
+    // with the constant folded in and out again a stays the same
+    matrix_add_const(g_a, val);
+    matrix_mul_const(g_c, g_a, val);
+    crc = bench_crc16(matrix_sum(g_c, clipval), crc);
+    matrix_mul_vect(g_c, g_a, g_b);
+    crc = bench_crc16(matrix_sum(g_c, clipval), crc);
+    matrix_mul_matrix(g_c, g_a, g_b);
+    crc = bench_crc16(matrix_sum(g_c, clipval), crc);
+    matrix_mul_bitextract(g_c, g_a, g_b);
+    crc = bench_crc16(matrix_sum(g_c, clipval), crc);
+    matrix_add_const(g_a, (int16_t)-val);
+    return crc;
+}
+
+int main(void) {
+    uint16_t crc = 0;
+    uint32_t seed = 1;
+    for (int i = 0; i < MAT_N; i++) {
+        for (int j = 0; j < MAT_N; j++) {
+            seed = (seed * 1103515245u + 12345u) & 0x7fffffffu;
+            g_a[i][j] = (int16_t)((seed >> 16) & 0xff);
+            g_b[i][j] = (int16_t)(((seed >> 8) & 0xff) - 128 + i);
+        }
+    }
+
+    for (int iter = 0; iter < BENCH_ITERATIONS; iter++)
+        crc = matrix_test((int16_t)(iter * 3 + 5), crc);
+    return bench_check(crc, MATRIX_EXPECTED);
+}
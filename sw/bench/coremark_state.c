@@ -0,0 +1,179 @@
+// CoreMark style state machine kernel: classifies comma separated number
+// literals byte by byte, switch dispatch with hard to predict branches.
+
+#include "bench.h"
+
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    12
+#endif
+
+#define STATE_EXPECTED      0x0000be81u
+
+typedef enum {
+    STATE_START,
+    STATE_INVALID,
+    STATE_S1,
+    STATE_S2,
+    STATE_INT,
+    STATE_FLOAT,
+    STATE_EXPONENT,
+    STATE_SCIENTIFIC,
+    NUM_STATES
+} state_e;
+
+static const char* const g_patterns[] = {
+    "5012", "1234", "-874", "+122",
+    "35.54400", ".1234500", "-110.700", "+0.64400",
+    "5.500e+3", "-.123e-2", "-87e+832", "+0.6e-12",
+    "T0.3e-1F", "-T.T++Tq", "1T3.4e4z", "34.0e-T^",
+};
+
+#define NUM_PATTERNS    (sizeof(g_patterns) / sizeof(g_patterns[0]))
+#define INPUT_SIZE      512
+
+static uint8_t g_input[INPUT_SIZE + 1];
+
+static int is_digit(uint8_t c) {
+    return c >= '0' && c <= '9';
+}
+
+// advances to the next ',' and returns the final state of the literal
+static state_e next_state(uint8_t** instr, uint32_t transitions[NUM_STATES]) {
+    uint8_t* str = *instr;
+    state_e state = STATE_START;
+    for (; *str && state != STATE_INVALID; str++) {
+        uint8_t c = *str;
+        if (c == ',') {
+            str++;
+            break;
+        }
+        switch (state) {
+        case STATE_START:
+            if (is_digit(c))
+                state = STATE_INT;
+            else if (c == '+' || c == '-')
+                state = STATE_S1;
+            else if (c == '.')
+                state = STATE_FLOAT;
+            else
+                state = STATE_INVALID;
+            transitions[STATE_START]++;
+            break;
+        case STATE_S1:
+            if (is_digit(c))
+                state = STATE_INT;
+            else if (c == '.')
+                state = STATE_FLOAT;
+            else
+                state = STATE_INVALID;
+            transitions[STATE_S1]++;
+            break;
+        case STATE_INT:
+            if (c == '.') {
+                state = STATE_FLOAT;
+                transitions[STATE_INT]++;
+            } else if (!is_digit(c)) {
+                state = STATE_INVALID;
+                transitions[STATE_INT]++;
+            }
+            break;
+        case STATE_FLOAT:
+            if (c == 'E' || c == 'e') {
+                state = STATE_S2;
+                transitions[STATE_FLOAT]++;
+            } else if (!is_digit(c)) {
+                state = STATE_INVALID;
+                transitions[STATE_FLOAT]++;
+            }
+            break;
+        case STATE_S2:
+            if (c == '+' || c == '-')
+                state = STATE_EXPONENT;
+            else
+                state = STATE_INVALID;
+            transitions[STATE_S2]++;
+            break;
+        case STATE_EXPONENT:
+            if (is_digit(c))
+                state = STATE_SCIENTIFIC;
+            else
+                state = STATE_INVALID;
+            transitions[STATE_EXPONENT]++;
+            break;
+        case STATE_SCIENTIFIC:
+            if (!is_digit(c)) {
+                state = STATE_INVALID;
+                transitions[STATE_SCIENTIFIC]++;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    // skip the rest of an invalid literal
+    while (*str && str[-1] != ',')
+        str++;
+    *instr = str;
+    return state;
+}
+
+static uint16_t state_run(uint32_t final_counts[NUM_STATES], uint32_t transitions[NUM_STATES]) {
+    uint8_t* p = g_input;
+    uint16_t crc = 0;
+    while (*p) {
+        state_e s = next_state(&p, transitions);
+        final_counts[s]++;
+        crc = bench_crc8((uint8_t)s, crc);
+    }
+    return crc;
+}
+
+// flips bytes in place, every step'th one, so that patterns change between runs
+static void state_scramble(uint8_t xor_val, int step) {
+    for (int i = 0; i < INPUT_SIZE; i += step)
+        if (g_input[i] != ',')
+            g_input[i] ^= xor_val;
+}
+
+static void state_init(uint32_t seed) {
+    int pos = 0;
+    for (;;) {
+        seed = seed * 1664525u + 1013904223u;
+        const char* pat = g_patterns[(seed >> 24) % NUM_PATTERNS];
+        int len = 0;
+        while (pat[len])
+            len++;
+        if (pos + len + 1 > INPUT_SIZE)
+            break;
+        for (int i = 0; i < len; i++)
+            g_input[pos++] = (uint8_t)pat[i];
+        g_input[pos++] = ',';
+    }
+    while (pos < INPUT_SIZE)
+        g_input[pos++] = ',';
+    g_input[INPUT_SIZE] = 0;
+}
+
+int main(void) {
+    uint32_t final_counts[NUM_STATES];
+    uint32_t transitions[NUM_STATES];
+    uint16_t crc = 0;
+
+    state_init(0x5eed);
+    for (int iter = 0; iter < BENCH_ITERATIONS; iter++) {
+        memset(final_counts, 0, sizeof(final_counts));
+        memset(transitions, 0, sizeof(transitions));
+        crc = bench_crc16((int16_t)state_run(final_counts, transitions), crc);
+        // corrupt the input and run again, then restore it
+        uint8_t xor_val = (uint8_t)(1 + (iter & 7));
+        int step = 3 + (iter % 5);
+        state_scramble(xor_val, step);
+        crc = bench_crc16((int16_t)state_run(final_counts, transitions), crc);
+        state_scramble(xor_val, step);
+        for (int i = 0; i < NUM_STATES; i++) {
+            crc = bench_crc32(final_counts[i], crc);
+            crc = bench_crc32(transitions[i], crc);
+        }
+    }
+    return bench_check(crc, STATE_EXPECTED);
+}
@@ -0,0 +1,188 @@
+// Dhrystone style integer kernel: record copies through pointers, string
+// assignment and comparison, small procedure calls and 2d array updates.
+
+#include "bench.h"
+
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    500
+#endif
+
+#define DHRY_EXPECTED       0x00000361u
+
+typedef enum { IDENT_1, IDENT_2, IDENT_3, IDENT_4, IDENT_5 } dhry_enum;
+
+typedef struct dhry_record {
+    struct dhry_record* ptr_comp;
+    dhry_enum discr;
+    dhry_enum enum_comp;
+    int int_comp;
+    char str_comp[31];
+} dhry_record;
+
+static dhry_record g_rec_a, g_rec_b;
+static dhry_record* g_ptr_glob;
+static int g_int_glob;
+static int g_bool_glob;
+static char g_char_1_glob, g_char_2_glob;
+static int g_arr_1_glob[50];
+static int g_arr_2_glob[50][50];
+
+static int func_3(dhry_enum val) {
+    return val == IDENT_3;
+}
+
+static dhry_enum func_1(char ch_1, char ch_2) {
+    if (ch_1 != ch_2)
+        return IDENT_1;
+    g_char_1_glob = ch_1;
+    return IDENT_2;
+}
+
+static int func_2(const char* str_1, const char* str_2) {
+    int loc = 2;
+    char ch = 'A';
+    while (loc <= 2) {
+        if (func_1(str_1[loc], str_2[loc + 1]) == IDENT_1) {
+            ch = 'A';
+            loc++;
+        }
+    }
+    if (ch >= 'W' && ch < 'Z')
+        loc = 7;
+    if (ch == 'R')
+        return 1;
+    if (strcmp(str_1, str_2) > 0) {
+        g_int_glob = loc + 7;
+        return 1;
+    }
+    return 0;
+}
+
+static void proc_7(int a, int b, int* res) {
+    *res = b + a + 2;
+}
+
+static void proc_6(dhry_enum val, dhry_enum* res) {
+    *res = val;
+    if (!func_3(val))
+        *res = IDENT_4;
+    switch (val) {
+    case IDENT_1: *res = IDENT_1; break;
+    case IDENT_2: *res = g_int_glob > 100 ? IDENT_1 : IDENT_4; break;
+    case IDENT_3: *res = IDENT_2; break;
+    case IDENT_4: break;
+    case IDENT_5: *res = IDENT_3; break;
+    }
+}
+
+static void proc_8(int arr_1[50], int arr_2[50][50], int val_1, int val_2) {
+    int loc = val_1 + 5;
+    arr_1[loc] = val_2;
+    arr_1[loc + 1] = arr_1[loc];
+    arr_1[loc + 30] = loc;
+    for (int i = loc; i <= loc + 1; i++)
+        arr_2[loc][i] = loc;
+    arr_2[loc][loc - 1] += 1;
+    arr_2[loc + 20][loc] = arr_1[loc];
+    g_int_glob = 5;
+}
+
+static void proc_3(dhry_record** res) {
+    if (g_ptr_glob)
+        *res = g_ptr_glob->ptr_comp;
+    proc_7(10, g_int_glob, &g_ptr_glob->int_comp);
+}
+
+static void proc_1(dhry_record* val) {
+    dhry_record* next = val->ptr_comp;
+    *val->ptr_comp = *g_ptr_glob;
+    val->int_comp = 5;
+    next->int_comp = val->int_comp;
+    next->ptr_comp = val->ptr_comp;
+    proc_3(&next->ptr_comp);
+    if (next->discr == IDENT_1) {
+        next->int_comp = 6;
+        proc_6(val->enum_comp, &next->enum_comp);
+        next->ptr_comp = g_ptr_glob->ptr_comp;
+        proc_7(next->int_comp, 10, &next->int_comp);
+    } else {
+        *val = *val->ptr_comp;
+    }
+}
+
+static void proc_2(int* val) {
+    int loc = *val + 10;
+    dhry_enum e = IDENT_2;
+    do {
+        if (g_char_1_glob == 'A') {
+            loc--;
+            *val = loc - g_int_glob;
+            e = IDENT_1;
+        }
+    } while (e != IDENT_1);
+}
+
+static void proc_4(void) {
+    int b = g_char_1_glob == 'A';
+    g_bool_glob = b | g_bool_glob;
+    g_char_2_glob = 'B';
+}
+
+static void proc_5(void) {
+    g_char_1_glob = 'A';
+    g_bool_glob = 0;
+}
+
+int main(void) {
+    char str_1[31], str_2[31];
+    int int_1 = 0, int_2 = 0, int_3 = 0;
+    dhry_enum enum_loc = IDENT_1;
+    uint16_t crc = 0;
+
+    g_ptr_glob = &g_rec_a;
+    g_rec_a.ptr_comp = &g_rec_b;
+    g_rec_a.discr = IDENT_1;
+    g_rec_a.enum_comp = IDENT_3;
+    g_rec_a.int_comp = 40;
+    strcpy(g_rec_a.str_comp, "DHRYSTONE PROGRAM, SOME STRING");
+    strcpy(str_1, "DHRYSTONE PROGRAM, 1'ST STRING");
+    g_arr_2_glob[8][7] = 10;
+
+    for (int run = 1; run <= BENCH_ITERATIONS; run++) {
+        proc_5();
+        proc_4();
+        int_1 = 2;
+        int_2 = 3;
+        strcpy(str_2, "DHRYSTONE PROGRAM, 2'ND STRING");
+        enum_loc = IDENT_2;
+        g_bool_glob = !func_2(str_1, str_2);
+        while (int_1 < int_2) {
+            int_3 = 5 * int_1 - int_2;
+            proc_7(int_1, int_2, &int_3);
+            int_1++;
+        }
+        proc_8(g_arr_1_glob, g_arr_2_glob, int_1, int_3);
+        proc_1(g_ptr_glob);
+        for (char ch = 'A'; ch <= g_char_2_glob; ch++) {
+            if (enum_loc == func_1(ch, 'C')) {
+                proc_6(IDENT_1, &enum_loc);
+                strcpy(str_2, "DHRYSTONE PROGRAM, 3'RD STRING");
+                int_2 = run;
+                g_int_glob = run;
+            }
+        }
+        int_2 = int_2 * int_1;
+        int_1 = int_2 / int_3;
+        int_2 = 7 * (int_2 - int_3) - int_1;
+        proc_2(&int_1);
+        crc = bench_crc32((uint32_t)(int_1 + int_2 + int_3), crc);
+    }
+
+    crc = bench_crc32((uint32_t)g_int_glob, crc);
+    crc = bench_crc32((uint32_t)g_arr_2_glob[8][7], crc);
+    crc = bench_crc32((uint32_t)g_ptr_glob->int_comp, crc);
+    crc = bench_crc32((uint32_t)g_ptr_glob->ptr_comp->int_comp, crc);
+    crc = bench_crc8((uint8_t)g_char_2_glob, crc);
+    crc = bench_crc8((uint8_t)str_2[27], crc);
+    return bench_check(crc, DHRY_EXPECTED);
+}
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Runs the bench workloads on xrv1, mrv1 and the isa model, writes simulated
+cycles, guest IPC and host simulation speed per workload as json and compares
+them against a stored baseline."""
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+
+def find_binary(build_dir, name):
+    for path in glob.glob(os.path.join(build_dir, "**", name), recursive=True):
+        if os.access(path, os.X_OK):
+            return path
+    return None
+
+
+def find_mrv1_binaries(build_dir):
+    bins = {}
+    for path in glob.glob(os.path.join(build_dir, "**", "mrv1_sim_t*"), recursive=True):
+        m = re.search(r"mrv1_sim_t(\d+)$", path)
+        if m and os.access(path, os.X_OK):
+            bins[int(m.group(1))] = path
+    return dict(sorted(bins.items()))
+
+
+def workload_name(elf):
+    return os.path.splitext(os.path.basename(elf))[0]
+
+
+def run_xrv1_bench(binary, model, elfs, cycles, extra_args):
+    """xrv1_bench runs all workloads of one model in a single process."""
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "bench.json")
+        subprocess.run([binary, "-m", model, "-c", str(cycles), "-o", out] + extra_args + elfs)
+        if not os.path.exists(out):
+            return []
+        with open(out) as f:
+            return json.load(f)
+
+
+def run_mrv1(binary, threads, elf, cycles):
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "perf.json")
+        res = subprocess.run([binary, "-e", elf, "-c", str(cycles), "-j", out, "-q"])
+        if res.returncode not in (0, 2, 3) or not os.path.exists(out):
+            return None
+        with open(out) as f:
+            perf = json.load(f)
+    cycles = perf["cycles"]
+    return {
+        "model": "mrv1_t{}".format(threads),
+        "workload": workload_name(elf),
+        "finished": res.returncode != 2,
+        "passed": res.returncode == 0,
+        "cycles": cycles,
+        "instret": perf["instret"],
+        "ipc": perf["instret"] / cycles if cycles else 0.0,
+        "khz": perf["cycles_per_sec"] / 1000.0,
+    }
+
+
+def compare(results, baseline, cycle_tol, khz_tol):
+    """Returns the number of regressions against the baseline."""
+    base = {(r["model"], r["workload"]): r for r in baseline}
+    regressions = 0
+    print("{:<10} {:<18} {:>12} {:>8} {:>10} {:>9} {:>9}".format(
+        "model", "workload", "cycles", "ipc", "kHz", "d_cycles", "d_kHz"))
+    for r in results:
+        b = base.get((r["model"], r["workload"]))
+        d_cycles = d_khz = ""
+        notes = []
+        if not r["passed"]:
+            notes.append("FAILED" if r["finished"] else "TIMEOUT")
+            # known failures of the baseline are reported, but not counted
+            if not b or b["passed"]:
+                regressions += 1
+        if b:
+            if b["cycles"]:
+                rel = r["cycles"] / b["cycles"] - 1.0
+                d_cycles = "{:+.1%}".format(rel)
+                if rel > cycle_tol:
+                    notes.append("cycles regressed")
+                    regressions += 1
+            if b["khz"]:
+                rel = r["khz"] / b["khz"] - 1.0
+                d_khz = "{:+.1%}".format(rel)
+                if rel < -khz_tol:
+                    notes.append("host speed regressed")
+                    regressions += 1
+        print("{:<10} {:<18} {:>12} {:>8.3f} {:>10.1f} {:>9} {:>9}  {}".format(
+            r["model"], r["workload"], r["cycles"], r["ipc"], r["khz"], d_cycles, d_khz, ", ".join(notes)))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("elfs", nargs="+", help="workload elf files")
+    parser.add_argument("-b", "--build-dir", default=".", help="cmake build directory")
+    parser.add_argument("-c", "--cycles", type=int, default=10000000, help="cycle limit per run")
+    parser.add_argument("-o", "--output", default="bench.json", help="results json")
+    parser.add_argument("--baseline", help="results json of an earlier run to compare against")
+    parser.add_argument("--update-baseline", action="store_true", help="overwrite the baseline with this run")
+    parser.add_argument("--cycle-tolerance", type=float, default=0.02,
+                        help="allowed relative increase of simulated cycles")
+    parser.add_argument("--khz-tolerance", type=float, default=0.25,
+                        help="allowed relative drop of host simulation speed")
+    parser.add_argument("--jit", action="store_true", help="run the isa model with block translation")
+    args = parser.parse_args()
+
+    results = []
+    bench = find_binary(args.build_dir, "xrv1_bench")
+    if bench:
+        results += run_xrv1_bench(bench, "xrv1", args.elfs, args.cycles, [])
+        results += run_xrv1_bench(bench, "isa", args.elfs, args.cycles, ["--jit"] if args.jit else [])
+    else:
+        print("No xrv1_bench in {}, configure with -DBUILD_PYTHON_LIBRARY=ON".format(args.build_dir))
+
+    for threads, binary in find_mrv1_binaries(args.build_dir).items():
+        for elf in args.elfs:
+            res = run_mrv1(binary, threads, elf, args.cycles)
+            if res is None:
+                res = {"model": "mrv1_t{}".format(threads), "workload": workload_name(elf),
+                       "finished": False, "passed": False, "cycles": 0, "instret": 0, "ipc": 0.0, "khz": 0.0}
+            results.append(res)
+
+    if not results:
+        return 1
+    with open(args.output, "w") as f:
+        json.dump({"results": results}, f, indent=2)
+
+    baseline = []
+    if args.baseline and os.path.exists(args.baseline) and not args.update_baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)["results"]
+    regressions = compare(results, baseline, args.cycle_tolerance, args.khz_tolerance)
+
+    if args.baseline and args.update_baseline:
+        with open(args.baseline, "w") as f:
+            json.dump({"results": results}, f, indent=2)
+        print("Baseline {} updated".format(args.baseline))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -28,6 +28,10 @@
   addi t5, t5, -4;        \
   la t6, sig_end;         \
   sw t5, 0(t6);           \
+  /* tohost = (0 << 1) | 1 ends the run right away, see xrv1_htif */ \
+  li t5, 1;               \
+  la t6, tohost;          \
+  sw t5, 0(t6);           \
   nop; nop; nop; \
   nop; nop; nop; \
   wfi;                    \
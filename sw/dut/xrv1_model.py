@@ -0,0 +1,18 @@
+import importlib
+import os
+
+# Both model flavors are built with BUILD_PYTHON_LIBRARY:
+#   fast  - libdut, no tracing or coverage instrumentation
+#   debug - libdut_debug, coverage and the TRACE_FORMAT waveform support
+FLAVORS = {
+    'fast': 'libdut',
+    'debug': 'libdut_debug',
+}
+
+
+def load(flavor=None):
+    """Returns the libdut module of flavor, XRV1_MODEL or 'fast' if not given"""
+    flavor = flavor or os.environ.get('XRV1_MODEL', 'fast')
+    if flavor not in FLAVORS:
+        raise ValueError("unknown model flavor '{}', expected one of {}".format(flavor, ', '.join(FLAVORS)))
+    return importlib.import_module(FLAVORS[flavor])
@@ -56,6 +56,19 @@ void cosim::attach_cpu(std::string name, cosim_cpu_api *p)
     item.cpu  = p;
 
     m_cpu.push_back(item);
+
+    // Memory events are only worth recording once there is something to compare against
+    if (m_cpu.size() == 2)
+    {
+        for (std::vector<cosim_cpu_item>::iterator it = m_cpu.begin() ; it != m_cpu.end(); ++it)
+            for (int ev = COSIM_EVENT_LOAD; ev <= COSIM_EVENT_STORE; ev++)
+                it->cpu->event_subscribe((t_cosim_event)ev);
+    }
+    else if (m_cpu.size() > 2)
+    {
+        for (int ev = COSIM_EVENT_LOAD; ev <= COSIM_EVENT_STORE; ev++)
+            p->event_subscribe((t_cosim_event)ev);
+    }
 }
 //--------------------------------------------------------------------
 // attach_mem
@@ -108,7 +121,7 @@ bool cosim::get_stopped(void)
 //--------------------------------------------------------------------
 void cosim::step(void)
 {
-    for (int ev = COSIM_EVENT_LOAD; ev < COSIM_EVENT_MAX; ev++)
+    for (int ev = COSIM_EVENT_LOAD; ev <= COSIM_EVENT_STORE; ev++)
     {
         bool all_ready = true;
         for (std::vector<cosim_cpu_item>::iterator it = m_cpu.begin() ; it != m_cpu.end(); ++it)
@@ -281,6 +294,14 @@ uint32_t cosim::read_word(uint32_t addr)
 // at_exit: On simulation exit
 //--------------------------------------------------------------------
 void cosim::at_exit(uint32_t exit_code)
+{
+    dump_memory();
+    exit(exit_code);
+}
+//--------------------------------------------------------------------
+// dump_memory: Post simulation memory dump, if set with dump_on_exit
+//--------------------------------------------------------------------
+void cosim::dump_memory(void)
 {
     if (m_dump_file)
     {
@@ -331,6 +352,366 @@ void cosim::at_exit(uint32_t exit_code)
         delete buffer;
         buffer = NULL;
     }
+}
+//--------------------------------------------------------------------
+// cosim_runner::start: Start stepping cpu on a worker thread
+//--------------------------------------------------------------------
+bool cosim_runner::start(cosim_cpu_api *cpu, uint64_t max_steps /*= 0*/)
+{
+    if (m_thread.joinable())
+        return false;
 
-    exit(exit_code);
+    m_cpu     = cpu;
+    m_stop    = false;
+    m_steps   = 0;
+    m_running = true;
+    m_thread  = std::thread(&cosim_runner::run, this, max_steps);
+    return true;
+}
+//--------------------------------------------------------------------
+// cosim_runner::stop: Stop worker thread
+//--------------------------------------------------------------------
+void cosim_runner::stop(void)
+{
+    if (!m_thread.joinable())
+        return ;
+
+    m_stop = true;
+    // Producer might be stalled on a full event ring
+    m_cpu->event_abort();
+    m_thread.join();
+}
+//--------------------------------------------------------------------
+// cosim_runner::run: Worker thread
+//--------------------------------------------------------------------
+void cosim_runner::run(uint64_t max_steps)
+{
+    uint64_t steps = 0;
+
+    while (!m_stop.load(std::memory_order_relaxed) && !m_cpu->get_fault() && !m_cpu->get_stopped())
+    {
+        if (max_steps && steps == max_steps)
+            break;
+
+        m_cpu->step();
+        m_steps.store(++steps, std::memory_order_relaxed);
+    }
+
+    m_running.store(false, std::memory_order_release);
+}
+//--------------------------------------------------------------------
+// cosim_harts: Constructor
+//--------------------------------------------------------------------
+cosim_harts::cosim_harts()
+{
+    m_quantum       = 1000;
+    m_deterministic = false;
+    m_threads       = 0;
+    m_quantums      = 0;
+    m_run_insns     = 0;
+    m_num_workers   = 0;
+    m_generation    = 0;
+    m_pending       = 0;
+    m_exit          = false;
+}
+//--------------------------------------------------------------------
+// cosim_harts: Destructor
+//--------------------------------------------------------------------
+cosim_harts::~cosim_harts()
+{
+    stop_workers();
+
+    for (std::vector<uint8_t *>::iterator it = m_mem_bufs.begin() ; it != m_mem_bufs.end(); ++it)
+        delete [] *it;
+}
+//--------------------------------------------------------------------
+// attach_hart
+//--------------------------------------------------------------------
+void cosim_harts::attach_hart(std::string name, cosim_cpu_api *cpu, cosim_mem_api *mem)
+{
+    cosim_cpu_item item;
+
+    item.name = name;
+    item.cpu  = cpu;
+
+    // Workers are assigned harts when started
+    stop_workers();
+
+    m_harts.push_back(item);
+    m_hart_mem.push_back(mem);
+    m_executed.push_back(0);
+}
+//--------------------------------------------------------------------
+// reset: Reset all harts to execute from specified PC
+//--------------------------------------------------------------------
+void cosim_harts::reset(uint32_t pc)
+{
+    for (std::vector<cosim_cpu_item>::iterator it = m_harts.begin() ; it != m_harts.end(); ++it)
+        it->cpu->reset(pc);
+
+    m_quantums = 0;
+}
+//--------------------------------------------------------------------
+// get_fault: Any hart faulted
+//--------------------------------------------------------------------
+bool cosim_harts::get_fault(void)
+{
+    bool fault = false;
+
+    for (std::vector<cosim_cpu_item>::iterator it = m_harts.begin() ; it != m_harts.end(); ++it)
+        fault |= it->cpu->get_fault();
+
+    return fault;
+}
+//--------------------------------------------------------------------
+// get_stopped: Any hart stopped
+//--------------------------------------------------------------------
+bool cosim_harts::get_stopped(void)
+{
+    bool stopped = false;
+
+    for (std::vector<cosim_cpu_item>::iterator it = m_harts.begin() ; it != m_harts.end(); ++it)
+        stopped |= it->cpu->get_stopped();
+
+    return stopped;
+}
+//--------------------------------------------------------------------
+// run_hart: Run one quantum on a hart
+//--------------------------------------------------------------------
+void cosim_harts::run_hart(size_t hart)
+{
+    m_executed[hart] = m_harts[hart].cpu->run(m_run_insns);
+}
+//--------------------------------------------------------------------
+// step: Execute one instruction on every hart
+//--------------------------------------------------------------------
+void cosim_harts::step(void)
+{
+    for (std::vector<cosim_cpu_item>::iterator it = m_harts.begin() ; it != m_harts.end(); ++it)
+        if (!it->cpu->get_fault() && !it->cpu->get_stopped())
+            it->cpu->step();
+}
+//--------------------------------------------------------------------
+// run: Run quantums until hart 0 executed max_steps instructions
+//--------------------------------------------------------------------
+uint64_t cosim_harts::run(uint64_t max_steps)
+{
+    uint64_t steps = 0;
+
+    while (steps < max_steps && !get_fault() && !get_stopped())
+    {
+        uint64_t insns = max_steps - steps;
+
+        if (insns > m_quantum)
+            insns = m_quantum;
+
+        run_quantum(insns);
+
+        // Hart 0 made no progress, e.g. it is waiting on a breakpoint
+        if (!m_executed[0])
+            break;
+        steps += m_executed[0];
+    }
+
+    return steps;
+}
+//--------------------------------------------------------------------
+// run_quantum: Run insns instructions on every hart
+//--------------------------------------------------------------------
+void cosim_harts::run_quantum(uint64_t insns)
+{
+    m_run_insns = insns;
+
+    if (m_deterministic || m_harts.size() == 1)
+    {
+        for (size_t h=0;h<m_harts.size();h++)
+            run_hart(h);
+    }
+    else
+    {
+        if (m_workers.empty())
+            start_workers();
+
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_pending = m_num_workers;
+        m_generation++;
+        m_start_cv.notify_all();
+
+        // Quantum boundary, all stores are visible past this point
+        m_done_cv.wait(lock, [this] { return m_pending == 0; });
+    }
+
+    m_quantums++;
+}
+//--------------------------------------------------------------------
+// start_workers: Create worker threads
+//--------------------------------------------------------------------
+void cosim_harts::start_workers(void)
+{
+    int threads = m_threads;
+
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0 || threads > (int)m_harts.size())
+        threads = (int)m_harts.size();
+
+    m_exit        = false;
+    m_num_workers = threads;
+    for (int i=0;i<threads;i++)
+        m_workers.push_back(std::thread(&cosim_harts::worker, this, i));
+}
+//--------------------------------------------------------------------
+// stop_workers: Shut down worker threads
+//--------------------------------------------------------------------
+void cosim_harts::stop_workers(void)
+{
+    if (m_workers.empty())
+        return ;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_exit = true;
+    }
+    m_start_cv.notify_all();
+
+    for (std::vector<std::thread>::iterator it = m_workers.begin() ; it != m_workers.end(); ++it)
+        it->join();
+
+    m_workers.clear();
+    m_num_workers = 0;
+}
+//--------------------------------------------------------------------
+// worker: Runs quantums of harts idx, idx + workers, ...
+//--------------------------------------------------------------------
+void cosim_harts::worker(int idx)
+{
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_start_cv.wait(lock, [&] { return m_exit || m_generation != generation; });
+            if (m_exit)
+                return ;
+            generation = m_generation;
+        }
+
+        for (size_t h=idx;h<m_harts.size();h+=m_num_workers)
+            run_hart(h);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (--m_pending == 0)
+            m_done_cv.notify_one();
+    }
+}
+//--------------------------------------------------------------------
+// get_opcode:
+//--------------------------------------------------------------------
+uint32_t cosim_harts::get_opcode(void)
+{
+    return m_harts.front().cpu->get_opcode();
+}
+//--------------------------------------------------------------------
+// get_pc:
+//--------------------------------------------------------------------
+uint32_t cosim_harts::get_pc(void)
+{
+    return m_harts.front().cpu->get_pc();
+}
+//--------------------------------------------------------------------
+// get_reg_valid:
+//--------------------------------------------------------------------
+bool cosim_harts::get_reg_valid(int r)
+{
+    return m_harts.front().cpu->get_reg_valid(r);
+}
+//--------------------------------------------------------------------
+// get_register:
+//--------------------------------------------------------------------
+uint32_t cosim_harts::get_register(int r)
+{
+    return m_harts.front().cpu->get_register(r);
+}
+//--------------------------------------------------------------------
+// get_num_reg:
+//--------------------------------------------------------------------
+int cosim_harts::get_num_reg(void)
+{
+    return m_harts.front().cpu->get_num_reg();
+}
+//--------------------------------------------------------------------
+// set_register:
+//--------------------------------------------------------------------
+void cosim_harts::set_register(int r, uint32_t val)
+{
+    for (std::vector<cosim_cpu_item>::iterator it = m_harts.begin() ; it != m_harts.end(); ++it)
+        it->cpu->set_register(r, val);
+}
+//--------------------------------------------------------------------
+// set_interrupt:
+//--------------------------------------------------------------------
+void cosim_harts::set_interrupt(int irq)
+{
+    for (std::vector<cosim_cpu_item>::iterator it = m_harts.begin() ; it != m_harts.end(); ++it)
+        it->cpu->set_interrupt(irq);
+}
+//--------------------------------------------------------------------
+// enable_trace:
+//--------------------------------------------------------------------
+void cosim_harts::enable_trace(uint32_t mask)
+{
+    for (std::vector<cosim_cpu_item>::iterator it = m_harts.begin() ; it != m_harts.end(); ++it)
+        it->cpu->enable_trace(mask);
+}
+//--------------------------------------------------------------------
+// enable_jit:
+//--------------------------------------------------------------------
+bool cosim_harts::enable_jit(bool enable)
+{
+    bool ok = true;
+
+    for (std::vector<cosim_cpu_item>::iterator it = m_harts.begin() ; it != m_harts.end(); ++it)
+        ok &= it->cpu->enable_jit(enable);
+
+    return ok;
+}
+//--------------------------------------------------------------------
+// create_memory: Create a region backed by one buffer for all harts
+//--------------------------------------------------------------------
+bool cosim_harts::create_memory(uint32_t addr, uint32_t size, uint8_t *mem /*= NULL*/)
+{
+    bool ok = true;
+
+    if (!mem)
+    {
+        mem = new uint8_t[size];
+        m_mem_bufs.push_back(mem);
+    }
+
+    for (std::vector<cosim_mem_api *>::iterator it = m_hart_mem.begin() ; it != m_hart_mem.end(); ++it)
+        ok &= (*it)->create_memory(addr, size, mem);
+
+    return ok;
+}
+//--------------------------------------------------------------------
+// valid_addr:
+//--------------------------------------------------------------------
+bool cosim_harts::valid_addr(uint32_t addr)
+{
+    return m_hart_mem.front()->valid_addr(addr);
+}
+//--------------------------------------------------------------------
+// write: Byte write
+//--------------------------------------------------------------------
+void cosim_harts::write(uint32_t addr, uint8_t data)
+{
+    m_hart_mem.front()->write(addr, data);
+}
+//--------------------------------------------------------------------
+// read: Byte read
+//--------------------------------------------------------------------
+uint8_t cosim_harts::read(uint32_t addr)
+{
+    return m_hart_mem.front()->read(addr);
 }
@@ -3,8 +3,11 @@
 
 #include <stdint.h>
 #include <vector>
-#include <queue>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 //--------------------------------------------------------------------
 // Cosimulation events
@@ -14,6 +17,10 @@ typedef enum e_cosim_event
     COSIM_EVENT_LOAD,
     COSIM_EVENT_LOAD_RESULT,
     COSIM_EVENT_STORE,
+    // arg1 = pc, arg2 = opcode of a completed instruction
+    COSIM_EVENT_RETIRE,
+    // arg1 = rd field, arg2 = its value, pushed just before RETIRE
+    COSIM_EVENT_WRITEBACK,
     COSIM_EVENT_MAX
 } t_cosim_event;
 
@@ -25,12 +32,96 @@ public:
     uint32_t arg2;
 };
 
+#define COSIM_EVENT_RING_SIZE   4096
+
+//--------------------------------------------------------------------
+// Fixed size single producer / single consumer event ring
+//--------------------------------------------------------------------
+class cosim_event_ring
+{
+public:
+    cosim_event_ring() : m_buf(NULL), m_mask(0), m_wait(false), m_abort(false),
+                         m_head(0), m_tail(0), m_dropped(0) { }
+    ~cosim_event_ring() { close(); }
+
+    // Allocate space for size (power of 2) events. When wait is set a full
+    // ring stalls the producer until the consumer catches up, otherwise
+    // new events are dropped.
+    void open(uint32_t size, bool wait)
+    {
+        close();
+        m_buf   = new cosim_event[size];
+        m_mask  = size - 1;
+        m_wait  = wait;
+        m_abort = false;
+        m_head  = 0;
+        m_tail  = 0;
+        m_dropped = 0;
+    }
+    void close(void)
+    {
+        delete [] m_buf;
+        m_buf = NULL;
+    }
+    // Release a producer stalled on a full ring, following pushes are dropped
+    void abort(void) { m_abort = true; }
+
+    bool enabled(void) const { return m_buf != NULL; }
+    bool empty(void) const   { return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire); }
+    uint64_t dropped(void) const { return m_dropped; }
+
+    // Producer side
+    bool push(const cosim_event &item)
+    {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+
+        while (tail - m_head.load(std::memory_order_acquire) > m_mask)
+        {
+            if (!m_wait || m_abort.load(std::memory_order_relaxed))
+            {
+                m_dropped++;
+                return false;
+            }
+            std::this_thread::yield();
+        }
+
+        m_buf[tail & m_mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(cosim_event *item)
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        *item = m_buf[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    cosim_event          *m_buf;
+    uint32_t              m_mask;
+    bool                  m_wait;
+    std::atomic<bool>     m_abort;
+    // Read by consumer / written by producer, on separate cache lines
+    alignas(64) std::atomic<uint32_t> m_head;
+    alignas(64) std::atomic<uint32_t> m_tail;
+    uint64_t              m_dropped;
+};
+
 //--------------------------------------------------------------------
 // Abstract interface for CPU simulation API
 //--------------------------------------------------------------------
 class cosim_cpu_api
 {
 public:
+    virtual ~cosim_cpu_api() {}
+
     // Reset core to execute from specified PC
     virtual void      reset(uint32_t pc) = 0;
 
@@ -42,9 +133,25 @@ public:
     // Execute one instruction
     virtual void      step(void) = 0;
 
+    // Execute up to max_steps instructions, returns number executed
+    virtual uint64_t  run(uint64_t max_steps)
+    {
+        uint64_t steps = 0;
+
+        while (steps < max_steps && !get_fault() && !get_stopped())
+        {
+            step();
+            steps++;
+        }
+        return steps;
+    }
+
+    // Select translated execution for run(), false if not supported
+    virtual bool      enable_jit(bool enable) { return !enable; }
+
     // Breakpoints
-    virtual bool      set_breakpoint(uint32_t pc)   { return false; }
-    virtual bool      clr_breakpoint(uint32_t pc) { return false; }
+    virtual bool      set_breakpoint(uint32_t /*pc*/) { return false; }
+    virtual bool      clr_breakpoint(uint32_t /*pc*/) { return false; }
 
     // State after execution
     virtual uint32_t  get_opcode(void) = 0;
@@ -54,7 +161,7 @@ public:
     virtual int       get_num_reg(void) = 0;
 
     virtual void      set_register(int r, uint32_t val) = 0;
-    virtual void      set_pc(uint32_t val) { }
+    virtual void      set_pc(uint32_t /*val*/) { }
 
     // Trigger interrupt
     virtual void      set_interrupt(int irq) = 0;
@@ -62,10 +169,24 @@ public:
     // Instruction trace
     virtual void      enable_trace(uint32_t mask) = 0;
 
-    // Event Queue
-    std::queue <cosim_event > event_q[COSIM_EVENT_MAX];
+    // Event Queue, events are only recorded for subscribed types
+    cosim_event_ring event_q[COSIM_EVENT_MAX];
+    void event_subscribe(t_cosim_event ev, uint32_t size = COSIM_EVENT_RING_SIZE, bool wait = false)
+    {
+        event_q[ev].open(size, wait);
+    }
+    void event_unsubscribe(t_cosim_event ev) { event_q[ev].close(); }
+    bool event_enabled(t_cosim_event ev) const { return event_q[ev].enabled(); }
+    void event_abort(void)
+    {
+        for (int ev = 0; ev < COSIM_EVENT_MAX; ev++)
+            event_q[ev].abort();
+    }
     void event_push(t_cosim_event ev, uint32_t arg1, uint32_t arg2)
     {
+        if (!event_q[ev].enabled())
+            return ;
+
         cosim_event item;
         
         item.type  = ev;
@@ -77,18 +198,48 @@ public:
     bool event_ready(t_cosim_event ev) { return !event_q[ev].empty(); }
     cosim_event event_pop(t_cosim_event ev) 
     { 
-        cosim_event item = event_q[ev].front();
-        event_q[ev].pop();
+        cosim_event item = cosim_event();
+        event_q[ev].pop(&item);
         return item;
     }
 };
 
+//--------------------------------------------------------------------
+// Runs a CPU model on its own thread, ahead of an event consumer
+//--------------------------------------------------------------------
+class cosim_runner
+{
+public:
+    cosim_runner() : m_cpu(NULL), m_stop(false), m_running(false), m_steps(0) { }
+    ~cosim_runner() { stop(); }
+
+    // Step cpu until it faults, stops or max_steps (0 - no limit) are done.
+    // Subscribe its events with wait set to bound how far it runs ahead.
+    bool start(cosim_cpu_api *cpu, uint64_t max_steps = 0);
+    // Abort event pushes and wait for the thread to exit
+    void stop(void);
+
+    bool     running(void) const { return m_running.load(std::memory_order_acquire); }
+    uint64_t get_steps(void) const { return m_steps.load(std::memory_order_relaxed); }
+
+private:
+    void run(uint64_t max_steps);
+
+    cosim_cpu_api        *m_cpu;
+    std::thread           m_thread;
+    std::atomic<bool>     m_stop;
+    std::atomic<bool>     m_running;
+    std::atomic<uint64_t> m_steps;
+};
+
 //--------------------------------------------------------------------
 // Abstract interface for memory access
 //--------------------------------------------------------------------
 class cosim_mem_api
 {
 public:
+    virtual ~cosim_mem_api() {}
+
     virtual bool    create_memory(uint32_t addr, uint32_t size, uint8_t *mem = NULL) = 0;
     virtual bool    valid_addr(uint32_t addr) = 0;
     virtual void    write(uint32_t addr, uint8_t data) = 0;
@@ -169,7 +320,9 @@ public:
     void     write_word(uint32_t addr, uint32_t data);
     uint32_t read_word(uint32_t addr);
 
+    // Memory dump then exit(), dump_memory() leaves exiting to the caller
     void    at_exit(uint32_t exitcode);
+    void    dump_memory(void);
 
     // Set memory dump on exit
     void    dump_on_exit(const char *filename, uint32_t dump_start, uint32_t dump_end)
@@ -188,4 +341,88 @@ private:
     uint32_t     m_dump_end;
 };
 
+//--------------------------------------------------------------------
+// Class: Multi-hart simulation with shared memory
+//
+// step() executes one instruction on each hart in hart order, so per
+// instruction checks (stop pc, trace pc, cycle limits) see every pc of
+// hart 0. run() executes quantums of instructions on each hart, its step
+// count is the number of instructions of hart 0. In parallel mode harts
+// run their quantum concurrently on worker threads: accesses of different
+// harts within a quantum are unordered, stores are visible to all harts
+// at the latest at the next quantum boundary. Deterministic mode runs the
+// harts one after another in hart order, so results only depend on the
+// program and the quantum.
+//--------------------------------------------------------------------
+class cosim_harts: public cosim_cpu_api, public cosim_mem_api
+{
+public:
+    cosim_harts();
+    ~cosim_harts();
+
+    // Harts are numbered in attach order
+    void attach_hart(std::string name, cosim_cpu_api *cpu, cosim_mem_api *mem);
+
+    // Instructions each hart runs between synchronisation points
+    void set_quantum(uint32_t insns)  { m_quantum = insns ? insns : 1; }
+    void set_deterministic(bool en)   { m_deterministic = en; }
+    // Worker threads, 0 - one per hart limited by host cores
+    void set_threads(int threads)     { m_threads = threads; }
+
+    int      get_num_harts(void)      { return (int)m_harts.size(); }
+    uint64_t get_quantums(void)       { return m_quantums; }
+
+    // cosim_cpu_api, state is reported for hart 0
+    void      reset(uint32_t pc);
+    bool      get_fault(void);
+    bool      get_stopped(void);
+    void      step(void);
+    uint64_t  run(uint64_t max_steps);
+    uint32_t  get_opcode(void);
+    uint32_t  get_pc(void);
+    bool      get_reg_valid(int r);
+    uint32_t  get_register(int r);
+    int       get_num_reg(void);
+    void      set_register(int r, uint32_t val);
+    void      set_interrupt(int irq);
+    void      enable_trace(uint32_t mask);
+    bool      enable_jit(bool enable);
+
+    // cosim_mem_api, one memory shared by all harts
+    bool    create_memory(uint32_t addr, uint32_t size, uint8_t *mem = NULL);
+    bool    valid_addr(uint32_t addr);
+    void    write(uint32_t addr, uint8_t data);
+    uint8_t read(uint32_t addr);
+
+private:
+    void    run_hart(size_t hart);
+    void    run_quantum(uint64_t insns);
+    void    start_workers(void);
+    void    stop_workers(void);
+    void    worker(int idx);
+
+    std::vector <cosim_cpu_item >  m_harts;
+    std::vector <cosim_mem_api *>  m_hart_mem;
+    std::vector <uint8_t *>        m_mem_bufs;
+    // Instructions each hart executed in the last quantum
+    std::vector <uint64_t>         m_executed;
+
+    uint32_t                 m_quantum;
+    bool                     m_deterministic;
+    int                      m_threads;
+    uint64_t                 m_quantums;
+    // Length of the quantum being run, the last one of run() may be shorter
+    uint64_t                 m_run_insns;
+
+    // Worker pool, woken up once per quantum
+    std::vector <std::thread > m_workers;
+    int                      m_num_workers;
+    std::mutex               m_lock;
+    std::condition_variable  m_start_cv;
+    std::condition_variable  m_done_cv;
+    uint64_t                 m_generation;
+    int                      m_pending;
+    bool                     m_exit;
+};
+
 #endif
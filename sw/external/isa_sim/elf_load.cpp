@@ -169,3 +169,60 @@ long elf_get_symbol(const char *filename, const char *symname)
     bfd_close(ibfd);
     return -1;
 }
+//-----------------------------------------------------------------
+// elf_get_symbols: Report all code symbols, returns number found
+//-----------------------------------------------------------------
+int elf_get_symbols(const char *filename, cb_symbol fn_symbol, void *arg)
+{
+    bfd *ibfd;
+    asymbol **symtab;
+    long nsize, nsyms, i;
+    char **matching;
+    int count = 0;
+
+    bfd_init();
+    ibfd = bfd_openr(filename, NULL);
+
+    if (ibfd == NULL) 
+    {
+        printf("bfd_openr error\n");
+        return -1;
+    }
+
+    if (!bfd_check_format_matches(ibfd, bfd_object, &matching)) 
+    {
+        printf("format_matches\n");
+        bfd_close(ibfd);
+        return -1;
+    }
+
+    nsize = bfd_get_symtab_upper_bound (ibfd);
+    if (nsize <= 0)
+    {
+        bfd_close(ibfd);
+        return 0;
+    }
+
+    symtab = (asymbol **)malloc(nsize);
+    nsyms = bfd_canonicalize_symtab(ibfd, symtab);
+
+    for (i = 0; i < nsyms; i++) 
+    {
+        asymbol *sym = symtab[i];
+
+        if (sym->flags & (BSF_SECTION_SYM | BSF_FILE | BSF_DEBUGGING))
+            continue;
+        if (!sym->section || !(sym->section->flags & SEC_CODE))
+            continue;
+        // Mapping and local labels
+        if (sym->name[0] == '$' || !strncmp(sym->name, ".L", 2))
+            continue;
+
+        fn_symbol(arg, sym->name, (uint32_t)bfd_asymbol_value(sym));
+        count++;
+    }
+
+    free(symtab);
+    bfd_close(ibfd);
+    return count;
+}
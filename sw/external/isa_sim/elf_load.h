@@ -8,11 +8,13 @@
 //-------------------------------------------------------------
 typedef int (*cb_mem_create)(void *arg, uint32_t base, uint32_t size);
 typedef int (*cb_mem_load)(void *arg, uint32_t addr, uint8_t data);
+typedef void (*cb_symbol)(void *arg, const char *name, uint32_t addr);
 
 //-------------------------------------------------------------
 // Functions
 //-------------------------------------------------------------
 int  elf_load(const char *filename, cb_mem_create fn_create, cb_mem_load fn_load, void *arg, uint32_t *start_addr);
 long elf_get_symbol(const char *filename, const char *symname);
+int  elf_get_symbols(const char *filename, cb_symbol fn_symbol, void *arg);
 
 #endif
\ No newline at end of file
@@ -42,30 +42,140 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <vector>
+#include <string>
 
 #include "riscv_main.h"
 #include "riscv.h"
+#include "riscv_profiler.h"
 #include "cosim_api.h"
 
+//-----------------------------------------------------------------
+// create_profiler: Profiler for one hart, reports go to prefix.*
+//-----------------------------------------------------------------
+static RiscvProfiler *create_profiler(Riscv *sim, const char *elf, const char *prefix)
+{
+    RiscvProfiler *prof = new RiscvProfiler();
+
+    if (elf && prof->load_symbols(elf) <= 0)
+        fprintf(stderr, "Warning: No symbols found in %s\n", elf);
+
+    prof->set_output(prefix);
+    sim->set_stats_interface(prof);
+    return prof;
+}
+
 //-----------------------------------------------------------------
 // main
 //-----------------------------------------------------------------
 int main(int argc, char *argv[])
 {
     int exitcode;
+    int num_harts = 1;
+    uint32_t quantum = 1000;
+    bool deterministic = false;
+    const char *profile = NULL;
+    const char *filename = NULL;
+
+    // Multi-hart and profiler options, everything else goes to riscv_main
+    std::vector <char *> args;
+    for (int i=0;i<argc;i++)
+    {
+        if (!strcmp(argv[i], "-n") && (i + 1) < argc)
+            num_harts = (int)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-q") && (i + 1) < argc)
+            quantum = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-x"))
+            deterministic = true;
+        else if (!strcmp(argv[i], "-P") && (i + 1) < argc)
+            profile = argv[++i];
+        else
+        {
+            // Symbols for the profiler come from the executable
+            if (!strcmp(argv[i], "-f") && (i + 1) < argc)
+                filename = argv[i + 1];
+            args.push_back(argv[i]);
+        }
+    }
+    args.push_back(NULL);
+
+    if (num_harts <= 1)
+    {
+        Riscv * sim = new Riscv();
+        RiscvProfiler *prof = NULL;
+
+        // SIM_CTRL exit stops the run, stats and exit code are done here
+        sim->set_exit_on_ctrl(false);
+        cosim::instance()->attach_cpu("sim", sim);
+        cosim::instance()->attach_mem("sim", sim, 0, 0xFFFFFFFF);
+
+        if (profile)
+            prof = create_profiler(sim, filename, profile);
+
+        exitcode = riscv_main(sim, (int)args.size() - 1, &args[0]);
+
+        // Show execution stats
+        sim->stats_dump();
+
+        if (exitcode == 0 && sim->get_exited())
+            exitcode = sim->get_exit_code();
+
+        delete sim;
+        sim = NULL;
+        delete prof;
+
+        return exitcode;
+    }
+
+    cosim_harts *harts = new cosim_harts();
+    std::vector <Riscv *> sims;
+    std::vector <RiscvProfiler *> profs;
+
+    harts->set_quantum(quantum);
+    harts->set_deterministic(deterministic);
+
+    for (int h=0;h<num_harts;h++)
+    {
+        Riscv *sim = new Riscv();
+        char name[32];
+
+        sim->set_hartid(h);
+        // SIM_CTRL exit stops the hart, the run loop sees get_stopped()
+        // and the workers are shut down before anything is dumped
+        sim->set_exit_on_ctrl(false);
+        sprintf(name, "hart%d", h);
+        harts->attach_hart(name, sim, sim);
+        sims.push_back(sim);
+
+        if (profile)
+        {
+            std::string prefix = std::string(profile) + "." + name;
+            profs.push_back(create_profiler(sim, filename, prefix.c_str()));
+        }
+    }
+
+    cosim::instance()->attach_cpu("harts", harts);
+    cosim::instance()->attach_mem("harts", harts, 0, 0xFFFFFFFF);
 
-    Riscv * sim = new Riscv();
+    exitcode = riscv_main(harts, (int)args.size() - 1, &args[0]);
 
-    cosim::instance()->attach_cpu("sim", sim);
-    cosim::instance()->attach_mem("sim", sim, 0, 0xFFFFFFFF);
+    // Workers go before the harts they run
+    delete harts;
+    harts = NULL;
 
-    exitcode = riscv_main(sim, argc, argv);
+    for (int h=0;h<num_harts;h++)
+    {
+        printf("Hart %d:\n", h);
+        sims[h]->stats_dump();
 
-    // Show execution stats
-    sim->stats_dump();
+        // Exit code of the first hart which exited through SIM_CTRL
+        if (exitcode == 0 && sims[h]->get_exited())
+            exitcode = sims[h]->get_exit_code();
+        delete sims[h];
+    }
 
-    delete sim;
-    sim = NULL;
+    for (size_t p=0;p<profs.size();p++)
+        delete profs[p];
 
     return exitcode;
 }
@@ -42,6 +42,8 @@
 #define __MEMORY_H__
 
 #include <stdint.h>
+#include <string.h>
+#include <assert.h>
 
 //--------------------------------------------------------------------
 // Abstract interface for memories
@@ -52,6 +54,11 @@ public:
     virtual void        reset(void) = 0;
     virtual uint32_t    load(uint32_t address, int width, bool signedLoad) = 0;
     virtual void        store(uint32_t address, uint32_t data, int width) = 0;
+
+    // Host address of little endian backing storage for 'address', which
+    // may be accessed directly up to the end of the memory.
+    // NULL if all accesses must go through load/store.
+    virtual uint8_t *   host_ptr(uint32_t address) { return NULL; }
 };
 
 //-----------------------------------------------------------------
@@ -159,6 +166,15 @@ public:
         }
     }
 
+    virtual uint8_t *host_ptr(uint32_t address)
+    {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        return (uint8_t*)Mem + address;
+#else
+        return NULL;
+#endif
+    }
+
 private:
     uint32_t *Mem;
     int      Size;
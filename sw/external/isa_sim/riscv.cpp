@@ -44,6 +44,7 @@
 #include <stdarg.h>
 #include <assert.h>
 #include "riscv.h"
+#include "riscv_jit.h"
 
 //-----------------------------------------------------------------
 // Defines:
@@ -58,9 +59,18 @@
 Riscv::Riscv(uint32_t baseAddr /*= 0*/, uint32_t len /*= 0*/)
 {
     m_mem_regions        = 0;
+    m_mem_last           = 0;
+    m_hartid             = MHARTID_VALUE;
+    m_jit                = NULL;
     m_stats_if           = NULL;
     m_console            = NULL;
+    m_exit_on_ctrl       = true;
+    m_exited             = false;
+    m_exit_code          = 0;
     m_has_breakpoints    = false;
+    m_dcache_last        = NULL;
+    m_dcache_last_ppn    = 0;
+    m_dcache_code.assign(DCACHE_CODE_WORDS, 0);
 
     // Some memory defined
     if (len != 0)
@@ -75,6 +85,11 @@ Riscv::~Riscv()
 {
     int m;
 
+    delete m_jit;
+    m_jit = NULL;
+
+    flush_decode_cache();
+
     for (m=0;m<m_mem_regions;m++)
     {
         if (m_mem[m])
@@ -93,6 +108,8 @@ bool Riscv::error(bool terminal, const char *fmt, ...)
     vprintf(fmt, args);
     va_end(args);
 
+    // Profile up to the error is still written
+    stats_dump();
     exit(-1);
 
     return true;
@@ -120,6 +137,9 @@ bool Riscv::attach_memory(Memory *memory, uint32_t baseAddr, uint32_t len)
         m_mem[m_mem_regions] = memory;
         m_mem[m_mem_regions]->reset();
 
+        flush_decode_cache();
+        flush_tlb();
+
         m_mem_regions++;
 
         return true;
@@ -157,7 +177,7 @@ void Riscv::set_register(int r, uint32_t val)
     else if (r == (RISCV_REGNO_CSR0 + CSR_STVEC)) m_csr_sevec = val;
     else if (r == (RISCV_REGNO_CSR0 + CSR_SCAUSE)) m_csr_scause = val;
     else if (r == (RISCV_REGNO_CSR0 + CSR_STVAL)) m_csr_stval = val;
-    else if (r == (RISCV_REGNO_CSR0 + CSR_SATP)) m_csr_satp = val;
+    else if (r == (RISCV_REGNO_CSR0 + CSR_SATP)) { m_csr_satp = val; flush_tlb(); }
     else if (r == (RISCV_REGNO_CSR0 + CSR_SSCRATCH)) m_csr_sscratch = val;
     else if (r == RISCV_REGNO_PRIV) m_csr_mpriv = val;
     
@@ -269,31 +289,52 @@ void Riscv::reset(uint32_t start_addr)
     m_fault       = false;
     m_break       = false;
     m_trace       = 0;
+    m_exited      = false;
+    m_exit_code   = 0;
 
+    flush_decode_cache();
+    flush_tlb();
     stats_reset();
 }
 //-----------------------------------------------------------------
-// valid_addr: Check if the physical memory address is valid
+// mem_region: Find memory region of physical address (-1 if none)
 //-----------------------------------------------------------------
-bool Riscv::valid_addr(uint32_t address)
+int Riscv::mem_region(uint32_t address)
 {
-    for (int j=0;j<m_mem_regions;j++)
+    int j = m_mem_last;
+
+    // Accesses tend to hit the same region
+    if (j < m_mem_regions && address >= m_mem_base[j] && address < (m_mem_base[j] + m_mem_size[j]))
+        return j;
+
+    for (j=0;j<m_mem_regions;j++)
         if (address >= m_mem_base[j] && address < (m_mem_base[j] + m_mem_size[j]))
-            return true;
+        {
+            m_mem_last = j;
+            return j;
+        }
 
-    return false;
+    return -1;
+}
+//-----------------------------------------------------------------
+// valid_addr: Check if the physical memory address is valid
+//-----------------------------------------------------------------
+bool Riscv::valid_addr(uint32_t address)
+{
+    return mem_region(address) >= 0;
 }
 //-----------------------------------------------------------------
 // write: Write a byte to memory (physical address)
 //-----------------------------------------------------------------
 void Riscv::write(uint32_t address, uint8_t data)
 {
-    for (int j=0;j<m_mem_regions;j++)
-        if (address >= m_mem_base[j] && address < (m_mem_base[j] + m_mem_size[j]))
-        {
-            m_mem[j]->store(address - m_mem_base[j], data, 1);
-            return ;
-        }
+    int j = mem_region(address);
+    if (j >= 0)
+    {
+        m_mem[j]->store(address - m_mem_base[j], data, 1);
+        dcache_invalidate(address, 1);
+        return ;
+    }
 
     error(false, "Failed store @ 0x%08x\n", address);
 }
@@ -302,12 +343,13 @@ void Riscv::write(uint32_t address, uint8_t data)
 //-----------------------------------------------------------------
 void Riscv::write32(uint32_t address, uint32_t data)
 {
-    for (int j=0;j<m_mem_regions;j++)
-        if (address >= m_mem_base[j] && address < (m_mem_base[j] + m_mem_size[j]))
-        {
-            m_mem[j]->store(address - m_mem_base[j], data, 4);
-            return ;
-        }
+    int j = mem_region(address);
+    if (j >= 0)
+    {
+        m_mem[j]->store(address - m_mem_base[j], data, 4);
+        dcache_invalidate(address, 4);
+        return ;
+    }
 
     error(false, "Failed store @ 0x%08x\n", address);
 }
@@ -316,9 +358,9 @@ void Riscv::write32(uint32_t address, uint32_t data)
 //-----------------------------------------------------------------
 uint8_t Riscv::read(uint32_t address)
 {
-    for (int j=0;j<m_mem_regions;j++)
-        if (address >= m_mem_base[j] && address < (m_mem_base[j] + m_mem_size[j]))
-            return m_mem[j]->load(address - m_mem_base[j], 1, false);
+    int j = mem_region(address);
+    if (j >= 0)
+        return m_mem[j]->load(address - m_mem_base[j], 1, false);
 
     return 0;
 }
@@ -327,9 +369,9 @@ uint8_t Riscv::read(uint32_t address)
 //-----------------------------------------------------------------
 uint32_t Riscv::read32(uint32_t address)
 {
-    for (int j=0;j<m_mem_regions;j++)
-        if (address >= m_mem_base[j] && address < (m_mem_base[j] + m_mem_size[j]))
-            return m_mem[j]->load(address - m_mem_base[j], 4, false);
+    int j = mem_region(address);
+    if (j >= 0)
+        return m_mem[j]->load(address - m_mem_base[j], 4, false);
 
     return 0;
 }
@@ -346,15 +388,14 @@ uint32_t Riscv::get_opcode(uint32_t address)
 //-----------------------------------------------------------------
 int Riscv::mmu_read_word(uint32_t address, uint32_t *val)
 {
-    int m;
+    int m = mem_region(address);
     *val = 0;
 
-    for (m=0;m<m_mem_regions;m++)
-        if (address >= m_mem_base[m] && address < (m_mem_base[m] + m_mem_size[m]))
-        {
-            *val = m_mem[m]->load(address - m_mem_base[m], 4, false);
-            return 1;
-        }
+    if (m >= 0)
+    {
+        *val = m_mem[m]->load(address - m_mem_base[m], 4, false);
+        return 1;
+    }
 
     return 0;
 }
@@ -592,11 +633,22 @@ int Riscv::load(uint32_t pc, uint32_t address, uint32_t *result, int width, bool
 {
     uint32_t physical = address;
 
+    riscv_tlb_entry *tlb = tlb_lookup(m_dtlb, address, TLB_PERM_R);
+    if (tlb)
+    {
+        physical = tlb->ppage | (address & (TLB_PAGE_SIZE - 1));
+        m_dtlb_hits++;
+    }
+    else
+    {
 #ifdef CONFIG_MMU
-    // Translate addresses if required
-    if (!mmu_d_translate(pc, address, &physical, 0))
-        return 0;
+        // Translate addresses if required
+        if (!mmu_d_translate(pc, address, &physical, 0))
+            return 0;
 #endif
+        tlb = tlb_fill(m_dtlb, address, physical, TLB_PERM_R);
+        m_dtlb_misses++;
+    }
 
     DPRINTF(LOG_MEM, ("LOAD: VA 0x%08x PA 0x%08x Width %d\n", address, physical, width));
 
@@ -604,16 +656,41 @@ int Riscv::load(uint32_t pc, uint32_t address, uint32_t *result, int width, bool
 
     m_stats[STATS_LOADS]++;
 
-    for (int j=0;j<m_mem_regions;j++)
-        if (physical >= m_mem_base[j] && physical < (m_mem_base[j] + m_mem_size[j]))
-        {
-            *result = m_mem[j]->load(physical - m_mem_base[j], width, signedLoad);
+    // Aligned access to plain memory, read it directly
+    if (tlb->host && !(address & (width - 1)))
+    {
+        uint8_t *p = tlb->host + (address & (TLB_PAGE_SIZE - 1));
+        uint16_t half;
 
-            DPRINTF(LOG_MEM, ("LOAD_RESULT: 0x%08x\n",*result));
-            event_push(COSIM_EVENT_LOAD_RESULT, *result, 0);
-            return 1;
+        switch (width)
+        {
+            case 4:
+                memcpy(result, p, 4);
+            break;
+            case 2:
+                memcpy(&half, p, 2);
+                *result = signedLoad ? (uint32_t)(int16_t)half : half;
+            break;
+            default:
+                *result = signedLoad ? (uint32_t)(int8_t)*p : *p;
+            break;
         }
 
+        DPRINTF(LOG_MEM, ("LOAD_RESULT: 0x%08x\n",*result));
+        event_push(COSIM_EVENT_LOAD_RESULT, *result, 0);
+        return 1;
+    }
+
+    int j = mem_region(physical);
+    if (j >= 0)
+    {
+        *result = m_mem[j]->load(physical - m_mem_base[j], width, signedLoad);
+
+        DPRINTF(LOG_MEM, ("LOAD_RESULT: 0x%08x\n",*result));
+        event_push(COSIM_EVENT_LOAD_RESULT, *result, 0);
+        return 1;
+    }
+
     error(false, "%08x: Bad memory access 0x%x\n", pc, address);
     return 0;
 }
@@ -624,11 +701,22 @@ int Riscv::store(uint32_t pc, uint32_t address, uint32_t data, int width)
 {
     uint32_t physical = address;
 
+    riscv_tlb_entry *tlb = tlb_lookup(m_dtlb, address, TLB_PERM_W);
+    if (tlb)
+    {
+        physical = tlb->ppage | (address & (TLB_PAGE_SIZE - 1));
+        m_dtlb_hits++;
+    }
+    else
+    {
 #ifdef CONFIG_MMU
-    // Translate addresses if required
-    if (!mmu_d_translate(pc, address, &physical, 1))
-        return 0;
+        // Translate addresses if required
+        if (!mmu_d_translate(pc, address, &physical, 1))
+            return 0;
 #endif
+        tlb = tlb_fill(m_dtlb, address, physical, TLB_PERM_W);
+        m_dtlb_misses++;
+    }
 
     DPRINTF(LOG_MEM, ("STORE: VA 0x%08x PA 0x%08x Value 0x%08x Width %d\n", address, physical, data, width));
 
@@ -641,13 +729,38 @@ int Riscv::store(uint32_t pc, uint32_t address, uint32_t data, int width)
     else
         event_push(COSIM_EVENT_STORE, physical, data);
 
-    for (int j=0;j<m_mem_regions;j++)
-        if (physical >= m_mem_base[j] && physical < (m_mem_base[j] + m_mem_size[j]))
+    // Aligned access to plain memory, write it directly
+    if (tlb->host && !(address & (width - 1)))
+    {
+        uint8_t *p = tlb->host + (address & (TLB_PAGE_SIZE - 1));
+        uint16_t half = data;
+        uint8_t  byte = data;
+
+        switch (width)
         {
-            m_mem[j]->store(physical - m_mem_base[j], data, width);
-            return 1;
+            case 4:
+                memcpy(p, &data, 4);
+            break;
+            case 2:
+                memcpy(p, &half, 2);
+            break;
+            default:
+                *p = byte;
+            break;
         }
 
+        dcache_invalidate(physical, width);
+        return 1;
+    }
+
+    int j = mem_region(physical);
+    if (j >= 0)
+    {
+        m_mem[j]->store(physical - m_mem_base[j], data, width);
+        dcache_invalidate(physical, width);
+        return 1;
+    }
+
     error(false, "%08x: Bad memory access 0x%x\n", pc, address);
     return 0;
 }
@@ -690,8 +803,15 @@ uint32_t Riscv::access_csr(uint32_t address, uint32_t data, bool set, bool clr)
             switch (data & 0xFF000000)
             {
                 case CSR_SIM_CTRL_EXIT:
-                    stats_dump();
-                    exit(data & 0xFF);
+                    // Otherwise the owner dumps stats once it sees get_stopped()
+                    if (m_exit_on_ctrl)
+                    {
+                        stats_dump();
+                        exit(data & 0xFF);
+                    }
+                    m_exited    = true;
+                    m_exit_code = data & 0xFF;
+                    m_break     = true;
                     break;
                 case CSR_SIM_CTRL_PUTC:
                     if (m_console)
@@ -754,7 +874,7 @@ uint32_t Riscv::access_csr(uint32_t address, uint32_t data, bool set, bool clr)
         CSR_STD(MIDELEG, m_csr_mideleg)
         CSR_STD(MEDELEG, m_csr_medeleg)
         CSR_STD(MSCRATCH,m_csr_mscratch)
-        CSR_CONST(MHARTID,  MHARTID_VALUE)
+        CSR_CONST(MHARTID,  m_hartid)
         //--------------------------------------------------------
         // Standard - Supervisor
         //--------------------------------------------------------
@@ -795,6 +915,11 @@ uint32_t Riscv::access_csr(uint32_t address, uint32_t data, bool set, bool clr)
             error(false, "*** CSR address not supported %08x [PC=%08x]\n", address, m_pc);
             break;
     }
+
+    // New translation root
+    if ((address & 0xFFF) == CSR_SATP && (set || clr))
+        flush_tlb();
+
     return result;
 }
 //-----------------------------------------------------------------
@@ -869,6 +994,135 @@ void Riscv::exception(uint32_t cause, uint32_t pc, uint32_t badaddr /*= 0*/)
     }
 }
 //-----------------------------------------------------------------
+// decode: Decode instruction once into handler id and operands
+//-----------------------------------------------------------------
+void Riscv::decode(uint32_t opcode, riscv_decoded *inst)
+{
+    // As RVC is not supported, 16-bit encodings (and all zeros) are illegal
+    riscv_decode(opcode, inst);
+}
+//-----------------------------------------------------------------
+// dcache_lookup: Get decoded instruction at physical address
+//-----------------------------------------------------------------
+riscv_decoded *Riscv::dcache_lookup(uint32_t phy_pc)
+{
+    // Misaligned fetch would alias an aligned slot, don't cache it
+    if (phy_pc & 3)
+    {
+        decode(get_opcode(phy_pc), &m_dcache_tmp);
+        m_dcache_misses++;
+        return &m_dcache_tmp;
+    }
+
+    uint32_t ppn = phy_pc >> DCACHE_PAGE_SHIFT;
+    riscv_dcache_page *page = m_dcache_last;
+
+    // Sequential code mostly stays within the last page
+    if (!page || ppn != m_dcache_last_ppn)
+    {
+        std::unordered_map<uint32_t, riscv_dcache_page *>::iterator it = m_dcache.find(ppn);
+        if (it != m_dcache.end())
+            page = it->second;
+        else
+        {
+            page = new riscv_dcache_page;
+            for (int i=0;i<DCACHE_PAGE_ENTRIES;i++)
+                page->inst[i].id = DECODE_INVALID;
+            m_dcache[ppn] = page;
+            m_dcache_code[ppn >> 6] |= 1ULL << (ppn & 63);
+        }
+
+        m_dcache_last     = page;
+        m_dcache_last_ppn = ppn;
+    }
+
+    riscv_decoded *inst = &page->inst[(phy_pc >> 2) & (DCACHE_PAGE_ENTRIES - 1)];
+    if (inst->id == DECODE_INVALID)
+    {
+        decode(get_opcode(phy_pc), inst);
+        m_dcache_misses++;
+    }
+    else
+        m_dcache_hits++;
+
+    return inst;
+}
+//-----------------------------------------------------------------
+// dcache_invalidate: Drop decoded instructions overlapping a write
+//-----------------------------------------------------------------
+void Riscv::dcache_invalidate(uint32_t address, int width)
+{
+    uint32_t first = address >> 2;
+    uint32_t last  = (address + width - 1) >> 2;
+
+    for (uint32_t w=first;w<=last;w++)
+    {
+        uint32_t ppn = w >> (DCACHE_PAGE_SHIFT - 2);
+        if (!(m_dcache_code[ppn >> 6] & (1ULL << (ppn & 63))))
+            continue;
+
+        m_dcache[ppn]->inst[w & (DCACHE_PAGE_ENTRIES - 1)].id = DECODE_INVALID;
+
+        if (m_jit)
+            m_jit->invalidate(w << 2);
+    }
+}
+//-----------------------------------------------------------------
+// flush_decode_cache: Drop all decoded instructions
+//-----------------------------------------------------------------
+void Riscv::flush_decode_cache(void)
+{
+    for (std::unordered_map<uint32_t, riscv_dcache_page *>::iterator it = m_dcache.begin(); it != m_dcache.end(); ++it)
+        delete it->second;
+
+    m_dcache.clear();
+    m_dcache_code.assign(DCACHE_CODE_WORDS, 0);
+    m_dcache_last     = NULL;
+    m_dcache_last_ppn = 0;
+
+    if (m_jit)
+        m_jit->flush();
+}
+//-----------------------------------------------------------------
+// tlb_fill: Record successful translation of address
+//-----------------------------------------------------------------
+riscv_tlb_entry *Riscv::tlb_fill(riscv_tlb_entry *tlb, uint32_t address, uint32_t physical, int perm)
+{
+    uint32_t vpn   = address >> TLB_PAGE_SHIFT;
+    uint32_t ppage = physical & ~(TLB_PAGE_SIZE - 1);
+    uint8_t  ctx   = tlb_ctx();
+    riscv_tlb_entry *entry = &tlb[vpn & (TLB_ENTRIES - 1)];
+
+    // Same translation, just checked for another access type
+    if (entry->perm && entry->vpn == vpn && entry->ctx == ctx && entry->ppage == ppage)
+    {
+        entry->perm |= perm;
+        return entry;
+    }
+
+    entry->vpn   = vpn;
+    entry->ppage = ppage;
+    entry->ctx   = ctx;
+    entry->perm  = perm;
+    entry->host  = NULL;
+
+    // Direct access only if the whole page is backed by one memory
+    int j = mem_region(ppage);
+    if (j >= 0 && (uint64_t)(ppage - m_mem_base[j]) + TLB_PAGE_SIZE <= m_mem_size[j])
+        entry->host = m_mem[j]->host_ptr(ppage - m_mem_base[j]);
+
+    return entry;
+}
+//-----------------------------------------------------------------
+// flush_tlb: Drop all cached translations
+//-----------------------------------------------------------------
+void Riscv::flush_tlb(void)
+{
+    memset(m_itlb, 0, sizeof(m_itlb));
+    memset(m_dtlb, 0, sizeof(m_dtlb));
+    m_mem_last = 0;
+}
+//-----------------------------------------------------------------
 // execute: Instruction execution stage
 //-----------------------------------------------------------------
 void Riscv::execute(void)
@@ -877,28 +1131,32 @@ void Riscv::execute(void)
 
 #ifdef CONFIG_MMU
     // Translate PC to physical address
-    if (!mmu_i_translate(m_pc, &phy_pc))
-        return ;
+    riscv_tlb_entry *tlb = tlb_lookup(m_itlb, m_pc, TLB_PERM_X);
+    if (tlb)
+    {
+        phy_pc = tlb->ppage | (m_pc & (TLB_PAGE_SIZE - 1));
+        m_itlb_hits++;
+    }
+    else
+    {
+        if (!mmu_i_translate(m_pc, &phy_pc))
+            return ;
+
+        tlb_fill(m_itlb, m_pc, phy_pc, TLB_PERM_X);
+        m_itlb_misses++;
+    }
 #endif
 
-    // Get opcode at current PC
-    uint32_t opcode = get_opcode(phy_pc);
+    // Get decoded instruction at current PC
+    riscv_decoded *inst = dcache_lookup(phy_pc);
+    uint32_t opcode = inst->opcode;
     m_pc_x = m_pc;
 
-    // Extract registers
-    int rd          = (opcode & OPCODE_RD_MASK)  >> OPCODE_RD_SHIFT;
-    int rs1         = (opcode & OPCODE_RS1_MASK) >> OPCODE_RS1_SHIFT;
-    int rs2         = (opcode & OPCODE_RS2_MASK) >> OPCODE_RS2_SHIFT;
-
-    // Extract immediates
-    int typei_imm   = ((signed)(opcode & OPCODE_TYPEI_IMM_MASK)) >> OPCODE_TYPEI_IMM_SHIFT;
-    int typeu_imm   = ((signed)(opcode & OPCODE_TYPEU_IMM_MASK)) >> OPCODE_TYPEU_IMM_SHIFT;
-    int imm20       = typeu_imm << OPCODE_TYPEU_IMM_SHIFT;
-    int imm12       = typei_imm;
-    int bimm        = OPCODE_SBTYPE_IMM(opcode);
-    int jimm20      = OPCODE_UJTYPE_IMM(opcode);
-    int storeimm    = OPCODE_STYPE_IMM(opcode);
-    int shamt       = ((signed)(opcode & OPCODE_SHAMT_MASK)) >> OPCODE_SHAMT_SHIFT;
+    // Registers and immediate extracted by decode
+    int rd          = inst->rd;
+    int rs1         = inst->rs1;
+    int rs2         = inst->rs2;
+    int imm         = inst->imm;
 
     // Retrieve registers
     uint32_t reg_rd  = 0;
@@ -911,359 +1169,486 @@ void Riscv::execute(void)
     DPRINTF(LOG_OPCODES,( "%08x: %08x\n", pc, opcode));
     DPRINTF(LOG_OPCODES,( "        rd(%d) r%d = %d, r%d = %d\n", rd, rs1, reg_rs1, rs2, reg_rs2));
 
-    // As RVC is not supported, fault on opcode which is all zeros
-    if (opcode == 0)
-    {
-        error(false, "Bad instruction @ %x\n", pc);
-
-        exception(MCAUSE_ILLEGAL_INSTRUCTION, pc);
-        m_fault = true;
-        take_exception = true;        
-    }
-    else if ((opcode & INST_ANDI_MASK) == INST_ANDI)
+    // Handlers indexed by eInstructions, ENUM_INST_MAX is illegal
+    static void *dispatch[ENUM_INST_MAX + 1] =
+    {
+        &&inst_andi,
+        &&inst_addi,
+        &&inst_slti,
+        &&inst_sltiu,
+        &&inst_ori,
+        &&inst_xori,
+        &&inst_slli,
+        &&inst_srli,
+        &&inst_srai,
+        &&inst_lui,
+        &&inst_auipc,
+        &&inst_add,
+        &&inst_sub,
+        &&inst_slt,
+        &&inst_sltu,
+        &&inst_xor,
+        &&inst_or,
+        &&inst_and,
+        &&inst_sll,
+        &&inst_srl,
+        &&inst_sra,
+        &&inst_jal,
+        &&inst_jalr,
+        &&inst_beq,
+        &&inst_bne,
+        &&inst_blt,
+        &&inst_bge,
+        &&inst_bltu,
+        &&inst_bgeu,
+        &&inst_lb,
+        &&inst_lh,
+        &&inst_lw,
+        &&inst_lbu,
+        &&inst_lhu,
+        &&inst_lwu,
+        &&inst_sb,
+        &&inst_sh,
+        &&inst_sw,
+        &&inst_ecall,
+        &&inst_ebreak,
+        &&inst_mret,
+        &&inst_sret,
+        &&inst_csrrw,
+        &&inst_csrrs,
+        &&inst_csrrc,
+        &&inst_csrrwi,
+        &&inst_csrrsi,
+        &&inst_csrrci,
+        &&inst_mul,
+        &&inst_mulh,
+        &&inst_mulhsu,
+        &&inst_mulhu,
+        &&inst_div,
+        &&inst_divu,
+        &&inst_rem,
+        &&inst_remu,
+        &&inst_fence,
+        &&inst_wfi,
+        &&inst_illegal
+    };
+
+    goto *dispatch[inst->id];
+
+inst_andi:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: andi r%d, r%d, %d\n", pc, rd, rs1, imm12));
+        DPRINTF(LOG_INST,("%08x: andi r%d, r%d, %d\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_ANDI);
-        reg_rd = reg_rs1 & imm12;
-        pc += 4;        
+        reg_rd = reg_rs1 & imm;
+        pc += 4;
     }
-    else if ((opcode & INST_ORI_MASK) == INST_ORI)
+    goto exec_done;
+
+inst_addi:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: ori r%d, r%d, %d\n", pc, rd, rs1, imm12));
-        INST_STAT(ENUM_INST_ORI);
-        reg_rd = reg_rs1 | imm12;
-        pc += 4;        
+        DPRINTF(LOG_INST,("%08x: addi r%d, r%d, %d\n", pc, rd, rs1, imm));
+        INST_STAT(ENUM_INST_ADDI);
+        reg_rd = reg_rs1 + imm;
+        pc += 4;
     }
-    else if ((opcode & INST_XORI_MASK) == INST_XORI)
+    goto exec_done;
+
+inst_slti:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: xori r%d, r%d, %d\n", pc, rd, rs1, imm12));
-        INST_STAT(ENUM_INST_XORI);
-        reg_rd = reg_rs1 ^ imm12;
-        pc += 4;        
+        DPRINTF(LOG_INST,("%08x: slti r%d, r%d, %d\n", pc, rd, rs1, imm));
+        INST_STAT(ENUM_INST_SLTI);
+        reg_rd = (signed)reg_rs1 < (signed)imm;
+        pc += 4;
     }
-    else if ((opcode & INST_ADDI_MASK) == INST_ADDI)
+    goto exec_done;
+
+inst_sltiu:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: addi r%d, r%d, %d\n", pc, rd, rs1, imm12));
-        INST_STAT(ENUM_INST_ADDI);
-        reg_rd = reg_rs1 + imm12;
+        DPRINTF(LOG_INST,("%08x: sltiu r%d, r%d, %d\n", pc, rd, rs1, (unsigned)imm));
+        INST_STAT(ENUM_INST_SLTIU);
+        reg_rd = (unsigned)reg_rs1 < (unsigned)imm;
         pc += 4;
     }
-    else if ((opcode & INST_SLTI_MASK) == INST_SLTI)
+    goto exec_done;
+
+inst_ori:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: slti r%d, r%d, %d\n", pc, rd, rs1, imm12));
-        INST_STAT(ENUM_INST_SLTI);
-        reg_rd = (signed)reg_rs1 < (signed)imm12;
-        pc += 4;        
+        DPRINTF(LOG_INST,("%08x: ori r%d, r%d, %d\n", pc, rd, rs1, imm));
+        INST_STAT(ENUM_INST_ORI);
+        reg_rd = reg_rs1 | imm;
+        pc += 4;
     }
-    else if ((opcode & INST_SLTIU_MASK) == INST_SLTIU)
+    goto exec_done;
+
+inst_xori:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: sltiu r%d, r%d, %d\n", pc, rd, rs1, (unsigned)imm12));
-        INST_STAT(ENUM_INST_SLTIU);
-        reg_rd = (unsigned)reg_rs1 < (unsigned)imm12;
-        pc += 4;        
+        DPRINTF(LOG_INST,("%08x: xori r%d, r%d, %d\n", pc, rd, rs1, imm));
+        INST_STAT(ENUM_INST_XORI);
+        reg_rd = reg_rs1 ^ imm;
+        pc += 4;
     }
-    else if ((opcode & INST_SLLI_MASK) == INST_SLLI)
+    goto exec_done;
+
+inst_slli:
     {
         // ['rd', 'rs1']
-        DPRINTF(LOG_INST,("%08x: slli r%d, r%d, %d\n", pc, rd, rs1, shamt));
+        DPRINTF(LOG_INST,("%08x: slli r%d, r%d, %d\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_SLLI);
-        reg_rd = reg_rs1 << shamt;
-        pc += 4;        
+        reg_rd = reg_rs1 << imm;
+        pc += 4;
     }
-    else if ((opcode & INST_SRLI_MASK) == INST_SRLI)
+    goto exec_done;
+
+inst_srli:
     {
         // ['rd', 'rs1', 'shamt']
-        DPRINTF(LOG_INST,("%08x: srli r%d, r%d, %d\n", pc, rd, rs1, shamt));
+        DPRINTF(LOG_INST,("%08x: srli r%d, r%d, %d\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_SRLI);
-        reg_rd = (unsigned)reg_rs1 >> shamt;
-        pc += 4;        
+        reg_rd = (unsigned)reg_rs1 >> imm;
+        pc += 4;
     }
-    else if ((opcode & INST_SRAI_MASK) == INST_SRAI)
+    goto exec_done;
+
+inst_srai:
     {
         // ['rd', 'rs1', 'shamt']
-        DPRINTF(LOG_INST,("%08x: srai r%d, r%d, %d\n", pc, rd, rs1, shamt));
+        DPRINTF(LOG_INST,("%08x: srai r%d, r%d, %d\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_SRAI);
-        reg_rd = (signed)reg_rs1 >> shamt;
-        pc += 4;        
+        reg_rd = (signed)reg_rs1 >> imm;
+        pc += 4;
     }
-    else if ((opcode & INST_LUI_MASK) == INST_LUI)
+    goto exec_done;
+
+inst_lui:
     {
         // ['rd', 'imm20']
-        DPRINTF(LOG_INST,("%08x: lui r%d, 0x%x\n", pc, rd, imm20));
+        DPRINTF(LOG_INST,("%08x: lui r%d, 0x%x\n", pc, rd, imm));
         INST_STAT(ENUM_INST_LUI);
-        reg_rd = imm20;
-        pc += 4;        
+        reg_rd = imm;
+        pc += 4;
     }
-    else if ((opcode & INST_AUIPC_MASK) == INST_AUIPC)
+    goto exec_done;
+
+inst_auipc:
     {
         // ['rd', 'imm20']
-        DPRINTF(LOG_INST,("%08x: auipc r%d, 0x%x\n", pc, rd, imm20));
+        DPRINTF(LOG_INST,("%08x: auipc r%d, 0x%x\n", pc, rd, imm));
         INST_STAT(ENUM_INST_AUIPC);
-        reg_rd = imm20 + pc;
-        pc += 4;        
+        reg_rd = imm + pc;
+        pc += 4;
     }
-    else if ((opcode & INST_ADD_MASK) == INST_ADD)
+    goto exec_done;
+
+inst_add:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: add r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_ADD);
         reg_rd = reg_rs1 + reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_SUB_MASK) == INST_SUB)
+    goto exec_done;
+
+inst_sub:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: sub r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_SUB);
         reg_rd = reg_rs1 - reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_SLT_MASK) == INST_SLT)
+    goto exec_done;
+
+inst_slt:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: slt r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_SLT);
         reg_rd = (signed)reg_rs1 < (signed)reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_SLTU_MASK) == INST_SLTU)
+    goto exec_done;
+
+inst_sltu:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: sltu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_SLTU);
         reg_rd = (unsigned)reg_rs1 < (unsigned)reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_XOR_MASK) == INST_XOR)
+    goto exec_done;
+
+inst_xor:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: xor r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_XOR);
         reg_rd = reg_rs1 ^ reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_OR_MASK) == INST_OR)
+    goto exec_done;
+
+inst_or:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: or r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_OR);
         reg_rd = reg_rs1 | reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_AND_MASK) == INST_AND)
+    goto exec_done;
+
+inst_and:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: and r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_AND);
         reg_rd = reg_rs1 & reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_SLL_MASK) == INST_SLL)
+    goto exec_done;
+
+inst_sll:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: sll r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_SLL);
         reg_rd = reg_rs1 << reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_SRL_MASK) == INST_SRL)
+    goto exec_done;
+
+inst_srl:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: srl r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_SRL);
         reg_rd = (unsigned)reg_rs1 >> reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_SRA_MASK) == INST_SRA)
+    goto exec_done;
+
+inst_sra:
     {
         // ['rd', 'rs1', 'rs2']
         DPRINTF(LOG_INST,("%08x: sra r%d, r%d, r%d\n", pc, rd, rs1, rs2));
         INST_STAT(ENUM_INST_SRA);
         reg_rd = (signed)reg_rs1 >> reg_rs2;
-        pc += 4;        
+        pc += 4;
     }
-    else if ((opcode & INST_JAL_MASK) == INST_JAL)
+    goto exec_done;
+
+inst_jal:
     {
         // ['rd', 'jimm20']
-        DPRINTF(LOG_INST,("%08x: jal r%d, %d\n", pc, rd, jimm20));
+        DPRINTF(LOG_INST,("%08x: jal r%d, %d\n", pc, rd, imm));
         INST_STAT(ENUM_INST_JAL);
         reg_rd = pc + 4;
-        pc+= jimm20;
+        pc+= imm;
 
-        m_stats[STATS_BRANCHES]++;        
+        m_stats[STATS_BRANCHES]++;
     }
-    else if ((opcode & INST_JALR_MASK) == INST_JALR)
+    goto exec_done;
+
+inst_jalr:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: jalr r%d, r%d\n", pc, rs1, imm12));
+        DPRINTF(LOG_INST,("%08x: jalr r%d, r%d\n", pc, rs1, imm));
         INST_STAT(ENUM_INST_JALR);
         reg_rd = pc + 4;
-        pc = (reg_rs1 + imm12) & ~1;
+        pc = (reg_rs1 + imm) & ~1;
 
-        m_stats[STATS_BRANCHES]++;        
+        m_stats[STATS_BRANCHES]++;
     }
-    else if ((opcode & INST_BEQ_MASK) == INST_BEQ)
+    goto exec_done;
+
+inst_beq:
     {
         // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        DPRINTF(LOG_INST,("%08x: beq r%d, r%d, %d\n", pc, rs1, rs2, bimm));
+        DPRINTF(LOG_INST,("%08x: beq r%d, r%d, %d\n", pc, rs1, rs2, imm));
         INST_STAT(ENUM_INST_BEQ);
         if (reg_rs1 == reg_rs2)
-            pc += bimm;
+            pc += imm;
         else
             pc += 4;
 
         // No writeback
         rd = 0;
 
-        m_stats[STATS_BRANCHES]++;        
+        m_stats[STATS_BRANCHES]++;
     }
-    else if ((opcode & INST_BNE_MASK) == INST_BNE)
+    goto exec_done;
+
+inst_bne:
     {
         // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        DPRINTF(LOG_INST,("%08x: bne r%d, r%d, %d\n", pc, rs1, rs2, bimm));
+        DPRINTF(LOG_INST,("%08x: bne r%d, r%d, %d\n", pc, rs1, rs2, imm));
         INST_STAT(ENUM_INST_BNE);
         if (reg_rs1 != reg_rs2)
-            pc += bimm;
+            pc += imm;
         else
             pc += 4;
 
         // No writeback
         rd = 0;
 
-        m_stats[STATS_BRANCHES]++;        
+        m_stats[STATS_BRANCHES]++;
     }
-    else if ((opcode & INST_BLT_MASK) == INST_BLT)
+    goto exec_done;
+
+inst_blt:
     {
         // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        DPRINTF(LOG_INST,("%08x: blt r%d, r%d, %d\n", pc, rs1, rs2, bimm));
+        DPRINTF(LOG_INST,("%08x: blt r%d, r%d, %d\n", pc, rs1, rs2, imm));
         INST_STAT(ENUM_INST_BLT);
         if ((signed)reg_rs1 < (signed)reg_rs2)
-            pc += bimm;
+            pc += imm;
         else
             pc += 4;
 
         // No writeback
         rd = 0;
 
-        m_stats[STATS_BRANCHES]++;        
+        m_stats[STATS_BRANCHES]++;
     }
-    else if ((opcode & INST_BGE_MASK) == INST_BGE)
+    goto exec_done;
+
+inst_bge:
     {
         // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        DPRINTF(LOG_INST,("%08x: bge r%d, r%d, %d\n", pc, rs1, rs2, bimm));
+        DPRINTF(LOG_INST,("%08x: bge r%d, r%d, %d\n", pc, rs1, rs2, imm));
         INST_STAT(ENUM_INST_BGE);
         if ((signed)reg_rs1 >= (signed)reg_rs2)
-            pc += bimm;
+            pc += imm;
         else
             pc += 4;
 
         // No writeback
         rd = 0;
 
-        m_stats[STATS_BRANCHES]++;        
+        m_stats[STATS_BRANCHES]++;
     }
-    else if ((opcode & INST_BLTU_MASK) == INST_BLTU)
+    goto exec_done;
+
+inst_bltu:
     {
         // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        DPRINTF(LOG_INST,("%08x: bltu r%d, r%d, %d\n", pc, rs1, rs2, bimm));
+        DPRINTF(LOG_INST,("%08x: bltu r%d, r%d, %d\n", pc, rs1, rs2, imm));
         INST_STAT(ENUM_INST_BLTU);
         if ((unsigned)reg_rs1 < (unsigned)reg_rs2)
-            pc += bimm;
+            pc += imm;
         else
             pc += 4;
 
         // No writeback
         rd = 0;
 
-        m_stats[STATS_BRANCHES]++;        
+        m_stats[STATS_BRANCHES]++;
     }
-    else if ((opcode & INST_BGEU_MASK) == INST_BGEU)
+    goto exec_done;
+
+inst_bgeu:
     {
         // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        DPRINTF(LOG_INST,("%08x: bgeu r%d, r%d, %d\n", pc, rs1, rs2, bimm));
+        DPRINTF(LOG_INST,("%08x: bgeu r%d, r%d, %d\n", pc, rs1, rs2, imm));
         INST_STAT(ENUM_INST_BGEU);
         if ((unsigned)reg_rs1 >= (unsigned)reg_rs2)
-            pc += bimm;
+            pc += imm;
         else
             pc += 4;
 
         // No writeback
         rd = 0;
 
-        m_stats[STATS_BRANCHES]++;        
+        m_stats[STATS_BRANCHES]++;
     }
-    else if ((opcode & INST_LB_MASK) == INST_LB)
+    goto exec_done;
+
+inst_lb:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: lb r%d, %d(r%d)\n", pc, rd, imm12, rs1));
+        DPRINTF(LOG_INST,("%08x: lb r%d, %d(r%d)\n", pc, rd, imm, rs1));
         INST_STAT(ENUM_INST_LB);
-        if (load(pc, reg_rs1 + imm12, &reg_rd, 1, true))
+        if (load(pc, reg_rs1 + imm, &reg_rd, 1, true))
             pc += 4;
         else
             return;
     }
-    else if ((opcode & INST_LH_MASK) == INST_LH)
+    goto exec_done;
+
+inst_lh:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: lh r%d, %d(r%d)\n", pc, rd, imm12, rs1));
+        DPRINTF(LOG_INST,("%08x: lh r%d, %d(r%d)\n", pc, rd, imm, rs1));
         INST_STAT(ENUM_INST_LH);
-        if (load(pc, reg_rs1 + imm12, &reg_rd, 2, true))
+        if (load(pc, reg_rs1 + imm, &reg_rd, 2, true))
             pc += 4;
         else
             return;
     }
-    else if ((opcode & INST_LW_MASK) == INST_LW)
+    goto exec_done;
+
+inst_lw:
     {
-        // ['rd', 'rs1', 'imm12']        
+        // ['rd', 'rs1', 'imm12']
         INST_STAT(ENUM_INST_LW);
-        DPRINTF(LOG_INST,("%08x: lw r%d, %d(r%d)\n", pc, rd, imm12, rs1));
-        if (load(pc, reg_rs1 + imm12, &reg_rd, 4, true))
+        DPRINTF(LOG_INST,("%08x: lw r%d, %d(r%d)\n", pc, rd, imm, rs1));
+        if (load(pc, reg_rs1 + imm, &reg_rd, 4, true))
             pc += 4;
         else
             return;
     }
-    else if ((opcode & INST_LBU_MASK) == INST_LBU)
+    goto exec_done;
+
+inst_lbu:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: lbu r%d, %d(r%d)\n", pc, rd, imm12, rs1));
+        DPRINTF(LOG_INST,("%08x: lbu r%d, %d(r%d)\n", pc, rd, imm, rs1));
         INST_STAT(ENUM_INST_LBU);
-        if (load(pc, reg_rs1 + imm12, &reg_rd, 1, false))
+        if (load(pc, reg_rs1 + imm, &reg_rd, 1, false))
             pc += 4;
         else
             return;
     }
-    else if ((opcode & INST_LHU_MASK) == INST_LHU)
+    goto exec_done;
+
+inst_lhu:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: lhu r%d, %d(r%d)\n", pc, rd, imm12, rs1));
+        DPRINTF(LOG_INST,("%08x: lhu r%d, %d(r%d)\n", pc, rd, imm, rs1));
         INST_STAT(ENUM_INST_LHU);
-        if (load(pc, reg_rs1 + imm12, &reg_rd, 2, false))
+        if (load(pc, reg_rs1 + imm, &reg_rd, 2, false))
             pc += 4;
         else
             return;
     }
-    else if ((opcode & INST_LWU_MASK) == INST_LWU)
+    goto exec_done;
+
+inst_lwu:
     {
         // ['rd', 'rs1', 'imm12']
-        DPRINTF(LOG_INST,("%08x: lwu r%d, %d(r%d)\n", pc, rd, imm12, rs1));
+        DPRINTF(LOG_INST,("%08x: lwu r%d, %d(r%d)\n", pc, rd, imm, rs1));
         INST_STAT(ENUM_INST_LWU);
-        if (load(pc, reg_rs1 + imm12, &reg_rd, 4, false))
+        if (load(pc, reg_rs1 + imm, &reg_rd, 4, false))
             pc += 4;
         else
             return;
     }
-    else if ((opcode & INST_SB_MASK) == INST_SB)
+    goto exec_done;
+
+inst_sb:
     {
         // ['imm12hi', 'rs1', 'rs2', 'imm12lo']
-        DPRINTF(LOG_INST,("%08x: sb %d(r%d), r%d\n", pc, storeimm, rs1, rs2));
+        DPRINTF(LOG_INST,("%08x: sb %d(r%d), r%d\n", pc, imm, rs1, rs2));
         INST_STAT(ENUM_INST_SB);
-        if (store(pc, reg_rs1 + storeimm, reg_rs2, 1))
+        if (store(pc, reg_rs1 + imm, reg_rs2, 1))
             pc += 4;
         else
             return ;
@@ -1271,12 +1656,14 @@ void Riscv::execute(void)
         // No writeback
         rd = 0;
     }
-    else if ((opcode & INST_SH_MASK) == INST_SH)
+    goto exec_done;
+
+inst_sh:
     {
         // ['imm12hi', 'rs1', 'rs2', 'imm12lo']
-        DPRINTF(LOG_INST,("%08x: sh %d(r%d), r%d\n", pc, storeimm, rs1, rs2));
+        DPRINTF(LOG_INST,("%08x: sh %d(r%d), r%d\n", pc, imm, rs1, rs2));
         INST_STAT(ENUM_INST_SH);
-        if (store(pc, reg_rs1 + storeimm, reg_rs2, 2))
+        if (store(pc, reg_rs1 + imm, reg_rs2, 2))
             pc += 4;
         else
             return ;
@@ -1284,12 +1671,14 @@ void Riscv::execute(void)
         // No writeback
         rd = 0;
     }
-    else if ((opcode & INST_SW_MASK) == INST_SW)
+    goto exec_done;
+
+inst_sw:
     {
         // ['imm12hi', 'rs1', 'rs2', 'imm12lo']
-        DPRINTF(LOG_INST,("%08x: sw %d(r%d), r%d\n", pc, storeimm, rs1, rs2));
+        DPRINTF(LOG_INST,("%08x: sw %d(r%d), r%d\n", pc, imm, rs1, rs2));
         INST_STAT(ENUM_INST_SW);
-        if (store(pc, reg_rs1 + storeimm, reg_rs2, 4))
+        if (store(pc, reg_rs1 + imm, reg_rs2, 4))
             pc += 4;
         else
             return ;
@@ -1297,91 +1686,9 @@ void Riscv::execute(void)
         // No writeback
         rd = 0;
     }
-    else if ((opcode & INST_MUL_MASK) == INST_MUL)
-    {
-        // ['rd', 'rs1', 'rs2']
-        DPRINTF(LOG_INST,("%08x: mul r%d, r%d, r%d\n", pc, rd, rs1, rs2));
-        INST_STAT(ENUM_INST_MUL);
-        reg_rd = (signed)reg_rs1 * (signed)reg_rs2;
-        pc += 4;        
-    }
-    else if ((opcode & INST_MULH_MASK) == INST_MULH)
-    {
-        // ['rd', 'rs1', 'rs2']
-        long long res = ((long long) (int)reg_rs1) * ((long long)(int)reg_rs2);
-        INST_STAT(ENUM_INST_MULH);
-        DPRINTF(LOG_INST,("%08x: mulh r%d, r%d, r%d\n", pc, rd, rs1, rs2));
-        reg_rd = (int)(res >> 32);
-        pc += 4;
-    }
-    else if ((opcode & INST_MULHSU_MASK) == INST_MULHSU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        long long res = ((long long) (int)reg_rs1) * ((unsigned long long)(unsigned)reg_rs2);
-        INST_STAT(ENUM_INST_MULHSU);
-        DPRINTF(LOG_INST,("%08x: mulhsu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
-        reg_rd = (int)(res >> 32);
-        pc += 4;
-    }
-    else if ((opcode & INST_MULHU_MASK) == INST_MULHU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        unsigned long long res = ((unsigned long long) (unsigned)reg_rs1) * ((unsigned long long)(unsigned)reg_rs2);
-        INST_STAT(ENUM_INST_MULHU);
-        DPRINTF(LOG_INST,("%08x: mulhu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
-        reg_rd = (int)(res >> 32);
-        pc += 4;
-    }
-    else if ((opcode & INST_DIV_MASK) == INST_DIV)
-    {
-        // ['rd', 'rs1', 'rs2']
-        DPRINTF(LOG_INST,("%08x: div r%d, r%d, r%d\n", pc, rd, rs1, rs2));
-        INST_STAT(ENUM_INST_DIV);
-        if ((signed)reg_rs1 == INT32_MIN && (signed)reg_rs2 == -1)
-            reg_rd = reg_rs1;
-        else if (reg_rs2 != 0)
-            reg_rd = (signed)reg_rs1 / (signed)reg_rs2;
-        else
-            reg_rd = (unsigned)-1;
-        pc += 4;        
-    }
-    else if ((opcode & INST_DIVU_MASK) == INST_DIVU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        DPRINTF(LOG_INST,("%08x: divu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
-        INST_STAT(ENUM_INST_DIVU);
-        if (reg_rs2 != 0)
-            reg_rd = (unsigned)reg_rs1 / (unsigned)reg_rs2;
-        else
-            reg_rd = (unsigned)-1;
-        pc += 4;        
-    }
-    else if ((opcode & INST_REM_MASK) == INST_REM)
-    {
-        // ['rd', 'rs1', 'rs2']
-        DPRINTF(LOG_INST,("%08x: rem r%d, r%d, r%d\n", pc, rd, rs1, rs2));
-        INST_STAT(ENUM_INST_REM);
+    goto exec_done;
 
-        if((signed)reg_rs1 == INT32_MIN && (signed)reg_rs2 == -1)
-            reg_rd = 0;
-        else if (reg_rs2 != 0)
-            reg_rd = (signed)reg_rs1 % (signed)reg_rs2;
-        else
-            reg_rd = reg_rs1;
-        pc += 4;        
-    }
-    else if ((opcode & INST_REMU_MASK) == INST_REMU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        DPRINTF(LOG_INST,("%08x: remu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
-        INST_STAT(ENUM_INST_REMU);
-        if (reg_rs2 != 0)
-            reg_rd = (unsigned)reg_rs1 % (unsigned)reg_rs2;
-        else
-            reg_rd = reg_rs1;
-        pc += 4;        
-    }
-    else if ((opcode & INST_ECALL_MASK) == INST_ECALL)
+inst_ecall:
     {
         DPRINTF(LOG_INST,("%08x: ecall\n", pc));
         INST_STAT(ENUM_INST_ECALL);
@@ -1389,7 +1696,9 @@ void Riscv::execute(void)
         exception(MCAUSE_ECALL_U + m_csr_mpriv, pc);
         take_exception   = true;
     }
-    else if ((opcode & INST_EBREAK_MASK) == INST_EBREAK)
+    goto exec_done;
+
+inst_ebreak:
     {
         DPRINTF(LOG_INST,("%08x: ebreak\n", pc));
         INST_STAT(ENUM_INST_EBREAK);
@@ -1398,7 +1707,9 @@ void Riscv::execute(void)
         take_exception   = true;
         m_break          = true;
     }
-    else if ((opcode & INST_MRET_MASK) == INST_MRET)
+    goto exec_done;
+
+inst_mret:
     {
         DPRINTF(LOG_INST,("%08x: mret\n", pc));
         INST_STAT(ENUM_INST_MRET);
@@ -1424,7 +1735,9 @@ void Riscv::execute(void)
         // Return to EPC
         pc          = m_csr_mepc;
     }
-    else if ((opcode & INST_SRET_MASK) == INST_SRET)
+    goto exec_done;
+
+inst_sret:
     {
         DPRINTF(LOG_INST,("%08x: sret\n", pc));
         INST_STAT(ENUM_INST_SRET);
@@ -1449,82 +1762,207 @@ void Riscv::execute(void)
         // Return to EPC
         pc          = m_csr_sepc;
     }
-    else if ( ((opcode & INST_SFENCE_MASK) == INST_SFENCE) ||
-              ((opcode & INST_FENCE_MASK) == INST_FENCE) ||
-              ((opcode & INST_IFENCE_MASK) == INST_IFENCE))
-    {
-        DPRINTF(LOG_INST,("%08x: fence\n", pc));
-        INST_STAT(ENUM_INST_FENCE);
-        pc += 4;
-    }
-    else if ((opcode & INST_CSRRW_MASK) == INST_CSRRW)
+    goto exec_done;
+
+inst_csrrw:
     {
-        DPRINTF(LOG_INST,("%08x: csrw r%d, r%d, 0x%x\n", pc, rd, rs1, imm12));
+        DPRINTF(LOG_INST,("%08x: csrw r%d, r%d, 0x%x\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_CSRRW);
-        reg_rd = access_csr(imm12, reg_rs1, true, true);
+        reg_rd = access_csr(imm, reg_rs1, true, true);
         pc += 4;
-    }    
-    else if ((opcode & INST_CSRRS_MASK) == INST_CSRRS)
+    }
+    goto exec_done;
+
+inst_csrrs:
     {
-        DPRINTF(LOG_INST,("%08x: csrs r%d, r%d, 0x%x\n", pc, rd, rs1, imm12));
+        DPRINTF(LOG_INST,("%08x: csrs r%d, r%d, 0x%x\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_CSRRS);
-        reg_rd = access_csr(imm12, reg_rs1, true, false);
+        reg_rd = access_csr(imm, reg_rs1, true, false);
         pc += 4;
     }
-    else if ((opcode & INST_CSRRC_MASK) == INST_CSRRC)
+    goto exec_done;
+
+inst_csrrc:
     {
-        DPRINTF(LOG_INST,("%08x: csrc r%d, r%d, 0x%x\n", pc, rd, rs1, imm12));
+        DPRINTF(LOG_INST,("%08x: csrc r%d, r%d, 0x%x\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_CSRRC);
-        reg_rd = access_csr(imm12, reg_rs1, false, true);
+        reg_rd = access_csr(imm, reg_rs1, false, true);
         pc += 4;
     }
-    else if ((opcode & INST_CSRRWI_MASK) == INST_CSRRWI)
+    goto exec_done;
+
+inst_csrrwi:
     {
-        DPRINTF(LOG_INST,("%08x: csrwi r%d, %d, 0x%x\n", pc, rd, rs1, imm12));
+        DPRINTF(LOG_INST,("%08x: csrwi r%d, %d, 0x%x\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_CSRRWI);
-        reg_rd = access_csr(imm12, rs1, true, true);
+        reg_rd = access_csr(imm, rs1, true, true);
         pc += 4;
     }
-    else if ((opcode & INST_CSRRSI_MASK) == INST_CSRRSI)
+    goto exec_done;
+
+inst_csrrsi:
     {
-        DPRINTF(LOG_INST,("%08x: csrsi r%d, %d, 0x%x\n", pc, rd, rs1, imm12));
+        DPRINTF(LOG_INST,("%08x: csrsi r%d, %d, 0x%x\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_CSRRSI);
-        reg_rd = access_csr(imm12, rs1, true, false);
+        reg_rd = access_csr(imm, rs1, true, false);
         pc += 4;
     }
-    else if ((opcode & INST_CSRRCI_MASK) == INST_CSRRCI)
+    goto exec_done;
+
+inst_csrrci:
     {
-        DPRINTF(LOG_INST,("%08x: csrci r%d, %d, 0x%x\n", pc, rd, rs1, imm12));
+        DPRINTF(LOG_INST,("%08x: csrci r%d, %d, 0x%x\n", pc, rd, rs1, imm));
         INST_STAT(ENUM_INST_CSRRCI);
-        reg_rd = access_csr(imm12, rs1, false, true);
+        reg_rd = access_csr(imm, rs1, false, true);
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_mul:
+    {
+        // ['rd', 'rs1', 'rs2']
+        DPRINTF(LOG_INST,("%08x: mul r%d, r%d, r%d\n", pc, rd, rs1, rs2));
+        INST_STAT(ENUM_INST_MUL);
+        reg_rd = (signed)reg_rs1 * (signed)reg_rs2;
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_mulh:
+    {
+        // ['rd', 'rs1', 'rs2']
+        long long res = ((long long) (int)reg_rs1) * ((long long)(int)reg_rs2);
+        INST_STAT(ENUM_INST_MULH);
+        DPRINTF(LOG_INST,("%08x: mulh r%d, r%d, r%d\n", pc, rd, rs1, rs2));
+        reg_rd = (int)(res >> 32);
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_mulhsu:
+    {
+        // ['rd', 'rs1', 'rs2']
+        long long res = ((long long) (int)reg_rs1) * ((unsigned long long)(unsigned)reg_rs2);
+        INST_STAT(ENUM_INST_MULHSU);
+        DPRINTF(LOG_INST,("%08x: mulhsu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
+        reg_rd = (int)(res >> 32);
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_mulhu:
+    {
+        // ['rd', 'rs1', 'rs2']
+        unsigned long long res = ((unsigned long long) (unsigned)reg_rs1) * ((unsigned long long)(unsigned)reg_rs2);
+        INST_STAT(ENUM_INST_MULHU);
+        DPRINTF(LOG_INST,("%08x: mulhu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
+        reg_rd = (int)(res >> 32);
         pc += 4;
     }
-    else if ((opcode & INST_WFI_MASK) == INST_WFI)
+    goto exec_done;
+
+inst_div:
+    {
+        // ['rd', 'rs1', 'rs2']
+        DPRINTF(LOG_INST,("%08x: div r%d, r%d, r%d\n", pc, rd, rs1, rs2));
+        INST_STAT(ENUM_INST_DIV);
+        if ((signed)reg_rs1 == INT32_MIN && (signed)reg_rs2 == -1)
+            reg_rd = reg_rs1;
+        else if (reg_rs2 != 0)
+            reg_rd = (signed)reg_rs1 / (signed)reg_rs2;
+        else
+            reg_rd = (unsigned)-1;
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_divu:
+    {
+        // ['rd', 'rs1', 'rs2']
+        DPRINTF(LOG_INST,("%08x: divu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
+        INST_STAT(ENUM_INST_DIVU);
+        if (reg_rs2 != 0)
+            reg_rd = (unsigned)reg_rs1 / (unsigned)reg_rs2;
+        else
+            reg_rd = (unsigned)-1;
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_rem:
+    {
+        // ['rd', 'rs1', 'rs2']
+        DPRINTF(LOG_INST,("%08x: rem r%d, r%d, r%d\n", pc, rd, rs1, rs2));
+        INST_STAT(ENUM_INST_REM);
+
+        if((signed)reg_rs1 == INT32_MIN && (signed)reg_rs2 == -1)
+            reg_rd = 0;
+        else if (reg_rs2 != 0)
+            reg_rd = (signed)reg_rs1 % (signed)reg_rs2;
+        else
+            reg_rd = reg_rs1;
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_remu:
+    {
+        // ['rd', 'rs1', 'rs2']
+        DPRINTF(LOG_INST,("%08x: remu r%d, r%d, r%d\n", pc, rd, rs1, rs2));
+        INST_STAT(ENUM_INST_REMU);
+        if (reg_rs2 != 0)
+            reg_rd = (unsigned)reg_rs1 % (unsigned)reg_rs2;
+        else
+            reg_rd = reg_rs1;
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_fence:
+    {
+        DPRINTF(LOG_INST,("%08x: fence\n", pc));
+        INST_STAT(ENUM_INST_FENCE);
+
+        // sfence.vma
+        if ((opcode & INST_SFENCE_MASK) == INST_SFENCE)
+            flush_tlb();
+        // fence.i, code might have been written by another hart
+        else if ((opcode & INST_IFENCE_MASK) == INST_IFENCE)
+            flush_decode_cache();
+
+        pc += 4;
+    }
+    goto exec_done;
+
+inst_wfi:
     {
         DPRINTF(LOG_INST,("%08x: wfi\n", pc));
         INST_STAT(ENUM_INST_WFI);
         pc += 4;
     }
-    else
+    goto exec_done;
+
+inst_illegal:
     {
-        error(false, "Bad instruction @ %x (opcode %x)\n", pc, opcode);
+        // As RVC is not supported, fault on opcode which is all zeros
+        if (opcode == 0)
+            error(false, "Bad instruction @ %x\n", pc);
+        else
+            error(false, "Bad instruction @ %x (opcode %x)\n", pc, opcode);
+
         exception(MCAUSE_ILLEGAL_INSTRUCTION, pc);
         m_fault        = true;
         take_exception = true;
     }
 
+exec_done:
     if (rd != 0)
         m_gpr[rd] = reg_rd;
 
     // Pending interrupt
     if (!take_exception && (m_csr_mip & m_csr_mie))
     {
-        uint32_t pending_interrupts = (m_csr_mip & m_csr_mie);
-        uint32_t m_enabled          = m_csr_mpriv < PRIV_MACHINE || (m_csr_mpriv == PRIV_MACHINE && (m_csr_msr & SR_MIE));
-        uint32_t s_enabled          = m_csr_mpriv < PRIV_SUPER   || (m_csr_mpriv == PRIV_SUPER   && (m_csr_msr & SR_SIE));
-        uint32_t m_interrupts       = pending_interrupts & ~m_csr_mideleg & -m_enabled;
-        uint32_t s_interrupts       = pending_interrupts & m_csr_mideleg & -s_enabled;
-        uint32_t interrupts         = m_interrupts ? m_interrupts : s_interrupts;
+        uint32_t interrupts = pending_interrupts();
 
         // Interrupt pending and mask enabled
         if (interrupts)
@@ -1554,6 +1992,19 @@ void Riscv::execute(void)
         m_pc = pc;
 }
 //-----------------------------------------------------------------
+// pending_interrupts: Interrupts which would be taken now
+//-----------------------------------------------------------------
+uint32_t Riscv::pending_interrupts(void)
+{
+    uint32_t pending_interrupts = (m_csr_mip & m_csr_mie);
+    uint32_t m_enabled          = m_csr_mpriv < PRIV_MACHINE || (m_csr_mpriv == PRIV_MACHINE && (m_csr_msr & SR_MIE));
+    uint32_t s_enabled          = m_csr_mpriv < PRIV_SUPER   || (m_csr_mpriv == PRIV_SUPER   && (m_csr_msr & SR_SIE));
+    uint32_t m_interrupts       = pending_interrupts & ~m_csr_mideleg & -m_enabled;
+    uint32_t s_interrupts       = pending_interrupts & m_csr_mideleg & -s_enabled;
+
+    return m_interrupts ? m_interrupts : s_interrupts;
+}
+//-----------------------------------------------------------------
 // step: Step through one instruction
 //-----------------------------------------------------------------
 void Riscv::step(void)
@@ -1563,6 +2014,16 @@ void Riscv::step(void)
     // Execute instruction at current PC
     execute();
 
+    // Completed instruction for subscribers, writeback is seen first
+    if (event_enabled(COSIM_EVENT_RETIRE) && !m_fault)
+    {
+        uint32_t opcode = get_opcode(m_pc_x);
+        uint32_t rd     = (opcode & OPCODE_RD_MASK) >> OPCODE_RD_SHIFT;
+
+        event_push(COSIM_EVENT_WRITEBACK, rd, m_gpr[rd]);
+        event_push(COSIM_EVENT_RETIRE, m_pc_x, opcode);
+    }
+
     // Increment timer counter
     m_csr_mtime++;
 
@@ -1589,6 +2050,44 @@ void Riscv::step(void)
         m_break = true;
 }
 //-----------------------------------------------------------------
+// run: Execute a number of instructions, translated if enabled
+//-----------------------------------------------------------------
+uint64_t Riscv::run(uint64_t max_steps)
+{
+    if (m_jit)
+        return m_jit->run(max_steps);
+
+    return cosim_cpu_api::run(max_steps);
+}
+//-----------------------------------------------------------------
+// enable_jit: Select block translation for run()
+//-----------------------------------------------------------------
+bool Riscv::enable_jit(bool enable)
+{
+    if (!enable)
+    {
+        delete m_jit;
+        m_jit = NULL;
+        return true;
+    }
+
+#if defined(__x86_64__)
+    if (!m_jit)
+    {
+        m_jit = new RiscvJit(this);
+        if (!m_jit->valid())
+        {
+            delete m_jit;
+            m_jit = NULL;
+        }
+    }
+
+    return m_jit != NULL;
+#else
+    return false;
+#endif
+}
+//-----------------------------------------------------------------
 // set_interrupt: Register pending interrupt
 //-----------------------------------------------------------------
 void Riscv::set_interrupt(int irq)
@@ -1604,6 +2103,13 @@ void Riscv::stats_reset(void)
     // Clear stats
     for (int i=STATS_MIN;i<STATS_MAX;i++)
         m_stats[i] = 0;
+
+    m_dcache_hits   = 0;
+    m_dcache_misses = 0;
+    m_itlb_hits     = 0;
+    m_itlb_misses   = 0;
+    m_dtlb_hits     = 0;
+    m_dtlb_misses   = 0;
 }
 //-----------------------------------------------------------------
 // stats_dump: Show execution stats
@@ -1626,6 +2132,18 @@ void Riscv::stats_dump(void)
             printf( "- Stores %d (%d%%)\n", m_stats[STATS_STORES], (m_stats[STATS_STORES] * 100) / m_stats[STATS_INSTRUCTIONS]);
             printf( "- Branches Operations %d (%d%%)\n", m_stats[STATS_BRANCHES], (m_stats[STATS_BRANCHES] * 100)  / m_stats[STATS_INSTRUCTIONS]);
         }
+        if (m_dcache_hits + m_dcache_misses > 0)
+            printf( "- Decode cache hits %llu (%d%%)\n", (unsigned long long)m_dcache_hits,
+                    (int)((m_dcache_hits * 100) / (m_dcache_hits + m_dcache_misses)));
+        if (m_jit)
+            printf( "- JIT blocks %llu (%llu instructions)\n", (unsigned long long)m_jit->get_blocks(),
+                    (unsigned long long)m_jit->get_insns());
+        if (m_itlb_hits + m_itlb_misses > 0)
+            printf( "- ITLB hits %llu misses %llu (%d%%)\n", (unsigned long long)m_itlb_hits, (unsigned long long)m_itlb_misses,
+                    (int)((m_itlb_hits * 100) / (m_itlb_hits + m_itlb_misses)));
+        if (m_dtlb_hits + m_dtlb_misses > 0)
+            printf( "- DTLB hits %llu misses %llu (%d%%)\n", (unsigned long long)m_dtlb_hits, (unsigned long long)m_dtlb_misses,
+                    (int)((m_dtlb_hits * 100) / (m_dtlb_hits + m_dtlb_misses)));
     }
 
     stats_reset();
@@ -43,10 +43,14 @@
 
 #include <stdint.h>
 #include <vector>
+#include <unordered_map>
 #include "riscv_isa.h"
+#include "riscv_decode.h"
 #include "cosim_api.h"
 #include "memory.h"
 
+class RiscvJit;
+
 //--------------------------------------------------------------------
 // Defines:
 //--------------------------------------------------------------------
@@ -58,6 +62,40 @@
 
 #define MAX_MEM_REGIONS     16
 
+// Decode cache page, one entry per 32-bit instruction slot
+#define DCACHE_PAGE_SHIFT   12
+#define DCACHE_PAGE_ENTRIES (1 << (DCACHE_PAGE_SHIFT - 2))
+#define DCACHE_CODE_WORDS   ((1 << (32 - DCACHE_PAGE_SHIFT)) / 64)
+
+typedef struct
+{
+    riscv_decoded inst[DCACHE_PAGE_ENTRIES];
+} riscv_dcache_page;
+
+//--------------------------------------------------------------------
+// Software TLB:
+//--------------------------------------------------------------------
+#define TLB_ENTRIES         256
+#define TLB_PAGE_SHIFT      12
+#define TLB_PAGE_SIZE       (1 << TLB_PAGE_SHIFT)
+
+#define TLB_PERM_R          (1 << 0)
+#define TLB_PERM_W          (1 << 1)
+#define TLB_PERM_X          (1 << 2)
+
+typedef struct
+{
+    uint32_t vpn;
+    // Physical page address
+    uint32_t ppage;
+    // Host address of the page, NULL if it is not plain memory
+    uint8_t *host;
+    // Privilege level (and SUM) the translation was done for
+    uint8_t  ctx;
+    // Access types checked by the translation, 0 if entry is empty
+    uint8_t  perm;
+} riscv_tlb_entry;
+
 //--------------------------------------------------------------------
 // Enums:
 //--------------------------------------------------------------------
@@ -139,9 +177,28 @@ public:
     void                set_stats_interface(IStatsInterface *stats) { m_stats_if = stats; }
     void                set_console(IConsoleIO *cio)                { m_console = cio; }
 
+    // Value of mhartid, kept over reset
+    void                set_hartid(uint32_t id)                     { m_hartid = id; }
+
+    // Exit process on SIM_CTRL_EXIT (default) or just stop the model
+    void                set_exit_on_ctrl(bool enable)               { m_exit_on_ctrl = enable; }
+    bool                get_exited(void)                            { return m_exited; }
+    int                 get_exit_code(void)                         { return m_exit_code; }
+
     void                stats_reset(void);
     void                stats_dump(void);
 
+    // Translate hot blocks to host code, used by run() but never by step()
+    bool                enable_jit(bool enable);
+    uint64_t            run(uint64_t max_steps);
+
+    // Instruction decode, results are cached per physical pc
+    static void         decode(uint32_t opcode, riscv_decoded *inst);
+    // Must be called if memory was changed bypassing the model
+    void                flush_decode_cache(void);
+    // Must be called if address translation or memory map changed
+    void                flush_tlb(void);
+
     bool                error(bool terminal, const char *fmt, ...);
 
 protected:  
@@ -150,6 +207,17 @@ protected:
     int                 store(uint32_t pc, uint32_t address, uint32_t data, int width);
     uint32_t            access_csr(uint32_t address, uint32_t data, bool set, bool clr);
     void                exception(uint32_t cause, uint32_t pc, uint32_t badaddr = 0);
+    uint32_t            pending_interrupts(void);
+
+    riscv_decoded      *dcache_lookup(uint32_t phy_pc);
+    void                dcache_invalidate(uint32_t address, int width);
+
+    uint8_t             tlb_ctx(void);
+    riscv_tlb_entry    *tlb_lookup(riscv_tlb_entry *tlb, uint32_t address, int perm);
+    riscv_tlb_entry    *tlb_fill(riscv_tlb_entry *tlb, uint32_t address, uint32_t physical, int perm);
+    int                 mem_region(uint32_t address);
+
+    friend class RiscvJit;
 
 // MMU
 private:
@@ -194,6 +262,7 @@ private:
     uint32_t            m_mem_base[MAX_MEM_REGIONS];
     uint32_t            m_mem_size[MAX_MEM_REGIONS];
     int                 m_mem_regions;
+    int                 m_mem_last;
 
     // Status
     bool                m_fault;
@@ -206,10 +275,64 @@ private:
 
     // Stats
     uint32_t            m_stats[STATS_MAX];
+    uint64_t            m_dcache_hits;
+    uint64_t            m_dcache_misses;
+    uint64_t            m_itlb_hits;
+    uint64_t            m_itlb_misses;
+    uint64_t            m_dtlb_hits;
+    uint64_t            m_dtlb_misses;
     IStatsInterface     *m_stats_if;
 
     // Console
     IConsoleIO         *m_console;
+
+    // Decode cache
+    std::unordered_map<uint32_t, riscv_dcache_page *> m_dcache;
+    riscv_dcache_page  *m_dcache_last;
+    uint32_t            m_dcache_last_ppn;
+    // Bitmap of pages which have decoded instructions
+    std::vector<uint64_t> m_dcache_code;
+    // Slot for instructions which are not cached
+    riscv_decoded       m_dcache_tmp;
+
+    // Software TLB
+    riscv_tlb_entry     m_itlb[TLB_ENTRIES];
+    riscv_tlb_entry     m_dtlb[TLB_ENTRIES];
+
+    uint32_t            m_hartid;
+
+    // Exit
+    bool                m_exit_on_ctrl;
+    bool                m_exited;
+    int                 m_exit_code;
+
+    // Block translator, NULL when interpreting only
+    RiscvJit           *m_jit;
 };
 
+//--------------------------------------------------------------------
+// tlb_ctx: Translation context TLB entries are valid for
+//--------------------------------------------------------------------
+inline uint8_t Riscv::tlb_ctx(void)
+{
+#ifdef CONFIG_MMU
+    return (m_csr_mpriv & 3) | ((m_csr_msr & SR_SUM) ? 4 : 0);
+#else
+    return 0;
+#endif
+}
+//--------------------------------------------------------------------
+// tlb_lookup: Find translation of address checked for access perm
+//--------------------------------------------------------------------
+inline riscv_tlb_entry *Riscv::tlb_lookup(riscv_tlb_entry *tlb, uint32_t address, int perm)
+{
+    uint32_t vpn = address >> TLB_PAGE_SHIFT;
+    riscv_tlb_entry *entry = &tlb[vpn & (TLB_ENTRIES - 1)];
+
+    if ((entry->perm & perm) && entry->vpn == vpn && entry->ctx == tlb_ctx())
+        return entry;
+
+    return NULL;
+}
+
 #endif
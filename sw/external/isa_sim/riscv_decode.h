@@ -0,0 +1,571 @@
+//-----------------------------------------------------------------
+//                     RISC-V ISA Simulator
+//             Instruction decoder and RVC expander
+//-----------------------------------------------------------------
+#ifndef __RISCV_DECODE_H__
+#define __RISCV_DECODE_H__
+
+#include <stdint.h>
+#include "riscv_isa.h"
+
+//--------------------------------------------------------------------
+// Decoded instruction:
+//--------------------------------------------------------------------
+#define DECODE_INVALID      0xFF
+
+typedef struct
+{
+    uint32_t opcode;
+    int32_t  imm;
+    // eInstructions, ENUM_INST_MAX if illegal, DECODE_INVALID if not decoded
+    uint8_t  id;
+    uint8_t  rd;
+    uint8_t  rs1;
+    uint8_t  rs2;
+} riscv_decoded;
+
+//--------------------------------------------------------------------
+// Decode table, searched in order (first match wins)
+//--------------------------------------------------------------------
+enum eDecodeImm
+{
+    DECODE_IMM_NONE,
+    DECODE_IMM_I,
+    DECODE_IMM_S,
+    DECODE_IMM_B,
+    DECODE_IMM_U,
+    DECODE_IMM_J,
+    DECODE_IMM_SHAMT
+};
+
+typedef struct
+{
+    uint32_t mask;
+    uint32_t match;
+    uint8_t  id;
+    uint8_t  imm;
+    // Disassembly name when it differs from inst_names[id]
+    const char *name;
+} riscv_decode_entry;
+
+static constexpr riscv_decode_entry riscv_decode_table[] =
+{
+    { INST_ANDI_MASK, INST_ANDI, ENUM_INST_ANDI, DECODE_IMM_I, nullptr },
+    { INST_ORI_MASK, INST_ORI, ENUM_INST_ORI, DECODE_IMM_I, nullptr },
+    { INST_XORI_MASK, INST_XORI, ENUM_INST_XORI, DECODE_IMM_I, nullptr },
+    { INST_ADDI_MASK, INST_ADDI, ENUM_INST_ADDI, DECODE_IMM_I, nullptr },
+    { INST_SLTI_MASK, INST_SLTI, ENUM_INST_SLTI, DECODE_IMM_I, nullptr },
+    { INST_SLTIU_MASK, INST_SLTIU, ENUM_INST_SLTIU, DECODE_IMM_I, nullptr },
+    { INST_SLLI_MASK, INST_SLLI, ENUM_INST_SLLI, DECODE_IMM_SHAMT, nullptr },
+    { INST_SRLI_MASK, INST_SRLI, ENUM_INST_SRLI, DECODE_IMM_SHAMT, nullptr },
+    { INST_SRAI_MASK, INST_SRAI, ENUM_INST_SRAI, DECODE_IMM_SHAMT, nullptr },
+    { INST_LUI_MASK, INST_LUI, ENUM_INST_LUI, DECODE_IMM_U, nullptr },
+    { INST_AUIPC_MASK, INST_AUIPC, ENUM_INST_AUIPC, DECODE_IMM_U, nullptr },
+    { INST_ADD_MASK, INST_ADD, ENUM_INST_ADD, DECODE_IMM_NONE, nullptr },
+    { INST_SUB_MASK, INST_SUB, ENUM_INST_SUB, DECODE_IMM_NONE, nullptr },
+    { INST_SLT_MASK, INST_SLT, ENUM_INST_SLT, DECODE_IMM_NONE, nullptr },
+    { INST_SLTU_MASK, INST_SLTU, ENUM_INST_SLTU, DECODE_IMM_NONE, nullptr },
+    { INST_XOR_MASK, INST_XOR, ENUM_INST_XOR, DECODE_IMM_NONE, nullptr },
+    { INST_OR_MASK, INST_OR, ENUM_INST_OR, DECODE_IMM_NONE, nullptr },
+    { INST_AND_MASK, INST_AND, ENUM_INST_AND, DECODE_IMM_NONE, nullptr },
+    { INST_SLL_MASK, INST_SLL, ENUM_INST_SLL, DECODE_IMM_NONE, nullptr },
+    { INST_SRL_MASK, INST_SRL, ENUM_INST_SRL, DECODE_IMM_NONE, nullptr },
+    { INST_SRA_MASK, INST_SRA, ENUM_INST_SRA, DECODE_IMM_NONE, nullptr },
+    { INST_JAL_MASK, INST_JAL, ENUM_INST_JAL, DECODE_IMM_J, nullptr },
+    { INST_JALR_MASK, INST_JALR, ENUM_INST_JALR, DECODE_IMM_I, nullptr },
+    { INST_BEQ_MASK, INST_BEQ, ENUM_INST_BEQ, DECODE_IMM_B, nullptr },
+    { INST_BNE_MASK, INST_BNE, ENUM_INST_BNE, DECODE_IMM_B, nullptr },
+    { INST_BLT_MASK, INST_BLT, ENUM_INST_BLT, DECODE_IMM_B, nullptr },
+    { INST_BGE_MASK, INST_BGE, ENUM_INST_BGE, DECODE_IMM_B, nullptr },
+    { INST_BLTU_MASK, INST_BLTU, ENUM_INST_BLTU, DECODE_IMM_B, nullptr },
+    { INST_BGEU_MASK, INST_BGEU, ENUM_INST_BGEU, DECODE_IMM_B, nullptr },
+    { INST_LB_MASK, INST_LB, ENUM_INST_LB, DECODE_IMM_I, nullptr },
+    { INST_LH_MASK, INST_LH, ENUM_INST_LH, DECODE_IMM_I, nullptr },
+    { INST_LW_MASK, INST_LW, ENUM_INST_LW, DECODE_IMM_I, nullptr },
+    { INST_LBU_MASK, INST_LBU, ENUM_INST_LBU, DECODE_IMM_I, nullptr },
+    { INST_LHU_MASK, INST_LHU, ENUM_INST_LHU, DECODE_IMM_I, nullptr },
+    { INST_LWU_MASK, INST_LWU, ENUM_INST_LWU, DECODE_IMM_I, nullptr },
+    { INST_SB_MASK, INST_SB, ENUM_INST_SB, DECODE_IMM_S, nullptr },
+    { INST_SH_MASK, INST_SH, ENUM_INST_SH, DECODE_IMM_S, nullptr },
+    { INST_SW_MASK, INST_SW, ENUM_INST_SW, DECODE_IMM_S, nullptr },
+    { INST_MUL_MASK, INST_MUL, ENUM_INST_MUL, DECODE_IMM_NONE, nullptr },
+    { INST_MULH_MASK, INST_MULH, ENUM_INST_MULH, DECODE_IMM_NONE, nullptr },
+    { INST_MULHSU_MASK, INST_MULHSU, ENUM_INST_MULHSU, DECODE_IMM_NONE, nullptr },
+    { INST_MULHU_MASK, INST_MULHU, ENUM_INST_MULHU, DECODE_IMM_NONE, nullptr },
+    { INST_DIV_MASK, INST_DIV, ENUM_INST_DIV, DECODE_IMM_NONE, nullptr },
+    { INST_DIVU_MASK, INST_DIVU, ENUM_INST_DIVU, DECODE_IMM_NONE, nullptr },
+    { INST_REM_MASK, INST_REM, ENUM_INST_REM, DECODE_IMM_NONE, nullptr },
+    { INST_REMU_MASK, INST_REMU, ENUM_INST_REMU, DECODE_IMM_NONE, nullptr },
+    { INST_ECALL_MASK, INST_ECALL, ENUM_INST_ECALL, DECODE_IMM_NONE, nullptr },
+    { INST_EBREAK_MASK, INST_EBREAK, ENUM_INST_EBREAK, DECODE_IMM_NONE, nullptr },
+    { INST_MRET_MASK, INST_MRET, ENUM_INST_MRET, DECODE_IMM_NONE, nullptr },
+    { INST_SRET_MASK, INST_SRET, ENUM_INST_SRET, DECODE_IMM_NONE, nullptr },
+    { INST_SFENCE_MASK, INST_SFENCE, ENUM_INST_FENCE, DECODE_IMM_NONE, "sfence.vma" },
+    { INST_FENCE_MASK, INST_FENCE, ENUM_INST_FENCE, DECODE_IMM_NONE, "fence" },
+    { INST_IFENCE_MASK, INST_IFENCE, ENUM_INST_FENCE, DECODE_IMM_NONE, "fence.i" },
+    { INST_CSRRW_MASK, INST_CSRRW, ENUM_INST_CSRRW, DECODE_IMM_I, nullptr },
+    { INST_CSRRS_MASK, INST_CSRRS, ENUM_INST_CSRRS, DECODE_IMM_I, nullptr },
+    { INST_CSRRC_MASK, INST_CSRRC, ENUM_INST_CSRRC, DECODE_IMM_I, nullptr },
+    { INST_CSRRWI_MASK, INST_CSRRWI, ENUM_INST_CSRRWI, DECODE_IMM_I, nullptr },
+    { INST_CSRRSI_MASK, INST_CSRRSI, ENUM_INST_CSRRSI, DECODE_IMM_I, nullptr },
+    { INST_CSRRCI_MASK, INST_CSRRCI, ENUM_INST_CSRRCI, DECODE_IMM_I, nullptr },
+    { INST_WFI_MASK, INST_WFI, ENUM_INST_WFI, DECODE_IMM_NONE, nullptr },
+};
+
+#define DECODE_TABLE_SIZE   (sizeof(riscv_decode_table) / sizeof(riscv_decode_table[0]))
+
+//--------------------------------------------------------------------
+// Lookup by major opcode (bits 6:2) and funct3, built at compile time.
+// Each bucket lists the table entries which can match, in table order.
+//--------------------------------------------------------------------
+#define DECODE_BUCKETS      256
+#define DECODE_BUCKET_MAX   8
+#define DECODE_BUCKET_MASK  0x707c
+
+typedef struct
+{
+    uint8_t n[DECODE_BUCKETS];
+    uint8_t entry[DECODE_BUCKETS][DECODE_BUCKET_MAX];
+} riscv_decode_lut;
+
+static constexpr uint32_t riscv_decode_bucket(uint32_t opcode)
+{
+    return ((opcode >> 2) & 0x1f) | (((opcode >> 12) & 0x7) << 5);
+}
+
+static constexpr riscv_decode_lut riscv_decode_lut_build(void)
+{
+    riscv_decode_lut lut = {};
+    for (uint32_t b = 0; b < DECODE_BUCKETS; b++)
+    {
+        const uint32_t bits = ((b & 0x1f) << 2) | ((b >> 5) << 12);
+        for (uint32_t i = 0; i < DECODE_TABLE_SIZE; i++)
+        {
+            const uint32_t mask = riscv_decode_table[i].mask & DECODE_BUCKET_MASK;
+            if ((bits & mask) != (riscv_decode_table[i].match & mask))
+                continue;
+            // Too many candidates fail the build here (index out of range)
+            lut.entry[b][lut.n[b]++] = (uint8_t)i;
+        }
+    }
+    return lut;
+}
+
+static constexpr riscv_decode_lut riscv_decode_lookup = riscv_decode_lut_build();
+
+//-----------------------------------------------------------------
+// riscv_decode_match: Index of the table entry matching a 32-bit
+// instruction, DECODE_TABLE_SIZE if none does
+//-----------------------------------------------------------------
+static constexpr uint32_t riscv_decode_match(uint32_t opcode)
+{
+    const uint32_t b = riscv_decode_bucket(opcode);
+    for (uint32_t i = 0; i < riscv_decode_lookup.n[b]; i++)
+    {
+        const uint32_t idx = riscv_decode_lookup.entry[b][i];
+        if ((opcode & riscv_decode_table[idx].mask) == riscv_decode_table[idx].match)
+            return idx;
+    }
+    return DECODE_TABLE_SIZE;
+}
+
+//-----------------------------------------------------------------
+// riscv_decode: Decode 32-bit instruction into handler id and operands
+//-----------------------------------------------------------------
+static constexpr void riscv_decode(uint32_t opcode, riscv_decoded *inst)
+{
+    inst->opcode = opcode;
+    inst->rd     = (opcode & OPCODE_RD_MASK)  >> OPCODE_RD_SHIFT;
+    inst->rs1    = (opcode & OPCODE_RS1_MASK) >> OPCODE_RS1_SHIFT;
+    inst->rs2    = (opcode & OPCODE_RS2_MASK) >> OPCODE_RS2_SHIFT;
+    inst->id     = ENUM_INST_MAX;
+    inst->imm    = 0;
+
+    // 16-bit encodings must be expanded first (riscv_rvc_expand)
+    if ((opcode & 3) != 3)
+        return ;
+
+    const uint32_t idx = riscv_decode_match(opcode);
+    if (idx == DECODE_TABLE_SIZE)
+        return ;
+
+    const riscv_decode_entry &e = riscv_decode_table[idx];
+    inst->id = e.id;
+    switch (e.imm)
+    {
+        case DECODE_IMM_I:
+            inst->imm = ((int32_t)(uint32_t)(opcode & OPCODE_TYPEI_IMM_MASK)) >> OPCODE_TYPEI_IMM_SHIFT;
+            break;
+        case DECODE_IMM_S:
+            inst->imm = (int32_t)OPCODE_STYPE_IMM(opcode);
+            break;
+        case DECODE_IMM_B:
+            inst->imm = (int32_t)OPCODE_SBTYPE_IMM(opcode);
+            break;
+        case DECODE_IMM_U:
+            inst->imm = (int32_t)(opcode & OPCODE_TYPEU_IMM_MASK);
+            break;
+        case DECODE_IMM_J:
+            inst->imm = (int32_t)OPCODE_UJTYPE_IMM(opcode);
+            break;
+        case DECODE_IMM_SHAMT:
+            inst->imm = (opcode & OPCODE_SHAMT_MASK) >> OPCODE_SHAMT_SHIFT;
+            break;
+        default:
+            break;
+    }
+}
+
+//--------------------------------------------------------------------
+// RVC (RV32C without floating point loads / stores)
+//--------------------------------------------------------------------
+enum eRvcInstructions
+{
+    ENUM_RVC_NONE,
+    ENUM_RVC_ADDI4SPN,
+    ENUM_RVC_LW,
+    ENUM_RVC_SW,
+    ENUM_RVC_NOP,
+    ENUM_RVC_ADDI,
+    ENUM_RVC_JAL,
+    ENUM_RVC_LI,
+    ENUM_RVC_ADDI16SP,
+    ENUM_RVC_LUI,
+    ENUM_RVC_SRLI,
+    ENUM_RVC_SRAI,
+    ENUM_RVC_ANDI,
+    ENUM_RVC_SUB,
+    ENUM_RVC_XOR,
+    ENUM_RVC_OR,
+    ENUM_RVC_AND,
+    ENUM_RVC_J,
+    ENUM_RVC_BEQZ,
+    ENUM_RVC_BNEZ,
+    ENUM_RVC_SLLI,
+    ENUM_RVC_LWSP,
+    ENUM_RVC_JR,
+    ENUM_RVC_MV,
+    ENUM_RVC_EBREAK,
+    ENUM_RVC_JALR,
+    ENUM_RVC_ADD,
+    ENUM_RVC_SWSP,
+    ENUM_RVC_MAX
+};
+
+// Bits hi:lo of x moved to bit position to
+#define RVC_BITS(x, hi, lo, to)  ((((x) >> (lo)) & ((1u << ((hi) - (lo) + 1)) - 1)) << (to))
+// Register x8-x15 of the 3-bit fields
+#define RVC_REG3(x, lo)          (8 + (((x) >> (lo)) & 0x7))
+
+static constexpr uint32_t rvc_enc_r(uint32_t op, uint32_t f3, uint32_t f7, uint32_t rd, uint32_t rs1, uint32_t rs2)
+{
+    return op | (rd << 7) | (f3 << 12) | (rs1 << 15) | (rs2 << 20) | (f7 << 25);
+}
+
+static constexpr uint32_t rvc_enc_i(uint32_t op, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm)
+{
+    return op | (rd << 7) | (f3 << 12) | (rs1 << 15) | ((uint32_t)imm << 20);
+}
+
+static constexpr uint32_t rvc_enc_s(uint32_t op, uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm)
+{
+    return op | (RVC_BITS(imm, 4, 0, 7)) | (f3 << 12) | (rs1 << 15) | (rs2 << 20) | (RVC_BITS(imm, 11, 5, 25));
+}
+
+static constexpr uint32_t rvc_enc_b(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm)
+{
+    return 0x63 | RVC_BITS(imm, 11, 11, 7) | RVC_BITS(imm, 4, 1, 8) | (f3 << 12) | (rs1 << 15) | (rs2 << 20) |
+           RVC_BITS(imm, 10, 5, 25) | RVC_BITS(imm, 12, 12, 31);
+}
+
+static constexpr uint32_t rvc_enc_j(uint32_t rd, int32_t imm)
+{
+    return 0x6f | (rd << 7) | RVC_BITS(imm, 19, 12, 12) | RVC_BITS(imm, 11, 11, 20) |
+           RVC_BITS(imm, 10, 1, 21) | RVC_BITS(imm, 20, 20, 31);
+}
+
+// Sign extend the low bits of x
+static constexpr int32_t rvc_sext(uint32_t x, int bits)
+{
+    return (int32_t)(x << (32 - bits)) >> (32 - bits);
+}
+
+//-----------------------------------------------------------------
+// riscv_rvc_expand: 32-bit equivalent of a 16-bit instruction,
+// 0 (illegal) for reserved and unsupported encodings
+//-----------------------------------------------------------------
+static constexpr uint32_t riscv_rvc_expand(uint32_t insn, int *rvc_id = nullptr)
+{
+    const uint32_t c        = insn & 0xffff;
+    const uint32_t quadrant = c & 0x3;
+    const uint32_t f3       = (c >> 13) & 0x7;
+    const uint32_t rd       = (c >> 7) & 0x1f;
+    const uint32_t rs2      = (c >> 2) & 0x1f;
+    const int32_t  imm6     = rvc_sext(RVC_BITS(c, 12, 12, 5) | RVC_BITS(c, 6, 2, 0), 6);
+    const int32_t  jimm     = rvc_sext(RVC_BITS(c, 12, 12, 11) | RVC_BITS(c, 11, 11, 4) | RVC_BITS(c, 10, 9, 8) |
+                                       RVC_BITS(c, 8, 8, 10) | RVC_BITS(c, 7, 7, 6) | RVC_BITS(c, 6, 6, 7) |
+                                       RVC_BITS(c, 5, 3, 1) | RVC_BITS(c, 2, 2, 5), 12);
+    const int32_t  bimm     = rvc_sext(RVC_BITS(c, 12, 12, 8) | RVC_BITS(c, 11, 10, 3) | RVC_BITS(c, 6, 5, 6) |
+                                       RVC_BITS(c, 4, 3, 1) | RVC_BITS(c, 2, 2, 5), 9);
+    const uint32_t lwimm    = RVC_BITS(c, 12, 10, 3) | RVC_BITS(c, 6, 6, 2) | RVC_BITS(c, 5, 5, 6);
+    int      id  = ENUM_RVC_NONE;
+    uint32_t res = 0;
+
+    if (rvc_id)
+        *rvc_id = ENUM_RVC_NONE;
+    if (c == 0 || quadrant == 3)
+        return 0;
+
+    if (quadrant == 0)
+    {
+        if (f3 == 0)
+        {
+            const uint32_t imm = RVC_BITS(c, 12, 11, 4) | RVC_BITS(c, 10, 7, 6) | RVC_BITS(c, 6, 6, 2) | RVC_BITS(c, 5, 5, 3);
+            if (imm != 0)
+            {
+                id  = ENUM_RVC_ADDI4SPN;
+                res = rvc_enc_i(0x13, 0, RVC_REG3(c, 2), 2, imm);
+            }
+        }
+        else if (f3 == 2)
+        {
+            id  = ENUM_RVC_LW;
+            res = rvc_enc_i(0x03, 2, RVC_REG3(c, 2), RVC_REG3(c, 7), lwimm);
+        }
+        else if (f3 == 6)
+        {
+            id  = ENUM_RVC_SW;
+            res = rvc_enc_s(0x23, 2, RVC_REG3(c, 7), RVC_REG3(c, 2), lwimm);
+        }
+    }
+    else if (quadrant == 1)
+    {
+        switch (f3)
+        {
+            case 0:
+                id  = rd ? ENUM_RVC_ADDI : ENUM_RVC_NOP;
+                res = rvc_enc_i(0x13, 0, rd, rd, imm6);
+                break;
+            case 1:
+                id  = ENUM_RVC_JAL;
+                res = rvc_enc_j(1, jimm);
+                break;
+            case 2:
+                id  = ENUM_RVC_LI;
+                res = rvc_enc_i(0x13, 0, rd, 0, imm6);
+                break;
+            case 3:
+                if (rd == 2)
+                {
+                    const int32_t imm = rvc_sext(RVC_BITS(c, 12, 12, 9) | RVC_BITS(c, 6, 6, 4) | RVC_BITS(c, 5, 5, 6) |
+                                                 RVC_BITS(c, 4, 3, 7) | RVC_BITS(c, 2, 2, 5), 10);
+                    if (imm != 0)
+                    {
+                        id  = ENUM_RVC_ADDI16SP;
+                        res = rvc_enc_i(0x13, 0, 2, 2, imm);
+                    }
+                }
+                else if (imm6 != 0)
+                {
+                    id  = ENUM_RVC_LUI;
+                    res = 0x37 | (rd << 7) | ((uint32_t)imm6 << 12);
+                }
+                break;
+            case 4:
+            {
+                const uint32_t rs1p = RVC_REG3(c, 7);
+                const uint32_t rs2p = RVC_REG3(c, 2);
+                switch ((c >> 10) & 0x3)
+                {
+                    case 0:
+                        // shamt[5] must be zero on RV32
+                        if (!(c & (1 << 12)))
+                        {
+                            id  = ENUM_RVC_SRLI;
+                            res = rvc_enc_i(0x13, 5, rs1p, rs1p, imm6 & 0x1f);
+                        }
+                        break;
+                    case 1:
+                        if (!(c & (1 << 12)))
+                        {
+                            id  = ENUM_RVC_SRAI;
+                            res = rvc_enc_i(0x13, 5, rs1p, rs1p, (imm6 & 0x1f) | 0x400);
+                        }
+                        break;
+                    case 2:
+                        id  = ENUM_RVC_ANDI;
+                        res = rvc_enc_i(0x13, 7, rs1p, rs1p, imm6);
+                        break;
+                    default:
+                        // subw / addw are RV64 only
+                        if (c & (1 << 12))
+                            break;
+                        switch ((c >> 5) & 0x3)
+                        {
+                            case 0:  id = ENUM_RVC_SUB; res = rvc_enc_r(0x33, 0, 0x20, rs1p, rs1p, rs2p); break;
+                            case 1:  id = ENUM_RVC_XOR; res = rvc_enc_r(0x33, 4, 0, rs1p, rs1p, rs2p);    break;
+                            case 2:  id = ENUM_RVC_OR;  res = rvc_enc_r(0x33, 6, 0, rs1p, rs1p, rs2p);    break;
+                            default: id = ENUM_RVC_AND; res = rvc_enc_r(0x33, 7, 0, rs1p, rs1p, rs2p);    break;
+                        }
+                        break;
+                }
+                break;
+            }
+            case 5:
+                id  = ENUM_RVC_J;
+                res = rvc_enc_j(0, jimm);
+                break;
+            case 6:
+                id  = ENUM_RVC_BEQZ;
+                res = rvc_enc_b(0, RVC_REG3(c, 7), 0, bimm);
+                break;
+            default:
+                id  = ENUM_RVC_BNEZ;
+                res = rvc_enc_b(1, RVC_REG3(c, 7), 0, bimm);
+                break;
+        }
+    }
+    else
+    {
+        switch (f3)
+        {
+            case 0:
+                if (!(c & (1 << 12)))
+                {
+                    id  = ENUM_RVC_SLLI;
+                    res = rvc_enc_i(0x13, 1, rd, rd, rs2);
+                }
+                break;
+            case 2:
+                if (rd != 0)
+                {
+                    id  = ENUM_RVC_LWSP;
+                    res = rvc_enc_i(0x03, 2, rd, 2, RVC_BITS(c, 12, 12, 5) | RVC_BITS(c, 6, 4, 2) | RVC_BITS(c, 3, 2, 6));
+                }
+                break;
+            case 4:
+                if (!(c & (1 << 12)))
+                {
+                    if (rs2 == 0)
+                    {
+                        if (rd != 0)
+                        {
+                            id  = ENUM_RVC_JR;
+                            res = rvc_enc_i(0x67, 0, 0, rd, 0);
+                        }
+                    }
+                    else
+                    {
+                        id  = ENUM_RVC_MV;
+                        res = rvc_enc_r(0x33, 0, 0, rd, 0, rs2);
+                    }
+                }
+                else if (rs2 == 0)
+                {
+                    id  = rd ? ENUM_RVC_JALR : ENUM_RVC_EBREAK;
+                    res = rd ? rvc_enc_i(0x67, 0, 1, rd, 0) : INST_EBREAK;
+                }
+                else
+                {
+                    id  = ENUM_RVC_ADD;
+                    res = rvc_enc_r(0x33, 0, 0, rd, rd, rs2);
+                }
+                break;
+            case 6:
+                id  = ENUM_RVC_SWSP;
+                res = rvc_enc_s(0x23, 2, 2, rs2, RVC_BITS(c, 12, 9, 2) | RVC_BITS(c, 8, 7, 6));
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (rvc_id)
+        *rvc_id = res ? id : ENUM_RVC_NONE;
+    return res;
+}
+
+//--------------------------------------------------------------------
+// Known expansions of every supported encoding and of reserved ones,
+// checked when the tables are compiled
+//--------------------------------------------------------------------
+typedef struct
+{
+    uint16_t c;
+    uint32_t expanded;
+    uint8_t  id;
+} riscv_rvc_check;
+
+static constexpr riscv_rvc_check riscv_rvc_checks[] =
+{
+    { 0x0808, 0x01010513, ENUM_RVC_ADDI4SPN },  // addi a0, sp, 16
+    { 0x41c8, 0x0045a503, ENUM_RVC_LW },        // lw a0, 4(a1)
+    { 0xc1c8, 0x00a5a223, ENUM_RVC_SW },        // sw a0, 4(a1)
+    { 0x0001, 0x00000013, ENUM_RVC_NOP },       // addi x0, x0, 0
+    { 0x0505, 0x00150513, ENUM_RVC_ADDI },      // addi a0, a0, 1
+    { 0x2011, 0x004000ef, ENUM_RVC_JAL },       // jal ra, 4
+    { 0x4505, 0x00100513, ENUM_RVC_LI },        // addi a0, x0, 1
+    { 0x717d, 0xff010113, ENUM_RVC_ADDI16SP },  // addi sp, sp, -16
+    { 0x6505, 0x00001537, ENUM_RVC_LUI },       // lui a0, 1
+    { 0x8105, 0x00155513, ENUM_RVC_SRLI },      // srli a0, a0, 1
+    { 0x8505, 0x40155513, ENUM_RVC_SRAI },      // srai a0, a0, 1
+    { 0x8905, 0x00157513, ENUM_RVC_ANDI },      // andi a0, a0, 1
+    { 0x8d0d, 0x40b50533, ENUM_RVC_SUB },       // sub a0, a0, a1
+    { 0x8d2d, 0x00b54533, ENUM_RVC_XOR },       // xor a0, a0, a1
+    { 0x8d4d, 0x00b56533, ENUM_RVC_OR },        // or a0, a0, a1
+    { 0x8d6d, 0x00b57533, ENUM_RVC_AND },       // and a0, a0, a1
+    { 0xa011, 0x0040006f, ENUM_RVC_J },         // jal x0, 4
+    { 0xc111, 0x00050263, ENUM_RVC_BEQZ },      // beq a0, x0, 4
+    { 0xe111, 0x00051263, ENUM_RVC_BNEZ },      // bne a0, x0, 4
+    { 0x0506, 0x00151513, ENUM_RVC_SLLI },      // slli a0, a0, 1
+    { 0x4512, 0x00412503, ENUM_RVC_LWSP },      // lw a0, 4(sp)
+    { 0x8082, 0x00008067, ENUM_RVC_JR },        // jalr x0, 0(ra)
+    { 0x852e, 0x00b00533, ENUM_RVC_MV },        // add a0, x0, a1
+    { 0x9002, 0x00100073, ENUM_RVC_EBREAK },    // ebreak
+    { 0x9502, 0x000500e7, ENUM_RVC_JALR },      // jalr ra, 0(a0)
+    { 0x952e, 0x00b50533, ENUM_RVC_ADD },       // add a0, a0, a1
+    { 0xc22a, 0x00a12223, ENUM_RVC_SWSP },      // sw a0, 4(sp)
+    // Reserved or not supported
+    { 0x0000, 0, ENUM_RVC_NONE },               // all zeros
+    { 0x0008, 0, ENUM_RVC_NONE },               // c.addi4spn, imm 0
+    { 0x2000, 0, ENUM_RVC_NONE },               // c.fld
+    { 0x6101, 0, ENUM_RVC_NONE },               // c.addi16sp, imm 0
+    { 0x6501, 0, ENUM_RVC_NONE },               // c.lui, imm 0
+    { 0x9105, 0, ENUM_RVC_NONE },               // c.srli, shamt[5] set
+    { 0x9d0d, 0, ENUM_RVC_NONE },               // c.subw (RV64)
+    { 0x1506, 0, ENUM_RVC_NONE },               // c.slli, shamt[5] set
+    { 0x4002, 0, ENUM_RVC_NONE },               // c.lwsp, rd 0
+    { 0x8002, 0, ENUM_RVC_NONE },               // c.jr, rs1 0
+};
+
+static constexpr bool riscv_rvc_check_all(void)
+{
+    for (uint32_t i = 0; i < sizeof(riscv_rvc_checks) / sizeof(riscv_rvc_checks[0]); i++)
+    {
+        int id = ENUM_RVC_MAX;
+        if (riscv_rvc_expand(riscv_rvc_checks[i].c, &id) != riscv_rvc_checks[i].expanded ||
+            id != riscv_rvc_checks[i].id)
+            return false;
+    }
+    return true;
+}
+
+static_assert(riscv_rvc_check_all(), "RVC expansion doesn't match riscv_rvc_checks");
+
+// Every supported encoding is listed above
+static constexpr bool riscv_rvc_check_covered(void)
+{
+    for (int id = ENUM_RVC_NONE + 1; id < ENUM_RVC_MAX; id++)
+    {
+        bool found = false;
+        for (uint32_t i = 0; i < sizeof(riscv_rvc_checks) / sizeof(riscv_rvc_checks[0]); i++)
+            found = found || riscv_rvc_checks[i].id == id;
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+static_assert(riscv_rvc_check_covered(), "RVC encoding missing from riscv_rvc_checks");
+
+#endif
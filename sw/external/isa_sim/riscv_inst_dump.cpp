@@ -37,328 +37,264 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
 // SUCH DAMAGE.
-//-----------------------------------------------------------------
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include "riscv_isa.h"
+#include "riscv_decode.h"
 #include "riscv_inst_dump.h"
 
 //-----------------------------------------------------------------
-// riscv_inst_decode: Instruction decode to string
+// Operand formats of the disassembly
 //-----------------------------------------------------------------
-bool riscv_inst_decode(char *str, uint32_t pc, uint32_t opcode)
+enum eDumpFmt
 {
-    // Extract registers
-    int rd          = (opcode & OPCODE_RD_MASK)  >> OPCODE_RD_SHIFT;
-    int rs1         = (opcode & OPCODE_RS1_MASK) >> OPCODE_RS1_SHIFT;
-    int rs2         = (opcode & OPCODE_RS2_MASK) >> OPCODE_RS2_SHIFT;
-
-    // Extract immediates
-    int typei_imm   = ((signed)(opcode & OPCODE_TYPEI_IMM_MASK)) >> OPCODE_TYPEI_IMM_SHIFT;
-    int typeu_imm   = ((signed)(opcode & OPCODE_TYPEU_IMM_MASK)) >> OPCODE_TYPEU_IMM_SHIFT;
-    int imm20       = typeu_imm << OPCODE_TYPEU_IMM_SHIFT;
-    int imm12       = typei_imm;
-    int bimm        = OPCODE_SBTYPE_IMM(opcode);
-    int jimm20      = OPCODE_UJTYPE_IMM(opcode);
-    int storeimm    = OPCODE_STYPE_IMM(opcode);
-    int shamt       = ((signed)(opcode & OPCODE_SHAMT_MASK)) >> OPCODE_SHAMT_SHIFT;
+    DUMP_NONE,
+    // rd, rs1, rs2
+    DUMP_R,
+    // rd, rs1, imm
+    DUMP_I,
+    // rd, 0ximm (upper immediate)
+    DUMP_U,
+    // rd, offset
+    DUMP_J,
+    // rs1, rs2, offset
+    DUMP_B,
+    // rd, imm(rs1)
+    DUMP_LOAD,
+    // imm(rs1), rs2
+    DUMP_STORE,
+    // rd, rs1, 0xcsr
+    DUMP_CSR,
+    // rd, zimm, 0xcsr
+    DUMP_CSRI
+};
 
-    if ((opcode & INST_ANDI_MASK) == INST_ANDI)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: andi r%d, r%d, %d", pc, rd, rs1, imm12);     
-    }
-    else if ((opcode & INST_ORI_MASK) == INST_ORI)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: ori r%d, r%d, %d", pc, rd, rs1, imm12);
-    }
-    else if ((opcode & INST_XORI_MASK) == INST_XORI)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: xori r%d, r%d, %d", pc, rd, rs1, imm12);
-    }
-    else if ((opcode & INST_ADDI_MASK) == INST_ADDI)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: addi r%d, r%d, %d", pc, rd, rs1, imm12);
-    }
-    else if ((opcode & INST_SLTI_MASK) == INST_SLTI)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: slti r%d, r%d, %d", pc, rd, rs1, imm12);
-    }
-    else if ((opcode & INST_SLTIU_MASK) == INST_SLTIU)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: sltiu r%d, r%d, %d", pc, rd, rs1, (unsigned)imm12);
-    }
-    else if ((opcode & INST_SLLI_MASK) == INST_SLLI)
-    {
-        // ['rd', 'rs1']
-        sprintf(str, "%08x: slli r%d, r%d, %d", pc, rd, rs1, shamt);
-    }
-    else if ((opcode & INST_SRLI_MASK) == INST_SRLI)
-    {
-        // ['rd', 'rs1', 'shamt']
-        sprintf(str, "%08x: srli r%d, r%d, %d", pc, rd, rs1, shamt);
-    }
-    else if ((opcode & INST_SRAI_MASK) == INST_SRAI)
-    {
-        // ['rd', 'rs1', 'shamt']
-        sprintf(str, "%08x: srai r%d, r%d, %d", pc, rd, rs1, shamt);
-    }
-    else if ((opcode & INST_LUI_MASK) == INST_LUI)
-    {
-        // ['rd', 'imm20']
-        sprintf(str, "%08x: lui r%d, 0x%x", pc, rd, imm20);
-    }
-    else if ((opcode & INST_AUIPC_MASK) == INST_AUIPC)
-    {
-        // ['rd', 'imm20']
-        sprintf(str, "%08x: auipc r%d, 0x%x", pc, rd, imm20);
-    }
-    else if ((opcode & INST_ADD_MASK) == INST_ADD)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: add r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_SUB_MASK) == INST_SUB)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: sub r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_SLT_MASK) == INST_SLT)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: slt r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_SLTU_MASK) == INST_SLTU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: sltu r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_XOR_MASK) == INST_XOR)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: xor r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_OR_MASK) == INST_OR)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: or r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_AND_MASK) == INST_AND)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: and r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_SLL_MASK) == INST_SLL)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: sll r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_SRL_MASK) == INST_SRL)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: srl r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_SRA_MASK) == INST_SRA)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: sra r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_JAL_MASK) == INST_JAL)
-    {
-        // ['rd', 'jimm20']
-        sprintf(str, "%08x: jal r%d, %d", pc, rd, jimm20);
-    }
-    else if ((opcode & INST_JALR_MASK) == INST_JALR)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: jalr r%d, r%d, %d", pc, rd, rs1, imm12);
-    }
-    else if ((opcode & INST_BEQ_MASK) == INST_BEQ)
-    {
-        // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        sprintf(str, "%08x: beq r%d, r%d, %d", pc, rs1, rs2, bimm);
-    }
-    else if ((opcode & INST_BNE_MASK) == INST_BNE)
-    {
-        // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        sprintf(str, "%08x: bne r%d, r%d, %d", pc, rs1, rs2, bimm);  
-    }
-    else if ((opcode & INST_BLT_MASK) == INST_BLT)
-    {
-        // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        sprintf(str, "%08x: blt r%d, r%d, %d", pc, rs1, rs2, bimm);
-    }
-    else if ((opcode & INST_BGE_MASK) == INST_BGE)
-    {
-        // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        sprintf(str, "%08x: bge r%d, r%d, %d", pc, rs1, rs2, bimm);
-    }
-    else if ((opcode & INST_BLTU_MASK) == INST_BLTU)
-    {
-        // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        sprintf(str, "%08x: bltu r%d, r%d, %d", pc, rs1, rs2, bimm);
-    }
-    else if ((opcode & INST_BGEU_MASK) == INST_BGEU)
-    {
-        // ['bimm12hi', 'rs1', 'rs2', 'bimm12lo']
-        sprintf(str, "%08x: bgeu r%d, r%d, %d", pc, rs1, rs2, bimm);
-    }
-    else if ((opcode & INST_LB_MASK) == INST_LB)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: lb r%d, %d(r%d)", pc, rd, imm12, rs1);
-    }
-    else if ((opcode & INST_LH_MASK) == INST_LH)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: lh r%d, %d(r%d)", pc, rd, imm12, rs1);
-    }
-    else if ((opcode & INST_LW_MASK) == INST_LW)
-    {
-        // ['rd', 'rs1', 'imm12']        
-        sprintf(str, "%08x: lw r%d, %d(r%d)", pc, rd, imm12, rs1);
-    }
-    else if ((opcode & INST_LBU_MASK) == INST_LBU)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: lbu r%d, %d(r%d)", pc, rd, imm12, rs1);
-    }
-    else if ((opcode & INST_LHU_MASK) == INST_LHU)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: lhu r%d, %d(r%d)", pc, rd, imm12, rs1);
-    }
-    else if ((opcode & INST_LWU_MASK) == INST_LWU)
-    {
-        // ['rd', 'rs1', 'imm12']
-        sprintf(str, "%08x: lwu r%d, %d(r%d)", pc, rd, imm12, rs1);
-    }
-    else if ((opcode & INST_SB_MASK) == INST_SB)
-    {
-        // ['imm12hi', 'rs1', 'rs2', 'imm12lo']
-        sprintf(str, "%08x: sb %d(r%d), r%d", pc, storeimm, rs1, rs2);
-    }
-    else if ((opcode & INST_SH_MASK) == INST_SH)
-    {
-        // ['imm12hi', 'rs1', 'rs2', 'imm12lo']
-        sprintf(str, "%08x: sh %d(r%d), r%d", pc, storeimm, rs1, rs2);
-    }
-    else if ((opcode & INST_SW_MASK) == INST_SW)
-    {
-        // ['imm12hi', 'rs1', 'rs2', 'imm12lo']
-        sprintf(str, "%08x: sw %d(r%d), r%d", pc, storeimm, rs1, rs2);
-    }
-    else if ((opcode & INST_MUL_MASK) == INST_MUL)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: mul r%d, r%d, r%d", pc, rd, rs1, rs2);   
-    }
-    else if ((opcode & INST_MULH_MASK) == INST_MULH)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: mulh r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_MULHSU_MASK) == INST_MULHSU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: mulhsu r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_MULHU_MASK) == INST_MULHU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: mulhu r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_DIV_MASK) == INST_DIV)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: div r%d, r%d, r%d", pc, rd, rs1, rs2);     
-    }
-    else if ((opcode & INST_DIVU_MASK) == INST_DIVU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: divu r%d, r%d, r%d", pc, rd, rs1, rs2); 
-    }
-    else if ((opcode & INST_REM_MASK) == INST_REM)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: rem r%d, r%d, r%d", pc, rd, rs1, rs2);
-    }
-    else if ((opcode & INST_REMU_MASK) == INST_REMU)
-    {
-        // ['rd', 'rs1', 'rs2']
-        sprintf(str, "%08x: remu r%d, r%d, r%d", pc, rd, rs1, rs2);    
-    }
-    else if ((opcode & INST_ECALL_MASK) == INST_ECALL)
-    {
-        sprintf(str, "%08x: ecall", pc);
-    }
-    else if ((opcode & INST_EBREAK_MASK) == INST_EBREAK)
-    {
-        sprintf(str, "%08x: ebreak", pc);
-    }
-    else if ((opcode & INST_MRET_MASK) == INST_MRET)
-    {
-        sprintf(str, "%08x: mret", pc);
-    }
-    else if ((opcode & INST_SRET_MASK) == INST_SRET)
-    {
-        sprintf(str, "%08x: sret", pc);
-    }
-    else if ( ((opcode & INST_SFENCE_MASK) == INST_SFENCE) ||
-              ((opcode & INST_FENCE_MASK) == INST_FENCE) ||
-              ((opcode & INST_IFENCE_MASK) == INST_IFENCE))
-    {
-        sprintf(str, "%08x: sfence", pc);
-    }
-    else if ((opcode & INST_CSRRW_MASK) == INST_CSRRW)
-    {
-        sprintf(str, "%08x: csrw r%d, r%d, 0x%x", pc, rd, rs1, imm12);
-    }    
-    else if ((opcode & INST_CSRRS_MASK) == INST_CSRRS)
-    {
-        sprintf(str, "%08x: csrs r%d, r%d, 0x%x", pc, rd, rs1, imm12);
-    }
-    else if ((opcode & INST_CSRRC_MASK) == INST_CSRRC)
-    {
-        sprintf(str, "%08x: csrc r%d, r%d, 0x%x", pc, rd, rs1, imm12);
-    }
-    else if ((opcode & INST_CSRRWI_MASK) == INST_CSRRWI)
-    {
-        sprintf(str, "%08x: csrwi r%d, %d, 0x%x", pc, rd, rs1, imm12);
-    }
-    else if ((opcode & INST_CSRRSI_MASK) == INST_CSRRSI)
-    {
-        sprintf(str, "%08x: csrsi r%d, %d, 0x%x", pc, rd, rs1, imm12);
+static constexpr uint8_t dump_fmt(int id)
+{
+    switch (id)
+    {
+        case ENUM_INST_ANDI: case ENUM_INST_ADDI: case ENUM_INST_SLTI: case ENUM_INST_SLTIU:
+        case ENUM_INST_ORI: case ENUM_INST_XORI: case ENUM_INST_SLLI: case ENUM_INST_SRLI:
+        case ENUM_INST_SRAI: case ENUM_INST_JALR:
+            return DUMP_I;
+        case ENUM_INST_LUI: case ENUM_INST_AUIPC:
+            return DUMP_U;
+        case ENUM_INST_JAL:
+            return DUMP_J;
+        case ENUM_INST_BEQ: case ENUM_INST_BNE: case ENUM_INST_BLT: case ENUM_INST_BGE:
+        case ENUM_INST_BLTU: case ENUM_INST_BGEU:
+            return DUMP_B;
+        case ENUM_INST_LB: case ENUM_INST_LH: case ENUM_INST_LW: case ENUM_INST_LBU:
+        case ENUM_INST_LHU: case ENUM_INST_LWU:
+            return DUMP_LOAD;
+        case ENUM_INST_SB: case ENUM_INST_SH: case ENUM_INST_SW:
+            return DUMP_STORE;
+        case ENUM_INST_CSRRW: case ENUM_INST_CSRRS: case ENUM_INST_CSRRC:
+            return DUMP_CSR;
+        case ENUM_INST_CSRRWI: case ENUM_INST_CSRRSI: case ENUM_INST_CSRRCI:
+            return DUMP_CSRI;
+        case ENUM_INST_ECALL: case ENUM_INST_EBREAK: case ENUM_INST_MRET: case ENUM_INST_SRET:
+        case ENUM_INST_FENCE: case ENUM_INST_WFI:
+            return DUMP_NONE;
+        default:
+            return DUMP_R;
     }
-    else if ((opcode & INST_CSRRCI_MASK) == INST_CSRRCI)
+}
+
+static const char *rvc_names[ENUM_RVC_MAX] =
+{
+    "", "c.addi4spn", "c.lw", "c.sw", "c.nop", "c.addi", "c.jal", "c.li", "c.addi16sp",
+    "c.lui", "c.srli", "c.srai", "c.andi", "c.sub", "c.xor", "c.or", "c.and", "c.j",
+    "c.beqz", "c.bnez", "c.slli", "c.lwsp", "c.jr", "c.mv", "c.ebreak", "c.jalr", "c.add",
+    "c.swsp"
+};
+
+//-----------------------------------------------------------------
+// Output buffer, writes past the end are dropped
+//-----------------------------------------------------------------
+typedef struct
+{
+    char *p;
+    char *end;
+} dump_buf;
+
+static inline void put_char(dump_buf *b, char c)
+{
+    if (b->p < b->end)
+        *b->p++ = c;
+}
+
+static inline void put_str(dump_buf *b, const char *s)
+{
+    while (*s)
+        put_char(b, *s++);
+}
+
+// Hex without leading zeros unless digits is given
+static void put_hex(dump_buf *b, uint32_t v, int digits)
+{
+    static const char hex[] = "0123456789abcdef";
+    char tmp[8];
+    int  n = 0;
+    do
+    {
+        tmp[n++] = hex[v & 0xf];
+        v >>= 4;
+    }
+    while (v && n < 8);
+    while (n < digits)
+        tmp[n++] = '0';
+    while (n)
+        put_char(b, tmp[--n]);
+}
+
+static void put_dec(dump_buf *b, int32_t v)
+{
+    char     tmp[10];
+    int      n = 0;
+    uint32_t u = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+    if (v < 0)
+        put_char(b, '-');
+    do
+    {
+        tmp[n++] = '0' + (u % 10);
+        u /= 10;
+    }
+    while (u);
+    while (n)
+        put_char(b, tmp[--n]);
+}
+
+static inline void put_reg(dump_buf *b, int r)
+{
+    put_char(b, 'r');
+    put_dec(b, r);
+}
+
+static inline void put_sep(dump_buf *b)
+{
+    put_str(b, ", ");
+}
+
+//-----------------------------------------------------------------
+// riscv_inst_decode: Instruction decode to string, 16-bit opcodes
+// (low bits != 11) are shown as their 32-bit equivalent
+//-----------------------------------------------------------------
+bool riscv_inst_decode(char *str, size_t size, uint32_t pc, uint32_t opcode)
+{
+    if (size == 0)
+        return false;
+
+    dump_buf b = { str, str + size - 1 };
+    int rvc = ENUM_RVC_NONE;
+    riscv_decoded inst;
+
+    if ((opcode & 3) != 3)
+        opcode = riscv_rvc_expand(opcode, &rvc);
+    riscv_decode(opcode, &inst);
+
+    put_hex(&b, pc, 8);
+    put_str(&b, ": ");
+
+    if (inst.id >= ENUM_INST_MAX)
     {
-        sprintf(str, "%08x: csrci r%d, %d, 0x%x", pc, rd, rs1, imm12);
+        put_str(&b, "invalid!");
+        *b.p = 0;
+        return false;
     }
-    else if ((opcode & INST_WFI_MASK) == INST_WFI)
-    {
-        sprintf(str, "%08x: wfi", pc);
+
+    // Entries sharing a handler (fence, fence.i, sfence.vma) carry their own name
+    const char *name = riscv_decode_table[riscv_decode_match(opcode)].name;
+    put_str(&b, name ? name : inst_names[inst.id]);
+    switch (dump_fmt(inst.id))
+    {
+        case DUMP_R:
+            put_char(&b, ' ');
+            put_reg(&b, inst.rd);  put_sep(&b);
+            put_reg(&b, inst.rs1); put_sep(&b);
+            put_reg(&b, inst.rs2);
+            break;
+        case DUMP_I:
+            put_char(&b, ' ');
+            put_reg(&b, inst.rd);  put_sep(&b);
+            put_reg(&b, inst.rs1); put_sep(&b);
+            put_dec(&b, inst.imm);
+            break;
+        case DUMP_U:
+            put_char(&b, ' ');
+            put_reg(&b, inst.rd);  put_sep(&b);
+            put_str(&b, "0x");
+            put_hex(&b, (uint32_t)inst.imm, 0);
+            break;
+        case DUMP_J:
+            put_char(&b, ' ');
+            put_reg(&b, inst.rd);  put_sep(&b);
+            put_dec(&b, inst.imm);
+            break;
+        case DUMP_B:
+            put_char(&b, ' ');
+            put_reg(&b, inst.rs1); put_sep(&b);
+            put_reg(&b, inst.rs2); put_sep(&b);
+            put_dec(&b, inst.imm);
+            break;
+        case DUMP_LOAD:
+            put_char(&b, ' ');
+            put_reg(&b, inst.rd);  put_sep(&b);
+            put_dec(&b, inst.imm);
+            put_char(&b, '(');
+            put_reg(&b, inst.rs1);
+            put_char(&b, ')');
+            break;
+        case DUMP_STORE:
+            put_char(&b, ' ');
+            put_dec(&b, inst.imm);
+            put_char(&b, '(');
+            put_reg(&b, inst.rs1);
+            put_char(&b, ')');
+            put_sep(&b);
+            put_reg(&b, inst.rs2);
+            break;
+        case DUMP_CSR:
+        case DUMP_CSRI:
+            put_char(&b, ' ');
+            put_reg(&b, inst.rd);  put_sep(&b);
+            if (dump_fmt(inst.id) == DUMP_CSR)
+                put_reg(&b, inst.rs1);
+            else
+                put_dec(&b, inst.rs1);
+            put_sep(&b);
+            put_str(&b, "0x");
+            put_hex(&b, (uint32_t)inst.imm & 0xfff, 0);
+            break;
+        default:
+            break;
     }
-    else
+
+    if (rvc != ENUM_RVC_NONE)
     {
-        sprintf(str, "%08x: invalid!", pc);
-        return false;
+        put_str(&b, " (");
+        put_str(&b, rvc_names[rvc]);
+        put_char(&b, ')');
     }
 
-   return true;
+    *b.p = 0;
+    return true;
+}
+//-----------------------------------------------------------------
+// riscv_inst_decode: Decode into a buffer of RISCV_INST_STR_MAX bytes
+//-----------------------------------------------------------------
+bool riscv_inst_decode(char *str, uint32_t pc, uint32_t opcode)
+{
+    return riscv_inst_decode(str, RISCV_INST_STR_MAX, pc, opcode);
 }
 //-----------------------------------------------------------------
 // riscv_inst_print: Instruction decode to string
 //-----------------------------------------------------------------
 void riscv_inst_print(uint32_t pc, uint32_t opcode)
 {
-    char str[1024];
-    riscv_inst_decode(str, pc, opcode);
-    printf("%s\n", str);
+    char str[RISCV_INST_STR_MAX];
+    riscv_inst_decode(str, sizeof(str), pc, opcode);
+    puts(str);
 }
@@ -42,10 +42,19 @@
 #define __RISCV_INST_DUMP_H__
 
 #include <stdint.h>
+#include <stddef.h>
+
+//--------------------------------------------------------------------
+// Defines:
+//--------------------------------------------------------------------
+// Longest disassembly incl. terminator
+#define RISCV_INST_STR_MAX  64
 
 //--------------------------------------------------------------------
 // Prototypes:
 //--------------------------------------------------------------------
+// Output is truncated to size - 1 characters, returns false if invalid
+bool riscv_inst_decode(char *str, size_t size, uint32_t pc, uint32_t opcode);
 bool riscv_inst_decode(char *str, uint32_t pc, uint32_t opcode);
 void riscv_inst_print(uint32_t pc, uint32_t opcode);
 
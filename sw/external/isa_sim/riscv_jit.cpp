@@ -0,0 +1,819 @@
+//-----------------------------------------------------------------
+//                     RISC-V ISA Simulator
+//                   x86-64 block translator
+//-----------------------------------------------------------------
+//
+// Straight-line runs of RV32IM instructions which executed
+// JIT_HOT_THRESHOLD times are translated to x86-64 code. Architectural
+// registers stay in Riscv::m_gpr, loads and stores call back into the
+// model so MMU, TLB, devices and stats behave as when interpreting.
+// Anything touching CSRs, privilege or traps ends a block and is left
+// to Riscv::step().
+//
+// Register usage of translated code:
+//   rbp = riscv_jit_ctx, rbx = m_gpr, r12 = Riscv
+//   eax, ecx, edx, esi, edi, r8d are scratch
+//
+//-----------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include "riscv_jit.h"
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+
+typedef uint32_t (*jit_entry_fn)(riscv_jit_ctx *ctx, uint32_t *gpr, Riscv *cpu, uint8_t *code);
+
+// Classification of instructions
+#define JIT_INSN_NONE       0
+#define JIT_INSN_NORMAL     1
+#define JIT_INSN_END        2
+
+// x86 condition codes
+#define X86_CC_B            0x2
+#define X86_CC_AE           0x3
+#define X86_CC_E            0x4
+#define X86_CC_NE           0x5
+#define X86_CC_L            0xC
+#define X86_CC_GE           0xD
+
+// x86 registers
+#define X86_EAX             0
+#define X86_ECX             1
+#define X86_EDX             2
+#define X86_ESI             6
+
+#define CTX_OFFSET(f)       offsetof(riscv_jit_ctx, f)
+
+//-----------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------
+RiscvJit::RiscvJit(Riscv *cpu)
+{
+    m_cpu               = cpu;
+    m_flush_pending     = false;
+    m_blocks_translated = 0;
+    m_insns_translated  = 0;
+    memset(&m_ctx, 0, sizeof(m_ctx));
+
+    m_code = (uint8_t *)mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m_code == MAP_FAILED)
+    {
+        m_code = NULL;
+        return ;
+    }
+
+    m_emit = m_code;
+
+    // push rbx; push rbp; push r12
+    m_entry = m_emit;
+    emit8(0x53); emit8(0x55); emit8(0x41); emit8(0x54);
+    // mov rbp, rdi; mov rbx, rsi; mov r12, rdx
+    emit8(0x48); emit8(0x89); emit8(0xFD);
+    emit8(0x48); emit8(0x89); emit8(0xF3);
+    emit8(0x49); emit8(0x89); emit8(0xD4);
+    // jmp rcx
+    emit8(0xFF); emit8(0xE1);
+
+    // pop r12; pop rbp; pop rbx; ret (next pc in eax)
+    m_epilogue = m_emit;
+    emit8(0x41); emit8(0x5C); emit8(0x5D); emit8(0x5B); emit8(0xC3);
+
+    m_code_free = m_emit;
+}
+//-----------------------------------------------------------------
+// Destructor
+//-----------------------------------------------------------------
+RiscvJit::~RiscvJit()
+{
+    if (m_code)
+        munmap(m_code, JIT_CODE_SIZE);
+}
+//-----------------------------------------------------------------
+// flush: Drop all translations
+//-----------------------------------------------------------------
+void RiscvJit::flush(void)
+{
+    m_blocks.clear();
+    m_code_words.clear();
+    m_emit          = m_code_free;
+    m_flush_pending = false;
+}
+//-----------------------------------------------------------------
+// invalidate: Physical word written, leave translated code if it is ours
+//-----------------------------------------------------------------
+void RiscvJit::invalidate(uint32_t address)
+{
+    std::unordered_map<uint32_t, std::vector<uint64_t> >::iterator it = m_code_words.find(address >> TLB_PAGE_SHIFT);
+    if (it == m_code_words.end())
+        return ;
+
+    uint32_t w = (address & (TLB_PAGE_SIZE - 1)) >> 2;
+    if (it->second[w >> 6] & (1ULL << (w & 63)))
+    {
+        m_flush_pending = true;
+        m_ctx.exit_code = JIT_EXIT_CODE_WRITE;
+    }
+}
+//-----------------------------------------------------------------
+// can_translate: Model state allows running translated code
+//-----------------------------------------------------------------
+bool RiscvJit::can_translate(void)
+{
+    Riscv *cpu = m_cpu;
+
+    // Per instruction hooks need the interpreter
+    if (cpu->m_trace || cpu->m_stats_if || cpu->m_has_breakpoints)
+        return false;
+
+    if (cpu->event_enabled(COSIM_EVENT_RETIRE))
+        return false;
+
+    return !(cpu->m_pc & 3);
+}
+//-----------------------------------------------------------------
+// run: Execute up to max_steps instructions
+//-----------------------------------------------------------------
+uint64_t RiscvJit::run(uint64_t max_steps)
+{
+    Riscv *cpu = m_cpu;
+    uint64_t steps = 0;
+
+    while (steps < max_steps && !cpu->m_fault && !cpu->m_break)
+    {
+        if (m_flush_pending)
+            flush();
+
+        // Translated code must stop before the timer fires
+        uint64_t budget = max_steps - steps;
+        uint32_t timer  = (uint32_t)(cpu->m_csr_mtimecmp - cpu->m_csr_mtime);
+        if (!(cpu->m_csr_mtimecmp >> 32) && timer != 0 && budget > timer - 1)
+            budget = timer - 1;
+        if (budget > INT32_MAX)
+            budget = INT32_MAX;
+
+        riscv_jit_block *blk = NULL;
+        if (budget > 0 && can_translate() && !cpu->pending_interrupts())
+        {
+            uint32_t ppc = cpu->m_pc;
+            bool mapped  = true;
+#ifdef CONFIG_MMU
+            riscv_tlb_entry *tlb = cpu->tlb_lookup(cpu->m_itlb, cpu->m_pc, TLB_PERM_X);
+            if (tlb)
+                ppc = tlb->ppage | (cpu->m_pc & (TLB_PAGE_SIZE - 1));
+            else
+                mapped = false;
+#endif
+            if (mapped)
+                blk = lookup(cpu->m_pc, ppc);
+        }
+
+        uint64_t executed = 0;
+        if (blk && blk->n <= (int)budget)
+            executed = enter(blk, (int32_t)budget);
+
+        if (!executed)
+        {
+            cpu->step();
+            executed = 1;
+        }
+
+        steps += executed;
+    }
+
+    return steps;
+}
+//-----------------------------------------------------------------
+// lookup: Find translated block, translating it once it is hot
+//-----------------------------------------------------------------
+riscv_jit_block *RiscvJit::lookup(uint32_t vpc, uint32_t ppc)
+{
+    if (m_code + JIT_CODE_SIZE - m_emit < JIT_MAX_BLOCK_BYTES)
+        flush();
+
+    std::unordered_map<uint32_t, riscv_jit_block>::iterator it = m_blocks.find(vpc);
+    if (it == m_blocks.end())
+    {
+        riscv_jit_block blk;
+        blk.vpc    = vpc;
+        blk.ppc    = ppc;
+        blk.n      = 0;
+        blk.hits   = 0;
+        blk.code   = NULL;
+        blk.interp = false;
+        it = m_blocks.insert(std::make_pair(vpc, blk)).first;
+    }
+
+    riscv_jit_block *blk = &it->second;
+
+    // Virtual page now maps elsewhere, start over
+    if (blk->ppc != ppc)
+    {
+        blk->ppc    = ppc;
+        blk->n      = 0;
+        blk->hits   = 0;
+        blk->code   = NULL;
+        blk->interp = false;
+    }
+
+    if (blk->interp)
+        return NULL;
+
+    if (!blk->code)
+    {
+        if (++blk->hits < JIT_HOT_THRESHOLD)
+            return NULL;
+
+        if (!translate(blk))
+        {
+            blk->interp = true;
+            return NULL;
+        }
+    }
+
+    return blk;
+}
+//-----------------------------------------------------------------
+// classify: Can instruction be translated, does it end a block
+//-----------------------------------------------------------------
+int RiscvJit::classify(const riscv_decoded *inst)
+{
+    switch (inst->id)
+    {
+        case ENUM_INST_ANDI: case ENUM_INST_ADDI: case ENUM_INST_SLTI: case ENUM_INST_SLTIU:
+        case ENUM_INST_ORI:  case ENUM_INST_XORI: case ENUM_INST_SLLI: case ENUM_INST_SRLI:
+        case ENUM_INST_SRAI: case ENUM_INST_LUI:  case ENUM_INST_AUIPC:
+        case ENUM_INST_ADD:  case ENUM_INST_SUB:  case ENUM_INST_SLT:  case ENUM_INST_SLTU:
+        case ENUM_INST_XOR:  case ENUM_INST_OR:   case ENUM_INST_AND:
+        case ENUM_INST_SLL:  case ENUM_INST_SRL:  case ENUM_INST_SRA:
+        case ENUM_INST_LB:   case ENUM_INST_LH:   case ENUM_INST_LW:
+        case ENUM_INST_LBU:  case ENUM_INST_LHU:  case ENUM_INST_LWU:
+        case ENUM_INST_SB:   case ENUM_INST_SH:   case ENUM_INST_SW:
+        case ENUM_INST_MUL:  case ENUM_INST_MULH: case ENUM_INST_MULHSU: case ENUM_INST_MULHU:
+        case ENUM_INST_DIV:  case ENUM_INST_DIVU: case ENUM_INST_REM:    case ENUM_INST_REMU:
+        case ENUM_INST_WFI:
+            return JIT_INSN_NORMAL;
+        case ENUM_INST_JAL:  case ENUM_INST_JALR:
+        case ENUM_INST_BEQ:  case ENUM_INST_BNE:  case ENUM_INST_BLT:
+        case ENUM_INST_BGE:  case ENUM_INST_BLTU: case ENUM_INST_BGEU:
+            return JIT_INSN_END;
+        case ENUM_INST_FENCE:
+            // Plain fence is a nop, sfence.vma and fence.i flush model state
+            if ((inst->opcode & INST_SFENCE_MASK) == INST_SFENCE ||
+                (inst->opcode & INST_IFENCE_MASK) == INST_IFENCE)
+                return JIT_INSN_NONE;
+            return JIT_INSN_NORMAL;
+        default:
+            return JIT_INSN_NONE;
+    }
+}
+//-----------------------------------------------------------------
+// translate: Emit host code for block starting at blk->ppc
+//-----------------------------------------------------------------
+bool RiscvJit::translate(riscv_jit_block *blk)
+{
+    riscv_decoded insts[JIT_MAX_BLOCK_INSNS];
+    int n = 0;
+
+    // Block ends after a control transfer, before anything which can't
+    // be translated and never crosses a page
+    while (n < JIT_MAX_BLOCK_INSNS)
+    {
+        uint32_t ppc = blk->ppc + 4 * n;
+
+        insts[n] = *m_cpu->dcache_lookup(ppc);
+        int cls = classify(&insts[n]);
+        if (cls == JIT_INSN_NONE)
+            break;
+
+        n++;
+        if (cls == JIT_INSN_END || !((ppc + 4) & (TLB_PAGE_SIZE - 1)))
+            break;
+    }
+
+    if (n == 0)
+        return false;
+
+    blk->n    = n;
+    blk->code = m_emit;
+
+    emit_prologue(blk);
+
+    for (int i=0;i<n;i++)
+        emit_insn(blk->vpc + 4 * i, &insts[i]);
+
+    // Fell through to the next instruction
+    if (classify(&insts[n-1]) != JIT_INSN_END)
+        emit_exit(blk->vpc + 4 * (n - 1), blk->vpc + 4 * n);
+
+    // Remember which words were translated for invalidation
+    std::vector<uint64_t> &words = m_code_words[blk->ppc >> TLB_PAGE_SHIFT];
+    if (words.empty())
+        words.assign((TLB_PAGE_SIZE / 4) / 64, 0);
+
+    for (int i=0;i<n;i++)
+    {
+        uint32_t w = ((blk->ppc + 4 * i) & (TLB_PAGE_SIZE - 1)) >> 2;
+        words[w >> 6] |= 1ULL << (w & 63);
+    }
+
+    m_blocks_translated++;
+    m_insns_translated += n;
+    return true;
+}
+//-----------------------------------------------------------------
+// enter: Run translated code, returns number of instructions executed
+//-----------------------------------------------------------------
+uint64_t RiscvJit::enter(riscv_jit_block *blk, int32_t budget)
+{
+    Riscv *cpu = m_cpu;
+
+    m_ctx.budget    = budget;
+    m_ctx.cur_pc    = blk->vpc;
+    m_ctx.cur_n     = 0;
+    m_ctx.exit_code = JIT_EXIT_NONE;
+    m_ctx.exit_pc   = 0;
+    m_ctx.branches  = 0;
+    m_ctx.last_exit = NULL;
+
+    uint32_t next = ((jit_entry_fn)m_entry)(&m_ctx, cpu->m_gpr, cpu, blk->code);
+
+    // Whole blocks are charged on entry
+    uint64_t executed = (uint64_t)(budget - m_ctx.budget);
+
+    if (m_ctx.exit_code != JIT_EXIT_NONE)
+    {
+        // Instruction which left the block early still counts as a step
+        executed -= m_ctx.cur_n - ((m_ctx.exit_pc - m_ctx.cur_pc) / 4 + 1);
+
+        cpu->m_pc_x = m_ctx.exit_pc;
+
+        // On exception the model already set the pc to the trap vector
+        if (m_ctx.exit_code != JIT_EXIT_EXCEPTION)
+            cpu->m_pc = m_ctx.exit_pc + 4;
+    }
+    else if (executed)
+    {
+        cpu->m_pc_x = m_ctx.cur_pc + 4 * (m_ctx.cur_n - 1);
+        cpu->m_pc   = next;
+    }
+
+    cpu->m_stats[STATS_INSTRUCTIONS] += executed;
+    cpu->m_stats[STATS_BRANCHES]     += m_ctx.branches;
+
+    cpu->m_csr_mtime += executed;
+    cpu->m_csr_mtime &= 0xFFFFFFFF;
+
+    if (m_ctx.exit_code == JIT_EXIT_NONE && m_ctx.last_exit && !m_flush_pending)
+        chain(m_ctx.last_exit, next);
+
+    return executed;
+}
+//-----------------------------------------------------------------
+// chain: Point exit of a block directly at translated target
+//-----------------------------------------------------------------
+void RiscvJit::chain(uint8_t *exit, uint32_t vpc)
+{
+    std::unordered_map<uint32_t, riscv_jit_block>::iterator it = m_blocks.find(vpc);
+    if (it == m_blocks.end() || !it->second.code)
+        return ;
+
+    uint32_t ppc = vpc;
+#ifdef CONFIG_MMU
+    riscv_tlb_entry *tlb = m_cpu->tlb_lookup(m_cpu->m_itlb, vpc, TLB_PERM_X);
+    if (!tlb)
+        return ;
+    ppc = tlb->ppage | (vpc & (TLB_PAGE_SIZE - 1));
+#endif
+
+    if (it->second.ppc == ppc)
+        patch(exit, it->second.code);
+}
+//-----------------------------------------------------------------
+// Code emission
+//-----------------------------------------------------------------
+void RiscvJit::emit32(uint32_t v)
+{
+    memcpy(m_emit, &v, 4);
+    m_emit += 4;
+}
+void RiscvJit::emit64(uint64_t v)
+{
+    memcpy(m_emit, &v, 8);
+    m_emit += 8;
+}
+void RiscvJit::patch(uint8_t *rel, uint8_t *target)
+{
+    int32_t disp = (int32_t)(target - (rel + 4));
+    memcpy(rel, &disp, 4);
+}
+uint8_t *RiscvJit::emit_jmp(uint8_t op, uint8_t *target)
+{
+    emit8(op);
+    uint8_t *rel = m_emit;
+    emit32(0);
+    if (target)
+        patch(rel, target);
+    return rel;
+}
+uint8_t *RiscvJit::emit_jcc(uint8_t cc, uint8_t *target)
+{
+    emit8(0x0F);
+    return emit_jmp(0x80 | cc, target);
+}
+//-----------------------------------------------------------------
+// emit_load_reg: mov host, [rbx + r*4]
+//-----------------------------------------------------------------
+void RiscvJit::emit_load_reg(int host, int r)
+{
+    if (r == 0)
+    {
+        // xor host, host
+        emit8(0x31); emit8(0xC0 | (host << 3) | host);
+        return ;
+    }
+
+    emit8(0x8B); emit8(0x40 | (host << 3) | 3); emit8(r * 4);
+}
+//-----------------------------------------------------------------
+// emit_store_reg: mov [rbx + r*4], eax
+//-----------------------------------------------------------------
+void RiscvJit::emit_store_reg(int r)
+{
+    if (r == 0)
+        return ;
+
+    emit8(0x89); emit8(0x43); emit8(r * 4);
+}
+//-----------------------------------------------------------------
+// emit_set_reg: mov dword [rbx + r*4], value
+//-----------------------------------------------------------------
+void RiscvJit::emit_set_reg(int r, uint32_t value)
+{
+    if (r == 0)
+        return ;
+
+    emit8(0xC7); emit8(0x43); emit8(r * 4); emit32(value);
+}
+//-----------------------------------------------------------------
+// emit_ctx_op: <op> dword [rbp + offset], imm (imm8 for 0x83)
+//-----------------------------------------------------------------
+void RiscvJit::emit_ctx_op(uint8_t op, uint8_t ext, size_t offset, uint32_t imm)
+{
+    emit8(op); emit8(0x85 | (ext << 3)); emit32((uint32_t)offset);
+    if (op == 0x83)
+        emit8(imm);
+    else
+        emit32(imm);
+}
+//-----------------------------------------------------------------
+// emit_call: Call helper, first argument is the model
+//-----------------------------------------------------------------
+void RiscvJit::emit_call(void *fn)
+{
+    // mov rdi, r12
+    emit8(0x4C); emit8(0x89); emit8(0xE7);
+    // mov rax, fn; call rax
+    emit8(0x48); emit8(0xB8); emit64((uint64_t)fn);
+    emit8(0xFF); emit8(0xD0);
+}
+//-----------------------------------------------------------------
+// emit_helper_check: Leave block if a helper set exit_code
+//-----------------------------------------------------------------
+void RiscvJit::emit_helper_check(void)
+{
+    emit_ctx_op(0x83, 7, CTX_OFFSET(exit_code), 0);
+    emit_jcc(X86_CC_NE, m_epilogue);
+}
+//-----------------------------------------------------------------
+// emit_exit: Leave block for target, same page exits can be chained
+//-----------------------------------------------------------------
+void RiscvJit::emit_exit(uint32_t pc, uint32_t target)
+{
+    if ((pc >> TLB_PAGE_SHIFT) != (target >> TLB_PAGE_SHIFT))
+    {
+        // mov eax, target; jmp epilogue
+        emit8(0xB8); emit32(target);
+        emit_jmp(0xE9, m_epilogue);
+        return ;
+    }
+
+    // Initially jumps to the stub which follows, patched by chain()
+    uint8_t *rel = emit_jmp(0xE9, NULL);
+
+    // mov eax, target
+    emit8(0xB8); emit32(target);
+    // mov rcx, rel; mov [rbp + last_exit], rcx
+    emit8(0x48); emit8(0xB9); emit64((uint64_t)rel);
+    emit8(0x48); emit8(0x89); emit8(0x8D); emit32(CTX_OFFSET(last_exit));
+    emit_jmp(0xE9, m_epilogue);
+}
+//-----------------------------------------------------------------
+// emit_prologue: Charge block to the budget, bail out if exhausted
+//-----------------------------------------------------------------
+void RiscvJit::emit_prologue(riscv_jit_block *blk)
+{
+    // cmp dword [rbp + budget], n; jge body
+    emit_ctx_op(0x81, 7, CTX_OFFSET(budget), blk->n);
+    emit8(0x7D); emit8(10);
+    // mov eax, vpc; jmp epilogue
+    emit8(0xB8); emit32(blk->vpc);
+    emit_jmp(0xE9, m_epilogue);
+
+    // body: sub dword [rbp + budget], n
+    emit_ctx_op(0x81, 5, CTX_OFFSET(budget), blk->n);
+    emit_ctx_op(0xC7, 0, CTX_OFFSET(cur_pc), blk->vpc);
+    emit_ctx_op(0xC7, 0, CTX_OFFSET(cur_n), blk->n);
+}
+//-----------------------------------------------------------------
+// emit_insn: Emit host code for one instruction
+//-----------------------------------------------------------------
+void RiscvJit::emit_insn(uint32_t pc, const riscv_decoded *inst)
+{
+    int rd  = inst->rd;
+    int rs1 = inst->rs1;
+    int rs2 = inst->rs2;
+    uint32_t imm = (uint32_t)inst->imm;
+
+    uint8_t alu_imm = 0;
+    uint8_t alu_reg = 0;
+    uint8_t shift   = 0;
+    uint8_t setcc   = 0;
+    uint8_t cc      = 0;
+    uint32_t kind   = 0;
+
+    switch (inst->id)
+    {
+        case ENUM_INST_ADDI:  alu_imm = 0x05; goto do_alu_imm;
+        case ENUM_INST_ANDI:  alu_imm = 0x25; goto do_alu_imm;
+        case ENUM_INST_ORI:   alu_imm = 0x0D; goto do_alu_imm;
+        case ENUM_INST_XORI:  alu_imm = 0x35; goto do_alu_imm;
+        case ENUM_INST_SLTI:  alu_imm = 0x3D; setcc = 0x90 | X86_CC_L; goto do_alu_imm;
+        case ENUM_INST_SLTIU: alu_imm = 0x3D; setcc = 0x90 | X86_CC_B; goto do_alu_imm;
+do_alu_imm:
+            if (rd == 0)
+                return ;
+            emit_load_reg(X86_EAX, rs1);
+            emit8(alu_imm); emit32(imm);
+            if (setcc)
+            {
+                // setcc al; movzx eax, al
+                emit8(0x0F); emit8(setcc); emit8(0xC0);
+                emit8(0x0F); emit8(0xB6); emit8(0xC0);
+            }
+            emit_store_reg(rd);
+            return ;
+
+        case ENUM_INST_SLLI:  shift = 0xE0; goto do_shift_imm;
+        case ENUM_INST_SRLI:  shift = 0xE8; goto do_shift_imm;
+        case ENUM_INST_SRAI:  shift = 0xF8; goto do_shift_imm;
+do_shift_imm:
+            if (rd == 0)
+                return ;
+            // shl/shr/sar eax, imm8
+            emit_load_reg(X86_EAX, rs1);
+            emit8(0xC1); emit8(shift); emit8(imm & 31);
+            emit_store_reg(rd);
+            return ;
+
+        case ENUM_INST_LUI:
+            emit_set_reg(rd, imm);
+            return ;
+        case ENUM_INST_AUIPC:
+            emit_set_reg(rd, pc + imm);
+            return ;
+
+        case ENUM_INST_ADD:   alu_reg = 0x01; goto do_alu_reg;
+        case ENUM_INST_SUB:   alu_reg = 0x29; goto do_alu_reg;
+        case ENUM_INST_XOR:   alu_reg = 0x31; goto do_alu_reg;
+        case ENUM_INST_OR:    alu_reg = 0x09; goto do_alu_reg;
+        case ENUM_INST_AND:   alu_reg = 0x21; goto do_alu_reg;
+        case ENUM_INST_SLT:   alu_reg = 0x39; setcc = 0x90 | X86_CC_L; goto do_alu_reg;
+        case ENUM_INST_SLTU:  alu_reg = 0x39; setcc = 0x90 | X86_CC_B; goto do_alu_reg;
+do_alu_reg:
+            if (rd == 0)
+                return ;
+            // <op> eax, ecx
+            emit_load_reg(X86_EAX, rs1);
+            emit_load_reg(X86_ECX, rs2);
+            emit8(alu_reg); emit8(0xC8);
+            if (setcc)
+            {
+                emit8(0x0F); emit8(setcc); emit8(0xC0);
+                emit8(0x0F); emit8(0xB6); emit8(0xC0);
+            }
+            emit_store_reg(rd);
+            return ;
+
+        case ENUM_INST_SLL:   shift = 0xE0; goto do_shift_reg;
+        case ENUM_INST_SRL:   shift = 0xE8; goto do_shift_reg;
+        case ENUM_INST_SRA:   shift = 0xF8; goto do_shift_reg;
+do_shift_reg:
+            if (rd == 0)
+                return ;
+            // shl/shr/sar eax, cl (count masked to 5 bits as on RISC-V)
+            emit_load_reg(X86_EAX, rs1);
+            emit_load_reg(X86_ECX, rs2);
+            emit8(0xD3); emit8(shift);
+            emit_store_reg(rd);
+            return ;
+
+        case ENUM_INST_MUL:
+            if (rd == 0)
+                return ;
+            // imul eax, ecx
+            emit_load_reg(X86_EAX, rs1);
+            emit_load_reg(X86_ECX, rs2);
+            emit8(0x0F); emit8(0xAF); emit8(0xC1);
+            emit_store_reg(rd);
+            return ;
+
+        case ENUM_INST_MULH: case ENUM_INST_MULHSU: case ENUM_INST_MULHU:
+        case ENUM_INST_DIV:  case ENUM_INST_DIVU:
+        case ENUM_INST_REM:  case ENUM_INST_REMU:
+            if (rd == 0)
+                return ;
+            // helper_alu(id, rs1, rs2), model argument is unused
+            emit_load_reg(X86_ESI, rs1);
+            emit_load_reg(X86_EDX, rs2);
+            // mov edi, id
+            emit8(0xBF); emit32(inst->id);
+            emit8(0x48); emit8(0xB8); emit64((uint64_t)(void *)&helper_alu);
+            emit8(0xFF); emit8(0xD0);
+            emit_store_reg(rd);
+            return ;
+
+        case ENUM_INST_JAL:
+            emit_set_reg(rd, pc + 4);
+            emit_ctx_op(0x83, 0, CTX_OFFSET(branches), 1);
+            emit_exit(pc, pc + imm);
+            return ;
+
+        case ENUM_INST_JALR:
+            // Target first as rd may be rs1
+            emit_load_reg(X86_EAX, rs1);
+            emit8(0x05); emit32(imm);
+            emit8(0x25); emit32(~1u);
+            emit_set_reg(rd, pc + 4);
+            emit_ctx_op(0x83, 0, CTX_OFFSET(branches), 1);
+            emit_jmp(0xE9, m_epilogue);
+            return ;
+
+        case ENUM_INST_BEQ:  cc = X86_CC_E;  goto do_branch;
+        case ENUM_INST_BNE:  cc = X86_CC_NE; goto do_branch;
+        case ENUM_INST_BLT:  cc = X86_CC_L;  goto do_branch;
+        case ENUM_INST_BGE:  cc = X86_CC_GE; goto do_branch;
+        case ENUM_INST_BLTU: cc = X86_CC_B;  goto do_branch;
+        case ENUM_INST_BGEU: cc = X86_CC_AE; goto do_branch;
+do_branch:
+            {
+                emit_ctx_op(0x83, 0, CTX_OFFSET(branches), 1);
+                // cmp eax, ecx; jcc taken
+                emit_load_reg(X86_EAX, rs1);
+                emit_load_reg(X86_ECX, rs2);
+                emit8(0x39); emit8(0xC8);
+                uint8_t *taken = emit_jcc(cc, NULL);
+                emit_exit(pc, pc + 4);
+                patch(taken, m_emit);
+                emit_exit(pc, pc + imm);
+            }
+            return ;
+
+        case ENUM_INST_LB:  kind = 1 | JIT_LOAD_SIGNED; goto do_load;
+        case ENUM_INST_LH:  kind = 2 | JIT_LOAD_SIGNED; goto do_load;
+        case ENUM_INST_LW:  kind = 4 | JIT_LOAD_SIGNED; goto do_load;
+        case ENUM_INST_LBU: kind = 1; goto do_load;
+        case ENUM_INST_LHU: kind = 2; goto do_load;
+        case ENUM_INST_LWU: kind = 4; goto do_load;
+do_load:
+            // helper_load(cpu, rs1 + imm, pc, kind)
+            emit_load_reg(X86_ESI, rs1);
+            emit8(0x81); emit8(0xC6); emit32(imm);
+            emit8(0xBA); emit32(pc);
+            emit8(0xB9); emit32(kind);
+            emit_call((void *)&helper_load);
+            emit_helper_check();
+            emit_store_reg(rd);
+            return ;
+
+        case ENUM_INST_SB:  kind = 1; goto do_store;
+        case ENUM_INST_SH:  kind = 2; goto do_store;
+        case ENUM_INST_SW:  kind = 4; goto do_store;
+do_store:
+            // helper_store(cpu, rs1 + imm, rs2, pc, width)
+            emit_load_reg(X86_EDX, rs2);
+            emit_load_reg(X86_ESI, rs1);
+            emit8(0x81); emit8(0xC6); emit32(imm);
+            emit8(0xB9); emit32(pc);
+            // mov r8d, width
+            emit8(0x41); emit8(0xB8); emit32(kind);
+            emit_call((void *)&helper_store);
+            emit_helper_check();
+            return ;
+
+        // fence, wfi
+        default:
+            return ;
+    }
+}
+//-----------------------------------------------------------------
+// helper_load: Load through the model, called from translated code
+//-----------------------------------------------------------------
+uint32_t RiscvJit::helper_load(Riscv *cpu, uint32_t address, uint32_t pc, uint32_t kind)
+{
+    riscv_jit_ctx *ctx = &cpu->m_jit->m_ctx;
+    uint32_t result = 0;
+
+    // Pc of the faulting instruction if no trap is raised
+    cpu->m_pc = pc;
+
+    if (!cpu->load(pc, address, &result, kind & 7, (kind & JIT_LOAD_SIGNED) != 0))
+        ctx->exit_code = JIT_EXIT_EXCEPTION;
+
+    if (ctx->exit_code != JIT_EXIT_NONE)
+        ctx->exit_pc = pc;
+
+    return result;
+}
+//-----------------------------------------------------------------
+// helper_store: Store through the model, called from translated code
+//-----------------------------------------------------------------
+void RiscvJit::helper_store(Riscv *cpu, uint32_t address, uint32_t data, uint32_t pc, uint32_t width)
+{
+    riscv_jit_ctx *ctx = &cpu->m_jit->m_ctx;
+
+    cpu->m_pc = pc;
+
+    // Write to translated code sets JIT_EXIT_CODE_WRITE through invalidate()
+    if (!cpu->store(pc, address, data, width))
+        ctx->exit_code = JIT_EXIT_EXCEPTION;
+
+    if (ctx->exit_code != JIT_EXIT_NONE)
+        ctx->exit_pc = pc;
+}
+//-----------------------------------------------------------------
+// helper_alu: M extension operations not worth inlining
+//-----------------------------------------------------------------
+uint32_t RiscvJit::helper_alu(uint32_t id, uint32_t reg_rs1, uint32_t reg_rs2)
+{
+    switch (id)
+    {
+        case ENUM_INST_MULH:
+            return (uint32_t)((((long long)(int)reg_rs1) * ((long long)(int)reg_rs2)) >> 32);
+        case ENUM_INST_MULHSU:
+            return (uint32_t)((((long long)(int)reg_rs1) * ((unsigned long long)(unsigned)reg_rs2)) >> 32);
+        case ENUM_INST_MULHU:
+            return (uint32_t)((((unsigned long long)reg_rs1) * ((unsigned long long)reg_rs2)) >> 32);
+        case ENUM_INST_DIV:
+            if ((signed)reg_rs1 == INT32_MIN && (signed)reg_rs2 == -1)
+                return reg_rs1;
+            else if (reg_rs2 != 0)
+                return (signed)reg_rs1 / (signed)reg_rs2;
+            return (unsigned)-1;
+        case ENUM_INST_DIVU:
+            if (reg_rs2 != 0)
+                return reg_rs1 / reg_rs2;
+            return (unsigned)-1;
+        case ENUM_INST_REM:
+            if ((signed)reg_rs1 == INT32_MIN && (signed)reg_rs2 == -1)
+                return 0;
+            else if (reg_rs2 != 0)
+                return (signed)reg_rs1 % (signed)reg_rs2;
+            return reg_rs1;
+        case ENUM_INST_REMU:
+            if (reg_rs2 != 0)
+                return reg_rs1 % reg_rs2;
+            return reg_rs1;
+        default:
+            return 0;
+    }
+}
+#else
+//-----------------------------------------------------------------
+// Other hosts: translator is never valid, run() interprets
+//-----------------------------------------------------------------
+RiscvJit::RiscvJit(Riscv *cpu)
+{
+    m_cpu               = cpu;
+    m_code              = NULL;
+    m_flush_pending     = false;
+    m_blocks_translated = 0;
+    m_insns_translated  = 0;
+}
+RiscvJit::~RiscvJit()
+{
+}
+uint64_t RiscvJit::run(uint64_t max_steps)
+{
+    return 0;
+}
+void RiscvJit::flush(void)
+{
+}
+void RiscvJit::invalidate(uint32_t address)
+{
+}
+#endif
@@ -0,0 +1,136 @@
+//-----------------------------------------------------------------
+//                     RISC-V ISA Simulator
+//                   x86-64 block translator
+//-----------------------------------------------------------------
+#ifndef __RISCV_JIT_H__
+#define __RISCV_JIT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <unordered_map>
+#include "riscv.h"
+
+//--------------------------------------------------------------------
+// Defines:
+//--------------------------------------------------------------------
+// Executions of a block before it gets translated
+#define JIT_HOT_THRESHOLD       16
+#define JIT_MAX_BLOCK_INSNS     64
+#define JIT_CODE_SIZE           (16 * 1024 * 1024)
+// Worst case size of one translated block
+#define JIT_MAX_BLOCK_BYTES     (JIT_MAX_BLOCK_INSNS * 64 + 256)
+
+// Reasons for leaving a block early, set by memory helpers
+#define JIT_EXIT_NONE           0
+// Load / store raised an exception, pc was set by the model
+#define JIT_EXIT_EXCEPTION      1
+// Store hit translated code, the store itself completed
+#define JIT_EXIT_CODE_WRITE     2
+
+// Load kind passed to helper_load, width in bytes | JIT_LOAD_SIGNED
+#define JIT_LOAD_SIGNED         8
+
+//--------------------------------------------------------------------
+// State shared with translated code, addressed through rbp
+//--------------------------------------------------------------------
+typedef struct
+{
+    // Instructions translated code may still execute
+    int32_t  budget;
+    // First pc and length of the block entered last
+    uint32_t cur_pc;
+    int32_t  cur_n;
+    uint32_t exit_code;
+    // pc of the instruction which set exit_code
+    uint32_t exit_pc;
+    uint32_t branches;
+    // Jump of a same page exit which could be chained
+    uint8_t *last_exit;
+} riscv_jit_ctx;
+
+typedef struct
+{
+    uint32_t vpc;
+    uint32_t ppc;
+    int      n;
+    uint32_t hits;
+    // Translated code, NULL if not (yet) translated
+    uint8_t *code;
+    // First instruction can't be translated
+    bool     interp;
+} riscv_jit_block;
+
+//--------------------------------------------------------------------
+// RiscvJit: Translates hot RV32IM basic blocks of a Riscv model
+//--------------------------------------------------------------------
+class RiscvJit
+{
+public:
+                        RiscvJit(Riscv *cpu);
+                        ~RiscvJit();
+
+    bool                valid(void) { return m_code != NULL; }
+
+    // Execute up to max_steps instructions, returns number executed
+    uint64_t            run(uint64_t max_steps);
+
+    // Drop all translations
+    void                flush(void);
+    // Physical word written, translations are dropped before next block
+    void                invalidate(uint32_t address);
+
+    uint64_t            get_blocks(void)        { return m_blocks_translated; }
+    uint64_t            get_insns(void)         { return m_insns_translated; }
+
+private:
+    bool                can_translate(void);
+    riscv_jit_block    *lookup(uint32_t vpc, uint32_t ppc);
+    bool                translate(riscv_jit_block *blk);
+    uint64_t            enter(riscv_jit_block *blk, int32_t budget);
+    void                chain(uint8_t *exit, uint32_t vpc);
+
+    // Code emission
+    void                emit8(uint8_t v)    { *m_emit++ = v; }
+    void                emit32(uint32_t v);
+    void                emit64(uint64_t v);
+    uint8_t            *emit_jmp(uint8_t op, uint8_t *target);
+    uint8_t            *emit_jcc(uint8_t cc, uint8_t *target);
+    void                patch(uint8_t *rel, uint8_t *target);
+    void                emit_load_reg(int host, int r);
+    void                emit_store_reg(int r);
+    void                emit_set_reg(int r, uint32_t value);
+    void                emit_ctx_op(uint8_t op, uint8_t ext, size_t offset, uint32_t imm);
+    void                emit_call(void *fn);
+    void                emit_exit(uint32_t pc, uint32_t target);
+    void                emit_helper_check(void);
+    void                emit_prologue(riscv_jit_block *blk);
+    void                emit_insn(uint32_t pc, const riscv_decoded *inst);
+    static int          classify(const riscv_decoded *inst);
+
+    // Helpers called from translated code
+    static uint32_t     helper_load(Riscv *cpu, uint32_t address, uint32_t pc, uint32_t kind);
+    static void         helper_store(Riscv *cpu, uint32_t address, uint32_t data, uint32_t pc, uint32_t width);
+    static uint32_t     helper_alu(uint32_t id, uint32_t a, uint32_t b);
+
+    Riscv              *m_cpu;
+    riscv_jit_ctx       m_ctx;
+
+    uint8_t            *m_code;
+    uint8_t            *m_code_free;
+    uint8_t            *m_emit;
+    // Fixed code at the start of the buffer
+    uint8_t            *m_entry;
+    uint8_t            *m_epilogue;
+
+    // Blocks by virtual pc
+    std::unordered_map<uint32_t, riscv_jit_block> m_blocks;
+    // Translated words per physical page
+    std::unordered_map<uint32_t, std::vector<uint64_t> > m_code_words;
+    bool                m_flush_pending;
+
+    uint64_t            m_blocks_translated;
+    uint64_t            m_insns_translated;
+};
+
+#endif
@@ -43,6 +43,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <unistd.h>
+#include <signal.h>
 
 #include "riscv.h"
 #include "elf_load.h"
@@ -66,6 +67,17 @@ static int mem_load(void *arg, uint32_t addr, uint8_t data)
     return cosim::instance()->valid_addr(addr);
 }
 //-----------------------------------------------------------------
+// sigint_handler: First Ctrl-C ends the run normally (stats and
+// profile are written), a second one kills the simulator
+//-----------------------------------------------------------------
+static volatile sig_atomic_t _interrupted = 0;
+
+static void sigint_handler(int sig)
+{
+    _interrupted = 1;
+    signal(sig, SIG_DFL);
+}
+//-----------------------------------------------------------------
 // riscv_main
 //-----------------------------------------------------------------
 int riscv_main(cosim_cpu_api *sim, int argc, char *argv[])
@@ -84,9 +96,10 @@ int riscv_main(cosim_cpu_api *sim, int argc, char *argv[])
     char *   dump_file      = NULL;
     char *   dump_sym_start = NULL;
     char *   dump_sym_end   = NULL;
+    bool     jit            = false;
     int c;
 
-    while ((c = getopt (argc, argv, "t:v:f:c:r:d:b:s:e:p:j:k:")) != -1)
+    while ((c = getopt (argc, argv, "t:v:f:c:r:d:b:s:e:p:j:k:J")) != -1)
     {
         switch(c)
         {
@@ -125,6 +138,9 @@ int riscv_main(cosim_cpu_api *sim, int argc, char *argv[])
             case 'k':
                 dump_sym_end = optarg;
                 break;
+            case 'J':
+                jit = true;
+                break;
             case '?':
             default:
                 help = 1;   
@@ -146,6 +162,11 @@ int riscv_main(cosim_cpu_api *sim, int argc, char *argv[])
         fprintf (stderr,"-p dumpfile.bin = Post simulation memory dump file\n");
         fprintf (stderr,"-j sym_name     = Symbol for memory dump start\n");
         fprintf (stderr,"-k sym_name     = Symbol for memory dump end\n");
+        fprintf (stderr,"-n nnnn         = Number of harts sharing memory\n");
+        fprintf (stderr,"-q nnnn         = Instructions per hart between syncs (-n > 1)\n");
+        fprintf (stderr,"-x              = Deterministic multi-hart run\n");
+        fprintf (stderr,"-J              = Translate hot code to host instructions\n");
+        fprintf (stderr,"-P prefix       = Profile, reports in prefix.flat / prefix.callgraph\n");
         exit(-1);
     }
 
@@ -177,24 +198,60 @@ int riscv_main(cosim_cpu_api *sim, int argc, char *argv[])
         if (trace)
             sim->enable_trace(trace_mask);
 
+        if (jit && !sim->enable_jit(true))
+        {
+            fprintf (stderr,"Warning: JIT not supported on this host\n");
+            jit = false;
+        }
+
         _cycles = 0;
+        signal(SIGINT, sigint_handler);
 
         uint32_t current_pc = 0;
-        while (!sim->get_fault() && !sim->get_stopped() &&  current_pc != stop_pc)
+
+        // Without per instruction checks run in chunks, translated code
+        // and the quantums of multi-hart mode need that to be fast
+        if (stop_pc == 0xFFFFFFFF && trace_pc == 0xFFFFFFFF)
         {
-            current_pc = sim->get_pc();
-            sim->step();
-            _cycles++;
+            while (!sim->get_fault() && !sim->get_stopped() && !_interrupted)
+            {
+                uint64_t chunk = 1000000;
 
-            if (max_cycles != -1 && max_cycles == _cycles)
-                break;
+                if (max_cycles != -1)
+                {
+                    if (_cycles >= (unsigned)max_cycles)
+                        break;
+                    if (chunk > (unsigned)max_cycles - _cycles)
+                        chunk = (unsigned)max_cycles - _cycles;
+                }
+
+                // Nothing ran (e.g. hart 0 done, others waiting)
+                uint64_t steps = sim->run(chunk);
+                if (steps == 0)
+                    break;
+                _cycles += steps;
+            }
+        }
 
-            // Turn trace on
-            if (trace_pc == current_pc)
-                sim->enable_trace(trace_mask);
-        }   
+        else
+        {
+            while (!sim->get_fault() && !sim->get_stopped() && !_interrupted && current_pc != stop_pc)
+            {
+                current_pc = sim->get_pc();
+                sim->step();
+                _cycles++;
+
+                if (max_cycles != -1 && max_cycles == _cycles)
+                    break;
+
+                // Turn trace on
+                if (trace_pc == current_pc)
+                    sim->enable_trace(trace_mask);
+            }
+        }
 
-        cosim::instance()->at_exit(sim->get_fault());
+        // Stats, exit code and shutdown are left to the caller
+        cosim::instance()->dump_memory();
     }
     else
         fprintf (stderr,"Error: Could not open %s\n", filename);
@@ -0,0 +1,569 @@
+//-----------------------------------------------------------------
+//                     RISC-V ISA Simulator
+//                  Hotspot / instruction mix profiler
+//-----------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "riscv_profiler.h"
+#include "riscv_inst_dump.h"
+#include "elf_load.h"
+
+//-----------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------
+RiscvProfiler::RiscvProfiler()
+{
+    m_sorted = true;
+    m_last_page = NULL;
+    m_last_ppn  = 0;
+    reset();
+}
+//-----------------------------------------------------------------
+// Destructor
+//-----------------------------------------------------------------
+RiscvProfiler::~RiscvProfiler()
+{
+    reset();
+}
+//-----------------------------------------------------------------
+// reset: Drop collected data, symbols are kept
+//-----------------------------------------------------------------
+void RiscvProfiler::reset(void)
+{
+    for (std::unordered_map<uint32_t, riscv_prof_page *>::iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+        delete it->second;
+
+    m_pages.clear();
+    m_last_page = NULL;
+    m_last_ppn  = 0;
+
+    m_instructions   = 0;
+    m_branches_taken = 0;
+    for (int i=0;i<PROF_CLASS_MAX;i++)
+        m_class[i] = 0;
+
+    m_prev_pc   = 0;
+    m_prev_flow = PROF_FLOW_NONE;
+
+    m_edges.clear();
+    m_calls.clear();
+    m_stack.clear();
+
+    for (size_t i=0;i<m_symbols.size();i++)
+    {
+        m_symbols[i].self   = 0;
+        m_symbols[i].total  = 0;
+        m_symbols[i].calls  = 0;
+        m_symbols[i].active = 0;
+    }
+}
+//-----------------------------------------------------------------
+// load_symbols: Add code symbols of an ELF file
+//-----------------------------------------------------------------
+static void profiler_add_symbol(void *arg, const char *name, uint32_t addr)
+{
+    ((RiscvProfiler *)arg)->add_symbol(name, addr);
+}
+int RiscvProfiler::load_symbols(const char *filename)
+{
+    return elf_get_symbols(filename, profiler_add_symbol, this);
+}
+//-----------------------------------------------------------------
+// add_symbol: Symbols should be added before execution starts
+//-----------------------------------------------------------------
+void RiscvProfiler::add_symbol(const char *name, uint32_t addr)
+{
+    riscv_prof_symbol sym;
+
+    sym.name   = name;
+    sym.addr   = addr;
+    sym.self   = 0;
+    sym.total  = 0;
+    sym.calls  = 0;
+    sym.active = 0;
+
+    m_symbols.push_back(sym);
+    m_sorted = false;
+}
+//-----------------------------------------------------------------
+// sort_symbols: Sort by address, first symbol at an address wins
+//-----------------------------------------------------------------
+static bool symbol_before(const riscv_prof_symbol &a, const riscv_prof_symbol &b)
+{
+    return a.addr < b.addr;
+}
+static bool symbol_same_addr(const riscv_prof_symbol &a, const riscv_prof_symbol &b)
+{
+    return a.addr == b.addr;
+}
+void RiscvProfiler::sort_symbols(void)
+{
+    std::stable_sort(m_symbols.begin(), m_symbols.end(), symbol_before);
+    m_symbols.erase(std::unique(m_symbols.begin(), m_symbols.end(), symbol_same_addr), m_symbols.end());
+    m_sorted = true;
+
+    // Symbol indices changed
+    m_calls.clear();
+    m_stack.clear();
+}
+//-----------------------------------------------------------------
+// find_symbol: Index of symbol containing pc, -1 if none
+//-----------------------------------------------------------------
+int RiscvProfiler::find_symbol(uint32_t pc)
+{
+    if (!m_sorted)
+        sort_symbols();
+
+    int lo = 0;
+    int hi = (int)m_symbols.size() - 1;
+    int found = -1;
+
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (m_symbols[mid].addr <= pc)
+        {
+            found = mid;
+            lo    = mid + 1;
+        }
+        else
+            hi = mid - 1;
+    }
+
+    return found;
+}
+//-----------------------------------------------------------------
+// symbolize: symbol+offset for pc
+//-----------------------------------------------------------------
+std::string RiscvProfiler::symbolize(uint32_t pc)
+{
+    char buf[32];
+    int s = find_symbol(pc);
+
+    if (s < 0)
+    {
+        sprintf(buf, "0x%08x", pc);
+        return buf;
+    }
+
+    if (pc == m_symbols[s].addr)
+        return m_symbols[s].name;
+
+    sprintf(buf, "+0x%x", pc - m_symbols[s].addr);
+    return m_symbols[s].name + buf;
+}
+//-----------------------------------------------------------------
+// classify: Instruction class and kind of control transfer
+//-----------------------------------------------------------------
+void RiscvProfiler::classify(uint32_t opcode, uint8_t *cls, uint8_t *flow)
+{
+    riscv_decoded inst;
+    Riscv::decode(opcode, &inst);
+
+    *flow = PROF_FLOW_NONE;
+
+    switch (inst.id)
+    {
+        case ENUM_INST_LB: case ENUM_INST_LH: case ENUM_INST_LW:
+        case ENUM_INST_LBU: case ENUM_INST_LHU: case ENUM_INST_LWU:
+            *cls = PROF_CLASS_LOAD;
+            break;
+        case ENUM_INST_SB: case ENUM_INST_SH: case ENUM_INST_SW:
+            *cls = PROF_CLASS_STORE;
+            break;
+        case ENUM_INST_MUL: case ENUM_INST_MULH: case ENUM_INST_MULHSU: case ENUM_INST_MULHU:
+            *cls = PROF_CLASS_MUL;
+            break;
+        case ENUM_INST_DIV: case ENUM_INST_DIVU: case ENUM_INST_REM: case ENUM_INST_REMU:
+            *cls = PROF_CLASS_DIV;
+            break;
+        case ENUM_INST_BEQ: case ENUM_INST_BNE: case ENUM_INST_BLT:
+        case ENUM_INST_BGE: case ENUM_INST_BLTU: case ENUM_INST_BGEU:
+            *cls  = PROF_CLASS_BRANCH;
+            *flow = PROF_FLOW_BRANCH;
+            break;
+        case ENUM_INST_JAL:
+        case ENUM_INST_JALR:
+            *cls = PROF_CLASS_JUMP;
+            // Calling convention: link register is ra or t0 (alternate)
+            if (inst.rd == 1 || inst.rd == 5)
+                *flow = PROF_FLOW_CALL;
+            else if (inst.id == ENUM_INST_JALR && inst.rd == 0 && (inst.rs1 == 1 || inst.rs1 == 5))
+                *flow = PROF_FLOW_RET;
+            else
+                *flow = PROF_FLOW_JUMP;
+            break;
+        case ENUM_INST_CSRRW: case ENUM_INST_CSRRS: case ENUM_INST_CSRRC:
+        case ENUM_INST_CSRRWI: case ENUM_INST_CSRRSI: case ENUM_INST_CSRRCI:
+            *cls = PROF_CLASS_CSR;
+            break;
+        case ENUM_INST_ECALL: case ENUM_INST_EBREAK: case ENUM_INST_MRET:
+        case ENUM_INST_SRET: case ENUM_INST_WFI:
+            *cls  = PROF_CLASS_SYSTEM;
+            *flow = PROF_FLOW_JUMP;
+            break;
+        case ENUM_INST_FENCE:
+            *cls = PROF_CLASS_FENCE;
+            break;
+        case ENUM_INST_MAX:
+            *cls = PROF_CLASS_ILLEGAL;
+            break;
+        default:
+            *cls = PROF_CLASS_ALU;
+            break;
+    }
+}
+//-----------------------------------------------------------------
+// class_name:
+//-----------------------------------------------------------------
+const char *RiscvProfiler::class_name(int cls)
+{
+    static const char *names[PROF_CLASS_MAX] =
+    {
+        "alu", "mul", "div", "load", "store", "branch", "jump", "csr", "system", "fence", "illegal"
+    };
+
+    return (cls >= 0 && cls < PROF_CLASS_MAX) ? names[cls] : "?";
+}
+//-----------------------------------------------------------------
+// page: Counters of page containing pc
+//-----------------------------------------------------------------
+riscv_prof_page *RiscvProfiler::page(uint32_t pc)
+{
+    uint32_t ppn = pc >> PROF_PAGE_SHIFT;
+
+    if (m_last_page && ppn == m_last_ppn)
+        return m_last_page;
+
+    riscv_prof_page *p;
+    std::unordered_map<uint32_t, riscv_prof_page *>::iterator it = m_pages.find(ppn);
+    if (it != m_pages.end())
+        p = it->second;
+    else
+    {
+        p = new riscv_prof_page;
+        memset(p->count, 0, sizeof(p->count));
+        memset(p->cls, PROF_CLASS_UNKNOWN, sizeof(p->cls));
+        m_pages[ppn] = p;
+    }
+
+    m_last_page = p;
+    m_last_ppn  = ppn;
+    return p;
+}
+//-----------------------------------------------------------------
+// execute: Called by the model for every executed instruction
+//-----------------------------------------------------------------
+void RiscvProfiler::execute(uint32_t pc, uint32_t opcode)
+{
+    riscv_prof_page *p = page(pc);
+    uint32_t idx = (pc >> 2) & (PROF_PAGE_ENTRIES - 1);
+
+    if (p->cls[idx] == PROF_CLASS_UNKNOWN || p->opcode[idx] != opcode)
+    {
+        p->opcode[idx] = opcode;
+        classify(opcode, &p->cls[idx], &p->flow[idx]);
+    }
+
+    p->count[idx]++;
+    m_instructions++;
+    m_class[p->cls[idx]]++;
+
+    // Previous control transfer was taken
+    if (m_prev_flow != PROF_FLOW_NONE && pc != m_prev_pc + 4)
+    {
+        m_edges[((uint64_t)m_prev_pc << 32) | pc]++;
+
+        if (m_prev_flow == PROF_FLOW_BRANCH)
+            m_branches_taken++;
+        else if (m_prev_flow == PROF_FLOW_CALL)
+            call(m_prev_pc, pc);
+        else if (m_prev_flow == PROF_FLOW_RET)
+            ret();
+    }
+
+    m_prev_pc   = pc;
+    m_prev_flow = p->flow[idx];
+}
+//-----------------------------------------------------------------
+// call: Track call from pc 'from' to function at 'to'
+//-----------------------------------------------------------------
+void RiscvProfiler::call(uint32_t from, uint32_t to)
+{
+    if (m_symbols.empty())
+        return ;
+
+    int caller = find_symbol(from);
+    int callee = find_symbol(to);
+
+    m_calls[((uint64_t)(uint32_t)caller << 32) | (uint32_t)callee]++;
+
+    if (m_stack.size() >= PROF_MAX_DEPTH)
+    {
+        for (size_t i=0;i<m_symbols.size();i++)
+            m_symbols[i].active = 0;
+        m_stack.clear();
+    }
+
+    // Instruction at 'to' was already counted and belongs to the callee
+    riscv_prof_frame frame;
+    frame.sym   = callee;
+    frame.entry = m_instructions - 1;
+    m_stack.push_back(frame);
+
+    if (callee >= 0)
+    {
+        m_symbols[callee].calls++;
+        m_symbols[callee].active++;
+    }
+}
+//-----------------------------------------------------------------
+// ret: Close innermost call frame
+//-----------------------------------------------------------------
+void RiscvProfiler::ret(void)
+{
+    if (m_stack.empty())
+        return ;
+
+    riscv_prof_frame frame = m_stack.back();
+    m_stack.pop_back();
+
+    if (frame.sym >= 0 && --m_symbols[frame.sym].active == 0)
+        m_symbols[frame.sym].total += (m_instructions - 1) - frame.entry;
+}
+//-----------------------------------------------------------------
+// attribute: Self counts per symbol, total includes open calls
+//-----------------------------------------------------------------
+void RiscvProfiler::attribute(std::vector<uint64_t> &total)
+{
+    if (!m_sorted)
+        sort_symbols();
+
+    for (size_t i=0;i<m_symbols.size();i++)
+        m_symbols[i].self = 0;
+
+    for (std::unordered_map<uint32_t, riscv_prof_page *>::iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+    {
+        for (int i=0;i<PROF_PAGE_ENTRIES;i++)
+        {
+            if (!it->second->count[i])
+                continue;
+
+            int s = find_symbol((it->first << PROF_PAGE_SHIFT) | (i << 2));
+            if (s >= 0)
+                m_symbols[s].self += it->second->count[i];
+        }
+    }
+
+    total.resize(m_symbols.size());
+    for (size_t i=0;i<m_symbols.size();i++)
+        total[i] = m_symbols[i].total;
+
+    // Calls which did not return yet, outermost frame of each symbol
+    std::vector<bool> seen(m_symbols.size(), false);
+    for (size_t i=0;i<m_stack.size();i++)
+    {
+        int s = m_stack[i].sym;
+        if (s >= 0 && !seen[s])
+        {
+            seen[s]   = true;
+            total[s] += m_instructions - m_stack[i].entry;
+        }
+    }
+
+    // Functions never called (entry point) include at least themselves
+    for (size_t i=0;i<m_symbols.size();i++)
+        if (total[i] < m_symbols[i].self)
+            total[i] = m_symbols[i].self;
+}
+//-----------------------------------------------------------------
+// write_flat: Flat profile, instruction mix and hottest pcs / edges
+//-----------------------------------------------------------------
+void RiscvProfiler::write_flat(FILE *f)
+{
+    std::vector<uint64_t> total;
+    attribute(total);
+
+    uint64_t n = m_instructions ? m_instructions : 1;
+
+    fprintf(f, "Flat profile (%llu instructions):\n", (unsigned long long)m_instructions);
+    fprintf(f, "  %%self  cumul%%        self       total      calls  function\n");
+
+    std::vector<int> order;
+    for (size_t i=0;i<m_symbols.size();i++)
+        if (m_symbols[i].self || total[i])
+            order.push_back((int)i);
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return m_symbols[a].self > m_symbols[b].self; });
+
+    uint64_t cumul = 0;
+    uint64_t known = 0;
+    for (size_t i=0;i<order.size();i++)
+    {
+        riscv_prof_symbol &sym = m_symbols[order[i]];
+        cumul += sym.self;
+        known += sym.self;
+        fprintf(f, "%7.2f %7.2f %11llu %11llu %10llu  %s\n", sym.self * 100.0 / n, cumul * 100.0 / n,
+                (unsigned long long)sym.self, (unsigned long long)total[order[i]],
+                (unsigned long long)sym.calls, sym.name.c_str());
+    }
+    if (known < m_instructions)
+        fprintf(f, "%7.2f %7.2f %11llu %11s %10s  <no symbol>\n", (m_instructions - known) * 100.0 / n, 100.0,
+                (unsigned long long)(m_instructions - known), "-", "-");
+
+    fprintf(f, "\nInstruction mix:\n");
+    for (int c=0;c<PROF_CLASS_MAX;c++)
+        if (m_class[c])
+            fprintf(f, "  %-8s %12llu %6.2f%%\n", class_name(c), (unsigned long long)m_class[c], m_class[c] * 100.0 / n);
+    if (m_class[PROF_CLASS_BRANCH])
+        fprintf(f, "  branches taken %llu (%.2f%%)\n", (unsigned long long)m_branches_taken,
+                m_branches_taken * 100.0 / m_class[PROF_CLASS_BRANCH]);
+
+    // Hottest instructions
+    std::vector<std::pair<uint64_t, uint32_t> > pcs;
+    for (std::unordered_map<uint32_t, riscv_prof_page *>::iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+        for (int i=0;i<PROF_PAGE_ENTRIES;i++)
+            if (it->second->count[i])
+                pcs.push_back(std::make_pair(it->second->count[i], (it->first << PROF_PAGE_SHIFT) | (i << 2)));
+
+    std::sort(pcs.rbegin(), pcs.rend());
+    if (pcs.size() > PROF_REPORT_TOP)
+        pcs.resize(PROF_REPORT_TOP);
+
+    fprintf(f, "\nHot instructions:\n");
+    for (size_t i=0;i<pcs.size();i++)
+    {
+        uint32_t pc = pcs[i].second;
+        riscv_prof_page *p = page(pc);
+        uint32_t idx = (pc >> 2) & (PROF_PAGE_ENTRIES - 1);
+        char str[128] = "";
+
+        riscv_inst_decode(str, sizeof(str), pc, p->opcode[idx]);
+        fprintf(f, "  %11llu %6.2f%%  %08x  %-32s %s\n", (unsigned long long)pcs[i].first, pcs[i].first * 100.0 / n,
+                pc, symbolize(pc).c_str(), str);
+    }
+
+    // Hottest taken edges
+    std::vector<std::pair<uint64_t, uint64_t> > edges;
+    for (std::unordered_map<uint64_t, uint64_t>::iterator it = m_edges.begin(); it != m_edges.end(); ++it)
+        edges.push_back(std::make_pair(it->second, it->first));
+
+    std::sort(edges.rbegin(), edges.rend());
+    if (edges.size() > PROF_REPORT_TOP)
+        edges.resize(PROF_REPORT_TOP);
+
+    fprintf(f, "\nTaken control transfers:\n");
+    for (size_t i=0;i<edges.size();i++)
+    {
+        uint32_t from = edges[i].second >> 32;
+        uint32_t to   = (uint32_t)edges[i].second;
+
+        fprintf(f, "  %11llu  %08x -> %08x  %s -> %s\n", (unsigned long long)edges[i].first, from, to,
+                symbolize(from).c_str(), symbolize(to).c_str());
+    }
+}
+//-----------------------------------------------------------------
+// write_callgraph: Callers and callees of every executed function
+//-----------------------------------------------------------------
+void RiscvProfiler::write_callgraph(FILE *f)
+{
+    std::vector<uint64_t> total;
+    attribute(total);
+
+    uint64_t n = m_instructions ? m_instructions : 1;
+
+    std::vector<int> order;
+    for (size_t i=0;i<m_symbols.size();i++)
+        if (m_symbols[i].self || total[i])
+            order.push_back((int)i);
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return total[a] > total[b]; });
+
+    fprintf(f, "Call graph (%llu instructions), functions by total instructions:\n", (unsigned long long)m_instructions);
+    fprintf(f, "  callers and callees are listed with the number of calls\n\n");
+
+    for (size_t i=0;i<order.size();i++)
+    {
+        int s = order[i];
+
+        for (std::unordered_map<uint64_t, uint64_t>::iterator it = m_calls.begin(); it != m_calls.end(); ++it)
+        {
+            int caller = (int)(uint32_t)(it->first >> 32);
+            int callee = (int)(uint32_t)it->first;
+            if (callee == s)
+                fprintf(f, "  %36llu    %s\n", (unsigned long long)it->second,
+                        caller >= 0 ? m_symbols[caller].name.c_str() : "<no symbol>");
+        }
+
+        fprintf(f, "  %6.2f%% total %11llu self %11llu  %s\n", total[s] * 100.0 / n,
+                (unsigned long long)total[s], (unsigned long long)m_symbols[s].self, m_symbols[s].name.c_str());
+
+        for (std::unordered_map<uint64_t, uint64_t>::iterator it = m_calls.begin(); it != m_calls.end(); ++it)
+        {
+            int caller = (int)(uint32_t)(it->first >> 32);
+            int callee = (int)(uint32_t)it->first;
+            if (caller == s)
+                fprintf(f, "  %36llu        %s\n", (unsigned long long)it->second,
+                        callee >= 0 ? m_symbols[callee].name.c_str() : "<no symbol>");
+        }
+
+        fprintf(f, "-----------------------------------------------------------------\n");
+    }
+}
+//-----------------------------------------------------------------
+// print: Write reports, summary to stdout if no output is set
+//-----------------------------------------------------------------
+void RiscvProfiler::print(void)
+{
+    if (m_prefix.empty())
+    {
+        std::vector<uint64_t> total;
+        attribute(total);
+
+        uint64_t n = m_instructions ? m_instructions : 1;
+
+        std::vector<int> order;
+        for (size_t i=0;i<m_symbols.size();i++)
+            if (m_symbols[i].self)
+                order.push_back((int)i);
+
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return m_symbols[a].self > m_symbols[b].self; });
+        if (order.size() > PROF_PRINT_TOP)
+            order.resize(PROF_PRINT_TOP);
+
+        printf("Profile (%llu instructions):\n", (unsigned long long)m_instructions);
+        for (size_t i=0;i<order.size();i++)
+            printf("- %6.2f%% %s\n", m_symbols[order[i]].self * 100.0 / n, m_symbols[order[i]].name.c_str());
+
+        printf("Instruction mix:\n");
+        for (int c=0;c<PROF_CLASS_MAX;c++)
+            if (m_class[c])
+                printf("- %s %llu (%.2f%%)\n", class_name(c), (unsigned long long)m_class[c], m_class[c] * 100.0 / n);
+        return ;
+    }
+
+    std::string flat  = m_prefix + ".flat";
+    std::string graph = m_prefix + ".callgraph";
+
+    FILE *f = fopen(flat.c_str(), "w");
+    if (f)
+    {
+        write_flat(f);
+        fclose(f);
+    }
+    else
+        fprintf(stderr, "Error: Could not write %s\n", flat.c_str());
+
+    f = fopen(graph.c_str(), "w");
+    if (f)
+    {
+        write_callgraph(f);
+        fclose(f);
+    }
+    else
+        fprintf(stderr, "Error: Could not write %s\n", graph.c_str());
+
+    printf("Profile: %llu instructions, written to %s / %s\n", (unsigned long long)m_instructions,
+           flat.c_str(), graph.c_str());
+}
@@ -0,0 +1,154 @@
+//-----------------------------------------------------------------
+//                     RISC-V ISA Simulator
+//                  Hotspot / instruction mix profiler
+//-----------------------------------------------------------------
+#ifndef __RISCV_PROFILER_H__
+#define __RISCV_PROFILER_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "riscv.h"
+
+//--------------------------------------------------------------------
+// Defines:
+//--------------------------------------------------------------------
+#define PROF_PAGE_SHIFT     12
+#define PROF_PAGE_ENTRIES   (1 << (PROF_PAGE_SHIFT - 2))
+
+// Entries of the flat profile printed by print()
+#define PROF_PRINT_TOP      20
+// Hottest instructions and edges in the reports
+#define PROF_REPORT_TOP     100
+// Deeper call stacks (e.g. longjmp) restart call tracking
+#define PROF_MAX_DEPTH      4096
+
+//--------------------------------------------------------------------
+// Enums:
+//--------------------------------------------------------------------
+enum eProfClass
+{
+    PROF_CLASS_ALU,
+    PROF_CLASS_MUL,
+    PROF_CLASS_DIV,
+    PROF_CLASS_LOAD,
+    PROF_CLASS_STORE,
+    PROF_CLASS_BRANCH,
+    PROF_CLASS_JUMP,
+    PROF_CLASS_CSR,
+    PROF_CLASS_SYSTEM,
+    PROF_CLASS_FENCE,
+    PROF_CLASS_ILLEGAL,
+    PROF_CLASS_MAX
+};
+
+enum eProfFlow
+{
+    PROF_FLOW_NONE,
+    PROF_FLOW_BRANCH,
+    PROF_FLOW_JUMP,
+    PROF_FLOW_CALL,
+    PROF_FLOW_RET
+};
+
+//--------------------------------------------------------------------
+// Per page execution counts by virtual pc, class is decoded again
+// whenever the opcode at a pc changes (code loaded over other code,
+// another address space mapped at the same addresses)
+//--------------------------------------------------------------------
+#define PROF_CLASS_UNKNOWN  0xFF
+
+typedef struct
+{
+    uint64_t count[PROF_PAGE_ENTRIES];
+    uint32_t opcode[PROF_PAGE_ENTRIES];
+    uint8_t  cls[PROF_PAGE_ENTRIES];
+    uint8_t  flow[PROF_PAGE_ENTRIES];
+} riscv_prof_page;
+
+typedef struct
+{
+    std::string name;
+    uint32_t    addr;
+    // Instructions executed in the function itself
+    uint64_t    self;
+    // Instructions executed until the outermost call returned
+    uint64_t    total;
+    uint64_t    calls;
+    // Calls currently active, recursion is counted once in total
+    int         active;
+} riscv_prof_symbol;
+
+typedef struct
+{
+    int         sym;
+    uint64_t    entry;
+} riscv_prof_frame;
+
+//--------------------------------------------------------------------
+// RiscvProfiler: Histogram of executed pcs, instruction mix and edges
+//--------------------------------------------------------------------
+class RiscvProfiler: public IStatsInterface
+{
+public:
+                        RiscvProfiler();
+    virtual             ~RiscvProfiler();
+
+    // Symbols from ELF file, returns number of symbols found
+    int                 load_symbols(const char *filename);
+    void                add_symbol(const char *name, uint32_t addr);
+
+    // Reports written by print(), stdout summary only if not set
+    void                set_output(const char *prefix) { m_prefix = prefix ? prefix : ""; }
+
+    // IStatsInterface
+    void                reset(void);
+    void                execute(uint32_t pc, uint32_t opcode);
+    void                print(void);
+
+    void                write_flat(FILE *f);
+    void                write_callgraph(FILE *f);
+
+    uint64_t            get_instructions(void)          { return m_instructions; }
+    uint64_t            get_class(int cls)              { return m_class[cls]; }
+
+    static const char  *class_name(int cls);
+
+private:
+    riscv_prof_page    *page(uint32_t pc);
+    void                classify(uint32_t opcode, uint8_t *cls, uint8_t *flow);
+    void                sort_symbols(void);
+    int                 find_symbol(uint32_t pc);
+    std::string         symbolize(uint32_t pc);
+    void                call(uint32_t from, uint32_t to);
+    void                ret(void);
+    void                attribute(std::vector<uint64_t> &total);
+
+    // Per pc counts
+    std::unordered_map<uint32_t, riscv_prof_page *> m_pages;
+    riscv_prof_page    *m_last_page;
+    uint32_t            m_last_ppn;
+
+    uint64_t            m_instructions;
+    uint64_t            m_class[PROF_CLASS_MAX];
+    uint64_t            m_branches_taken;
+
+    // Previous instruction, to find taken control transfers
+    uint32_t            m_prev_pc;
+    uint8_t             m_prev_flow;
+
+    // Taken edges (from << 32 | to) and calls between symbols
+    std::unordered_map<uint64_t, uint64_t> m_edges;
+    std::unordered_map<uint64_t, uint64_t> m_calls;
+
+    // Symbols sorted by address and the shadow call stack
+    std::vector<riscv_prof_symbol> m_symbols;
+    bool                m_sorted;
+    std::vector<riscv_prof_frame> m_stack;
+
+    std::string         m_prefix;
+};
+
+#endif
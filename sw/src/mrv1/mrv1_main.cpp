@@ -0,0 +1,44 @@
+#include <cstdio>
+#include <string>
+
+#include "CLI/CLI.hpp"
+#include "mrv1_soc.hpp"
+
+int main(int argc, char** argv) {
+    CLI::App app("mrv1_sim");
+    std::string elf_filename;
+    std::string json_path;
+    int64_t cycle_count = 1000000;
+    bool quiet = false;
+    app.add_option("-e,--elf", elf_filename, "Executable elf file")
+           ->required()
+           ->check(CLI::ExistingFile);
+    app.add_option("-c,--cycles", cycle_count, "Cycle limit, -1 runs until tohost is written");
+    app.add_option("-j,--json", json_path, "Write performance counters as json");
+    app.add_flag("-q,--quiet", quiet, "Don't print the report");
+    CLI11_PARSE(app, argc, argv);
+
+    mrv1_soc soc;
+    if (!soc.load_elf(elf_filename, quiet ? 0 : 1))
+        return 1;
+
+    bool finished = soc.run_simulation(cycle_count, quiet ? -1 : 0);
+
+    if (!json_path.empty()) {
+        mrv1_perf_counters perf;
+        soc.get_perf_counters(perf);
+        auto* fp = fopen(json_path.c_str(), "w");
+        if (!fp) {
+            printf("Failed to open %s\n", json_path.c_str());
+            return 1;
+        }
+        fprintf(fp, "%s\n", perf.to_json().c_str());
+        fclose(fp);
+    }
+
+    // exit status tells the sweep whether the workload completed,
+    // workloads report success by writing 1 to tohost
+    if (!finished)
+        return 2;
+    return soc.get_tohost() == 1 ? 0 : 3;
+}
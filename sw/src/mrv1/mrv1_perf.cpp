@@ -0,0 +1,84 @@
+#include "mrv1_perf.hpp"
+
+static const char* s_perf_names[MRV1_PERF_NUM] = {
+    "cycles",
+    "instret",
+    "sched_used",
+    "sched_idle_refill",
+    "sched_idle_stalled",
+    "sched_idle_none",
+    "imem_stall",
+    "issue_used",
+    "issue_fu_busy",
+    "dmem_stall",
+    "branch_redirect",
+};
+
+static const char* s_th_perf_names[MRV1_TH_PERF_NUM] = {
+    "retired",
+    "sched",
+    "active",
+    "stalled",
+    "slot_wait",
+    "issued",
+    "iq_full",
+    "raw",
+};
+
+const char* mrv1_perf_counters::name(int idx) {
+    return (idx >= 0 && idx < MRV1_PERF_NUM) ? s_perf_names[idx] : "unknown";
+}
+
+const char* mrv1_perf_counters::th_name(int idx) {
+    return (idx >= 0 && idx < MRV1_TH_PERF_NUM) ? s_th_perf_names[idx] : "unknown";
+}
+
+double mrv1_perf_counters::ipc() const {
+    return v[MRV1_PERF_CYCLES] ? static_cast<double>(v[MRV1_PERF_INSTRET]) / v[MRV1_PERF_CYCLES] : 0.0;
+}
+
+void mrv1_perf_counters::print(FILE* fp) const {
+    const uint64_t cycles = v[MRV1_PERF_CYCLES];
+    auto pct = [cycles](uint64_t n) {
+        return cycles ? 100.0 * n / cycles : 0.0;
+    };
+
+    fprintf(fp, "Threads: %zu, %llu cycles, %llu instructions, IPC %.3f\n", th.size(),
+            static_cast<unsigned long long>(cycles),
+            static_cast<unsigned long long>(v[MRV1_PERF_INSTRET]), ipc());
+    fprintf(fp, "Fetch slots:\n");
+    for (int i = MRV1_PERF_SCHED_USED; i <= MRV1_PERF_SCHED_IDLE_NONE; i++)
+        fprintf(fp, "  %-20s %12llu  %5.1f%%\n", name(i),
+                static_cast<unsigned long long>(v[i]), pct(v[i]));
+    fprintf(fp, "Pipeline:\n");
+    for (int i = MRV1_PERF_IMEM_STALL; i < MRV1_PERF_NUM; i++)
+        fprintf(fp, "  %-20s %12llu  %5.1f%%\n", name(i),
+                static_cast<unsigned long long>(v[i]), pct(v[i]));
+
+    fprintf(fp, "Threads:\n  tid");
+    for (int i = 0; i < MRV1_TH_PERF_NUM; i++)
+        fprintf(fp, " %12s", th_name(i));
+    fprintf(fp, " %8s\n", "ipc");
+    for (size_t t = 0; t < th.size(); t++) {
+        fprintf(fp, "  %3zu", t);
+        for (int i = 0; i < MRV1_TH_PERF_NUM; i++)
+            fprintf(fp, " %12llu", static_cast<unsigned long long>(th[t].v[i]));
+        fprintf(fp, " %8.3f\n", cycles ? static_cast<double>(th[t].v[MRV1_TH_PERF_RETIRED]) / cycles : 0.0);
+    }
+}
+
+std::string mrv1_perf_counters::to_json() const {
+    std::string res = "{\"threads\": " + std::to_string(th.size());
+    res += ", \"cycles_per_sec\": " + std::to_string(static_cast<uint64_t>(cycles_per_sec));
+    for (int i = 0; i < MRV1_PERF_NUM; i++)
+        res += ", \"" + std::string(name(i)) + "\": " + std::to_string(v[i]);
+    res += ", \"per_thread\": [";
+    for (size_t t = 0; t < th.size(); t++) {
+        res += t ? ", {" : "{";
+        for (int i = 0; i < MRV1_TH_PERF_NUM; i++)
+            res += (i ? ", \"" : "\"") + std::string(th_name(i)) + "\": " + std::to_string(th[t].v[i]);
+        res += "}";
+    }
+    res += "]}";
+    return res;
+}
@@ -0,0 +1,62 @@
+#ifndef __MRV1_PERF_HPP__
+#define __MRV1_PERF_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Core counters of mrv1_core, order must match mrv_perf_e in mrv1_pkg.sv.
+enum mrv1_perf_counter {
+    MRV1_PERF_CYCLES = 0,
+    MRV1_PERF_INSTRET,
+    // fetch slot of the thread scheduler, exactly one of these per cycle
+    MRV1_PERF_SCHED_USED,
+    MRV1_PERF_SCHED_IDLE_REFILL,
+    MRV1_PERF_SCHED_IDLE_STALLED,
+    MRV1_PERF_SCHED_IDLE_NONE,
+    MRV1_PERF_IMEM_STALL,
+    MRV1_PERF_ISSUE_USED,
+    MRV1_PERF_ISSUE_FU_BUSY,
+    MRV1_PERF_DMEM_STALL,
+    MRV1_PERF_BRANCH_REDIRECT,
+    MRV1_PERF_NUM
+};
+
+// Per thread counters, order must match mrv_th_perf_e in mrv1_pkg.sv.
+enum mrv1_th_perf_counter {
+    MRV1_TH_PERF_RETIRED = 0,
+    MRV1_TH_PERF_SCHED,
+    MRV1_TH_PERF_ACTIVE,
+    // active, waits for branch resolution
+    MRV1_TH_PERF_STALLED,
+    // ready, but the fetch slot went to another thread
+    MRV1_TH_PERF_SLOT_WAIT,
+    MRV1_TH_PERF_ISSUED,
+    MRV1_TH_PERF_IQ_FULL,
+    MRV1_TH_PERF_RAW,
+    MRV1_TH_PERF_NUM
+};
+
+struct mrv1_th_perf {
+    uint64_t v[MRV1_TH_PERF_NUM] = {};
+};
+
+// Counter values of one run, counters restart on every reset.
+struct mrv1_perf_counters {
+    uint64_t v[MRV1_PERF_NUM] = {};
+    std::vector<mrv1_th_perf> th;
+    // host simulation speed of the run, not a design counter
+    double cycles_per_sec = 0.0;
+
+    double ipc() const;
+    // human readable report
+    void print(FILE* fp = stdout) const;
+    // one json object, used by the thread count sweep
+    std::string to_json() const;
+
+    static const char* name(int idx);
+    static const char* th_name(int idx);
+};
+
+#endif /* __MRV1_PERF_HPP__ */
@@ -0,0 +1,185 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include "mrv1_soc.hpp"
+
+// verilator includes
+#include "Vmrv1_sim_top.h"
+#include "verilated.h"
+
+mrv1_soc::mrv1_soc() : m_elf_loader(this) {
+    m_ctx = new VerilatedContext;
+    assert(m_ctx);
+
+    m_rtl = new Vmrv1_sim_top(m_ctx, "Vmrv1_sim_top");
+    assert(m_rtl);
+
+    m_scope = svGetScopeFromName("Vmrv1_sim_top.mrv1_sim_top");
+    assert(m_scope);
+    svPutUserData(m_scope, dpi_key(), this);
+}
+
+mrv1_soc::~mrv1_soc() {
+    delete m_rtl;
+    delete m_ctx;
+}
+
+void mrv1_soc::write_u8(uint32_t addr, uint8_t data) {
+    svSetScope(m_scope);
+    m_rtl->write_u8(addr, data);
+}
+
+uint8_t mrv1_soc::read_u8(uint32_t addr) {
+    char data;
+    svSetScope(m_scope);
+    m_rtl->read_u8(addr, &data);
+    return static_cast<uint8_t>(data);
+}
+
+uint32_t mrv1_soc::read_u32(uint32_t addr) {
+    uint8_t bytes[4];
+    read_block(addr, bytes, sizeof(bytes));
+    return (bytes[3] << 24) | (bytes[2] << 16) | (bytes[1] << 8) | bytes[0];
+}
+
+uint32_t mrv1_soc::get_ram_size_bits() const {
+    int bits;
+    svSetScope(m_scope);
+    m_rtl->get_ram_size_bits(&bits);
+    return static_cast<uint32_t>(bits);
+}
+
+uint32_t mrv1_soc::get_num_threads() const {
+    int num;
+    svSetScope(m_scope);
+    m_rtl->get_num_threads(&num);
+    return static_cast<uint32_t>(num);
+}
+
+uint64_t mrv1_soc::get_perf_counter(int idx) {
+    long long val = 0;
+    svSetScope(m_scope);
+    m_rtl->get_perf_counter(idx, &val);
+    return static_cast<uint64_t>(val);
+}
+
+uint64_t mrv1_soc::get_th_perf_counter(int tid, int idx) {
+    long long val = 0;
+    svSetScope(m_scope);
+    m_rtl->get_th_perf_counter(tid, idx, &val);
+    return static_cast<uint64_t>(val);
+}
+
+void mrv1_soc::get_perf_counters(mrv1_perf_counters& perf) {
+    for (int i = 0; i < MRV1_PERF_NUM; i++)
+        perf.v[i] = get_perf_counter(i);
+    perf.th.resize(get_num_threads());
+    for (size_t t = 0; t < perf.th.size(); t++)
+        for (int i = 0; i < MRV1_TH_PERF_NUM; i++)
+            perf.th[t].v[i] = get_th_perf_counter(t, i);
+    perf.cycles_per_sec = m_cycles_per_sec;
+}
+
+bool mrv1_soc::load_elf(const std::string& elf_path, int verbose_lvl) {
+    if (!m_elf_loader.load_data(elf_path.c_str(), get_ram_size_bits(), verbose_lvl)) {
+        std::cout << "Failed to load elf: " << elf_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void mrv1_soc::tick() {
+    m_rtl->clk_i = !m_rtl->clk_i;
+    m_rtl->eval();
+    m_rtl->clk_i = !m_rtl->clk_i;
+    m_rtl->eval();
+    m_ticks_passed++;
+}
+
+int64_t mrv1_soc::get_ticks_number() const {
+    return m_ticks_passed;
+}
+
+void mrv1_soc::reset_design() {
+    m_tohost = 0;
+    m_ctx->gotFinish(false);
+    m_rtl->clk_i = 0;
+    m_rtl->rst_i = 1;
+    tick();
+    tick();
+    m_rtl->rst_i = 0;
+}
+
+uint32_t mrv1_soc::get_tohost() const {
+    return m_tohost;
+}
+
+uint32_t mrv1_soc::get_tohost_addr() const {
+    uint32_t addr = m_elf_loader.get_address_tohost();
+    if (addr == static_cast<uint32_t>(-1) || addr + 4 > get_ram_size_bits())
+        return ~0u;
+    return addr;
+}
+
+void mrv1_soc::tohost_write(uint32_t data, uint8_t be) {
+    for (int i = 0; i < 4; i++)
+        if (be & (1 << i))
+            m_tohost = (m_tohost & ~(0xffu << (8 * i))) | (data & (0xffu << (8 * i)));
+    // the current tick still completes, counters stop with it
+    if (m_tohost != 0)
+        m_ctx->gotFinish(true);
+}
+
+void* mrv1_soc::dpi_key() {
+    static char key;
+    return &key;
+}
+
+bool mrv1_soc::run_simulation(int64_t num_cycles, int verbose_lvl) {
+    reset_design();
+
+    int64_t ccnt = 0;
+    auto start = std::chrono::steady_clock::now();
+    while ((num_cycles == -1 || ccnt < num_cycles) && !m_ctx->gotFinish()) {
+        tick();
+        ccnt++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    m_cycles_per_sec = elapsed.count() > 0 ? ccnt / elapsed.count() : 0.0;
+    m_last_run_cycles = ccnt;
+    const bool finished = m_ctx->gotFinish();
+
+    if (verbose_lvl >= 0) {
+        printf("Simulation %s in %lld cycles (%.0f cycles/sec)\n",
+               finished ? "finished" : "stopped", static_cast<long long>(ccnt), m_cycles_per_sec);
+        mrv1_perf_counters perf;
+        get_perf_counters(perf);
+        perf.print();
+    }
+    return finished;
+}
+
+int64_t mrv1_soc::get_last_run_cycles() const {
+    return m_last_run_cycles;
+}
+
+double mrv1_soc::get_cycles_per_sec() const {
+    return m_cycles_per_sec;
+}
+
+// DPI imports of mrv1_sim_top
+
+static mrv1_soc* scope_soc() {
+    return static_cast<mrv1_soc*>(svGetUserData(svGetScope(), mrv1_soc::dpi_key()));
+}
+
+extern "C" unsigned int mrv1_tohost_addr() {
+    mrv1_soc* soc = scope_soc();
+    return soc ? soc->get_tohost_addr() : ~0u;
+}
+
+extern "C" void mrv1_tohost_write(unsigned int data, unsigned char be) {
+    if (mrv1_soc* soc = scope_soc())
+        soc->tohost_write(data, be);
+}
@@ -0,0 +1,77 @@
+#ifndef __MRV1_SOC_HPP__
+#define __MRV1_SOC_HPP__
+
+#include "elf_loader.hpp"
+#include "memory_base.hpp"
+#include "mrv1_perf.hpp"
+
+#include <cstdint>
+#include <string>
+
+class Vmrv1_sim_top;
+class VerilatedContext;
+
+// Driver of the verilated mrv1_sim_top, the barrel threaded counterpart
+// of xrv1_soc. The thread count is fixed when the model is verilated
+// (NUM_THREADS_P), see get_num_threads.
+class mrv1_soc: public Mem32Iface
+{
+public:
+
+    mrv1_soc();
+    ~mrv1_soc();
+
+    void write_u8(uint32_t addr, uint8_t data) override;
+    uint8_t read_u8(uint32_t addr) override;
+    uint32_t read_u32(uint32_t addr);
+
+    uint32_t get_ram_size_bits() const;
+    // NUM_THREADS_P the model was built with
+    uint32_t get_num_threads() const;
+
+    // performance counters of mrv1_perf_counter / mrv1_th_perf_counter,
+    // zero in non-simulation builds
+    uint64_t get_perf_counter(int idx);
+    uint64_t get_th_perf_counter(int tid, int idx);
+    void get_perf_counters(mrv1_perf_counters& perf);
+
+    // load elf
+    bool load_elf(const std::string& elf_path, int verbose_lvl);
+    // hold design in reset for two cycles and release it
+    void reset_design();
+    // do one tick
+    void tick();
+    // get number of ticks passed
+    int64_t get_ticks_number() const;
+    // runs simulation from reset until num_cycles are done (-1 means no
+    // limit) or a non-zero value is written to tohost, which ends the run
+    // in the cycle of the store. verbose_lvl < 0 suppresses all output
+    bool run_simulation(int64_t num_cycles, int verbose_lvl = 0);
+    // number of cycles done by the last run_simulation call
+    int64_t get_last_run_cycles() const;
+    // simulation speed of the last run_simulation call
+    double get_cycles_per_sec() const;
+    // value written to tohost, 0 if the program has not finished
+    uint32_t get_tohost() const;
+
+    // store of the design to tohost, called by the dpi hook of the top
+    void tohost_write(uint32_t data, uint8_t be);
+    uint32_t get_tohost_addr() const;
+    // key of the svPutUserData entry pointing to the soc of the top scope
+    static void* dpi_key();
+
+private:
+    Vmrv1_sim_top* m_rtl = nullptr;
+    VerilatedContext* m_ctx = nullptr;
+    // dpi scope of the top module
+    void* m_scope = nullptr;
+    ElfLoaderArchTests m_elf_loader;
+
+    int64_t m_ticks_passed = 0;
+    // tohost as merged from the stores of the current run
+    uint32_t m_tohost = 0;
+    int64_t m_last_run_cycles = 0;
+    double m_cycles_per_sec = 0.0;
+};
+
+#endif /* __MRV1_SOC_HPP__ */
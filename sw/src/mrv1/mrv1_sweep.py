@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Runs workloads on every mrv1_sim_t<N> binary of a build directory and
+reports how aggregate throughput scales with the number of threads."""
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+
+def find_binaries(build_dir):
+    bins = {}
+    for path in glob.glob(os.path.join(build_dir, "**", "mrv1_sim_t*"), recursive=True):
+        m = re.search(r"mrv1_sim_t(\d+)$", path)
+        if m and os.access(path, os.X_OK):
+            bins[int(m.group(1))] = path
+    return dict(sorted(bins.items()))
+
+
+def run(binary, elf, cycles):
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "perf.json")
+        res = subprocess.run([binary, "-e", elf, "-c", str(cycles), "-j", out, "-q"])
+        # 2: cycle limit, 3: workload reported a failure through tohost
+        if res.returncode not in (0, 2, 3) or not os.path.exists(out):
+            return None
+        with open(out) as f:
+            perf = json.load(f)
+        perf["finished"] = res.returncode != 2
+        perf["passed"] = res.returncode == 0
+        return perf
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("elfs", nargs="+", help="workload elf files")
+    parser.add_argument("-b", "--build-dir", default=".", help="cmake build directory")
+    parser.add_argument("-c", "--cycles", type=int, default=1000000, help="cycle limit per run")
+    parser.add_argument("-o", "--output", help="write all results as json")
+    args = parser.parse_args()
+
+    bins = find_binaries(args.build_dir)
+    if not bins:
+        print("No mrv1_sim_t<N> binaries in {}, configure with -DBUILD_MRV1=ON".format(args.build_dir))
+        return 1
+
+    results = []
+    for elf in args.elfs:
+        print("{}:".format(elf))
+        print("  {:>7} {:>10} {:>10} {:>7} {:>8} {:>10} {:>10} {:>10}".format(
+            "threads", "cycles", "instret", "ipc", "speedup", "fetch_use", "issue_use", "th_ipc"))
+        base_ipc = None
+        for threads, binary in bins.items():
+            perf = run(binary, elf, args.cycles)
+            if perf is None:
+                print("  {:>7} failed".format(threads))
+                continue
+            perf["elf"] = elf
+            results.append(perf)
+
+            cycles = max(perf["cycles"], 1)
+            ipc = perf["instret"] / cycles
+            if base_ipc is None:
+                base_ipc = ipc
+            th_ipc = [t["retired"] / cycles for t in perf["per_thread"]]
+            print("  {:>7} {:>10} {:>10} {:>7.3f} {:>7.2f}x {:>9.1f}% {:>9.1f}% {:>4.2f}-{:<4.2f}{}".format(
+                threads, perf["cycles"], perf["instret"], ipc,
+                ipc / base_ipc if base_ipc else 0.0,
+                100.0 * perf["sched_used"] / cycles,
+                100.0 * perf["issue_used"] / cycles,
+                min(th_ipc), max(th_ipc),
+                "" if perf["passed"] else ("  (failed)" if perf["finished"] else "  (cycle limit)")))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
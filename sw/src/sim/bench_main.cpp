@@ -0,0 +1,168 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+#include "xrv1_soc.hpp"
+#include "isa_sim/riscv.h"
+
+// Runs the bench workloads (see bench/) on the xrv1 rtl model or on the
+// isa model and writes simulated cycles, guest ipc and host speed as json.
+// Results of all models are merged and compared by bench/run_bench.py.
+
+struct bench_result {
+    std::string elf;
+    bool finished = false;
+    // workload checked its result, exit code 0 in tohost
+    bool passed = false;
+    uint64_t cycles = 0;
+    uint64_t instret = 0;
+    double wall_time = 0.0;
+};
+
+// flat memory image the elf is loaded into for the isa model
+class bench_mem: public Mem32Iface
+{
+public:
+    explicit bench_mem(std::vector<uint8_t>& mem) : m_mem(mem) {}
+    void write_u8(uint32_t addr, uint8_t data) override { m_mem[addr] = data; }
+    uint8_t read_u8(uint32_t addr) override { return m_mem[addr]; }
+private:
+    std::vector<uint8_t>& m_mem;
+};
+
+static uint32_t read_le32(Mem32Iface& mem, uint32_t addr) {
+    uint32_t val = 0;
+    for (int i = 0; i < 4; i++)
+        val |= static_cast<uint32_t>(mem.read_u8(addr + i)) << (8 * i);
+    return val;
+}
+
+// tohost holds (exit code << 1) | 1 once the workload is done
+static bool tohost_passed(Mem32Iface& mem, uint32_t addr, uint32_t ram_size) {
+    if (addr == static_cast<uint32_t>(-1) || addr + 4 > ram_size)
+        return false;
+    return read_le32(mem, addr) == 1;
+}
+
+static void run_xrv1(xrv1_soc& soc, bench_result& res, int64_t max_cycles) {
+    soc.clear_state();
+    if (!soc.load_elf(res.elf, 0))
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    soc.run_simulation(max_cycles, -1);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    res.wall_time = elapsed.count();
+    res.cycles = soc.get_last_run_cycles();
+    // zero unless the design was built with ENABLE_SIMULATION_MODE
+    res.instret = soc.get_perf_counter(XRV1_PERF_INSTRET);
+    res.finished = soc.is_simulation_finished();
+    // the run ends at the store to tohost
+    res.passed = res.finished && soc.get_exit_code() == 0;
+}
+
+static void run_isa(bench_result& res, uint32_t ram_size, int64_t max_insns, bool jit) {
+    std::vector<uint8_t> mem(ram_size);
+    Riscv model;
+    // memory is cleared when attached, so load the image afterwards
+    if (!model.create_memory(0, ram_size, mem.data()))
+        return;
+    bench_mem img(mem);
+    ElfLoaderArchTests loader(&img);
+    if (!loader.load_data(res.elf.c_str(), ram_size, 0))
+        return;
+    model.reset(loader.get_entry_point());
+    model.set_exit_on_ctrl(false);
+    if (jit && !model.enable_jit(true))
+        printf("JIT not supported on this host, interpreting\n");
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t insns = 0;
+    while (!model.get_fault() && !model.get_stopped()) {
+        uint64_t chunk = 1000000;
+        if (max_insns != -1) {
+            if (insns >= static_cast<uint64_t>(max_insns))
+                break;
+            chunk = std::min<uint64_t>(chunk, max_insns - insns);
+        }
+        insns += model.run(chunk);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    res.wall_time = elapsed.count();
+    // the model retires one instruction per cycle
+    res.cycles = insns;
+    res.instret = insns;
+    // crt0 stops the model with ebreak
+    res.finished = model.get_stopped() && !model.get_fault();
+    res.passed = res.finished && tohost_passed(img, loader.get_address_tohost(), ram_size);
+}
+
+int main(int argc, char** argv) {
+    CLI::App app("xrv1_bench");
+    std::vector<std::string> elfs;
+    std::string model = "xrv1";
+    std::string json_path = "bench_xrv1.json";
+    int64_t max_cycles = 10000000;
+    uint32_t isa_ram_size = 1 << 20;
+    bool jit = false;
+    app.add_option("elfs", elfs, "Workload elf files")
+           ->required()
+           ->check(CLI::ExistingFile);
+    app.add_option("-m,--model", model, "Model to run on")
+           ->check(CLI::IsMember({"xrv1", "isa"}));
+    app.add_option("-c,--cycles", max_cycles, "Cycle (instruction for the isa model) limit per workload");
+    app.add_option("-o,--output", json_path, "JSON results output");
+    app.add_option("--ram-size", isa_ram_size, "Memory size of the isa model");
+    app.add_flag("--jit", jit, "Translate hot code of the isa model to host instructions");
+    CLI11_PARSE(app, argc, argv);
+
+    std::unique_ptr<xrv1_soc> soc;
+    if (model == "xrv1")
+        soc.reset(new xrv1_soc);
+
+    std::vector<bench_result> results;
+    for (const auto& elf : elfs) {
+        bench_result res;
+        res.elf = elf;
+        if (soc)
+            run_xrv1(*soc, res, max_cycles);
+        else
+            run_isa(res, isa_ram_size, max_cycles, jit);
+
+        double ipc = res.cycles ? static_cast<double>(res.instret) / res.cycles : 0.0;
+        double khz = res.wall_time > 0 ? res.cycles / res.wall_time / 1000.0 : 0.0;
+        printf("%-6s %-24s %s %12llu cycles  ipc %.3f  %10.1f kHz\n", model.c_str(),
+               std::filesystem::path(elf).stem().string().c_str(),
+               res.passed ? "PASS" : (res.finished ? "FAIL" : "TIMEOUT"),
+               static_cast<unsigned long long>(res.cycles), ipc, khz);
+        results.push_back(res);
+    }
+
+    FILE* fp = fopen(json_path.c_str(), "w");
+    if (!fp) {
+        printf("Failed to open %s\n", json_path.c_str());
+        return 1;
+    }
+    size_t passed = 0;
+    fprintf(fp, "[\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& res = results[i];
+        double ipc = res.cycles ? static_cast<double>(res.instret) / res.cycles : 0.0;
+        double khz = res.wall_time > 0 ? res.cycles / res.wall_time / 1000.0 : 0.0;
+        fprintf(fp, "  {\"model\": \"%s\", \"workload\": \"%s\", \"finished\": %s, \"passed\": %s, "
+                    "\"cycles\": %llu, \"instret\": %llu, \"ipc\": %.4f, \"khz\": %.1f, \"wall_time\": %.4f}%s\n",
+                model.c_str(), std::filesystem::path(res.elf).stem().string().c_str(),
+                res.finished ? "true" : "false", res.passed ? "true" : "false",
+                static_cast<unsigned long long>(res.cycles), static_cast<unsigned long long>(res.instret),
+                ipc, khz, res.wall_time, i + 1 < results.size() ? "," : "");
+        passed += res.passed;
+    }
+    fprintf(fp, "]\n");
+    fclose(fp);
+    return passed == results.size() ? 0 : 1;
+}
@@ -1,5 +1,16 @@
 #include "elf_loader.hpp"
 #include <cassert>
+#include <vector>
+
+// FNV-1a hash, used to compare loaded sections against memory image
+static uint32_t fnv1a_32(const uint8_t* data, size_t size) {
+    uint32_t hash = 0x811c9dc5;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
 
 
 ElfLoader::ElfLoader(const char* filename, Mem32Iface* mem_img) :
@@ -35,26 +46,41 @@ bool ElfLoader::load(int verbose_lvl) {
                 printf("Memory: 0x%x - 0x%x (Size=%dKB)\n", sec_addr, sec_addr + sec_size - 1, sec_size / 1024);
 
             if (sec->get_type() == ELFIO::SHT_PROGBITS) {
-                for (uint32_t j = 0; j < sec_size; j++) {
-                    if (verbose_lvl > 2)
+                if (verbose_lvl > 2) {
+                    for (uint32_t j = 0; j < sec_size; j++)
                         printf("MEM[0x%x] <- 0x%x\n", sec_addr +j , static_cast<uint8_t>(sec_data[j]));
-                    m_mem_img->write_u8(sec_addr + j, sec_data[j]);
-                    byte_written++;
                 }
+                m_mem_img->write_block(sec_addr, reinterpret_cast<const uint8_t*>(sec_data), sec_size);
+                byte_written += sec_size;
                 // revalidate ram image
-                for (uint32_t j = 0; j < sec_size; j++) {
-                    uint8_t r = m_mem_img->read_u8(sec_addr + j);
-                    if (r != static_cast<uint8_t>(sec_data[j])) {
-                        printf("At MEM[0x%x] expected value is 0x%x but got 0x%x\n", sec_addr + j, static_cast<uint8_t>(sec_data[j]), r);
-                        return false;
-                    }
-                }
+                if (m_verify && !verify_section(sec_addr, sec_data, sec_size))
+                    return false;
             }
         }
     }
     return true;
 }
 
+void ElfLoader::set_verify(bool verify) {
+    m_verify = verify;
+}
+
+bool ElfLoader::verify_section(uint32_t sec_addr, const char* sec_data, uint32_t sec_size) {
+    const uint8_t* expected = reinterpret_cast<const uint8_t*>(sec_data);
+    std::vector<uint8_t> readback(sec_size);
+    m_mem_img->read_block(sec_addr, readback.data(), sec_size);
+    if (fnv1a_32(readback.data(), sec_size) == fnv1a_32(expected, sec_size))
+        return true;
+    // find first mismatch to report it
+    for (uint32_t j = 0; j < sec_size; j++) {
+        if (readback[j] != expected[j]) {
+            printf("At MEM[0x%x] expected value is 0x%x but got 0x%x\n", sec_addr + j, expected[j], readback[j]);
+            break;
+        }
+    }
+    return false;
+}
+
 ElfLoaderArchTests::ElfLoaderArchTests(Mem32Iface* mem_img) :
     ElfLoader("", mem_img)
 {
@@ -86,7 +112,20 @@ uint32_t ElfLoaderArchTests::get_address_fromhost() const {
     return m_section_addr_fromhost;
 }
 
+void ElfLoaderArchTests::set_section_addresses(uint32_t tohost, uint32_t fromhost, uint32_t sig_begin, uint32_t sig_end) {
+    m_section_addr_tohost = tohost;
+    m_section_addr_fromhost = fromhost;
+    m_section_addr_sig_begin = sig_begin;
+    m_section_addr_sig_end = sig_end;
+}
+
 void ElfLoaderArchTests::fill_section_addresses(int verbose_lvl) {
+    // forget addresses of previously loaded elf
+    m_section_addr_fromhost = -1;
+    m_section_addr_tohost = -1;
+    m_section_addr_sig_begin = -1;
+    m_section_addr_sig_end = -1;
+
     for (size_t i = 0; i < m_reader.sections.size(); i++) {
         ELFIO::section* sec = m_reader.sections[i];
         const std::string sec_name{sec->get_name()};
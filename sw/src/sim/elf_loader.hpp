@@ -11,11 +11,20 @@ public:
     ElfLoader(const char* filename, Mem32Iface* mem_img);
 
     bool load(int verbose_lvl = 0);
+    // enable/disable checksum check of loaded sections
+    void set_verify(bool verify);
+    // entry point of the last loaded elf
+    uint32_t get_entry_point() const { return m_entry_point; }
 private:
     ELFIO::elfio m_reader;
     std::string m_filename;
     Mem32Iface* m_mem_img = nullptr;
     uint32_t m_entry_point = 0;
+    // read back every loaded section and compare checksums
+    bool m_verify = true;
+
+    // check that section data landed in memory image
+    bool verify_section(uint32_t sec_addr, const char* sec_data, uint32_t sec_size);
 
     friend class ElfLoaderArchTests;
 };
@@ -36,6 +45,8 @@ public:
     uint32_t get_address_tohost() const;
     // get address of "fromhost" section
     uint32_t get_address_fromhost() const;
+    // set section addresses without loading elf, e.g. from a checkpoint
+    void set_section_addresses(uint32_t tohost, uint32_t fromhost, uint32_t sig_begin, uint32_t sig_end);
 private:
     // for riscv arch tests we define several sections to interact
     // between host and dut
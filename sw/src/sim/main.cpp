@@ -10,21 +10,34 @@ static xrv1_tb* tb = nullptr;
 int sc_main(int argc, char** argv) {
 
     CLI::App app("xrv1_tb");
-    std::string elf_filename;
-    uint64_t cycle_count = 100;
-    app.add_option("-e,--elf", elf_filename, "Executable elf file")
+    xrv1_tb_cfg cfg;
+    app.add_option("-e,--elf", cfg.elf_filename, "Executable elf file")
            ->required()
            ->check(CLI::ExistingFile);
-    app.add_option("-c,--cycles", cycle_count, "Cycle count to run");
+    app.add_option("-c,--cycles", cfg.cycle_count, "Cycle count to run, -1 runs until $finish");
+    app.add_option("-q,--quantum", cfg.quantum,
+                   "Cycles run per SystemC activation, 0 steps the model on every clock edge");
+    app.add_flag("-v,--verbose", cfg.verbose, "Print the pipeline every cycle (needs --quantum 0)");
     CLI11_PARSE(app, argc, argv);
 
-    sc_clock clk ("clk_i", 10, SC_NS);
+    // Testbench
+    tb = new xrv1_tb ("tb", cfg);
+
+    if (cfg.quantum > 0) {
+        // the decoupled dut keeps its own time, no clock events needed
+        static sc_signal<bool> clk("clk_i");
+        static sc_signal<bool> rst("rst_i");
+        tb->clk(clk);
+        tb->rst(rst);
+        sc_start();
+        return 0;
+    }
+
+    sc_clock clk ("clk_i", cfg.period_ns, SC_NS);
 
     xrv1_rst_gen rst_gen("rst_i");
     rst_gen.clk(clk);
 
-    // Testbench
-    tb = new xrv1_tb ("tb", elf_filename, cycle_count);
     tb->clk(clk);
     tb->rst(rst_gen.rst);
 
@@ -1,6 +1,9 @@
 #ifndef __XRV1_MEMORY_BASE_HPP__
 #define __XRV1_MEMORY_BASE_HPP__
 
+#include <cstdint>
+#include <cstddef>
+
 class Mem32Iface
 {
 public:
@@ -8,6 +11,17 @@ public:
     //virtual bool valid_addr(uint32_t addr) = 0;
     virtual void write_u8(uint32_t addr, uint8_t data) = 0;
     virtual uint8_t read_u8(uint32_t addr) = 0;
+
+    // block transfers, implementations with direct access to the
+    // memory image should override these
+    virtual void write_block(uint32_t addr, const uint8_t* data, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            write_u8(addr + i, data[i]);
+    }
+    virtual void read_block(uint32_t addr, uint8_t* data, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            data[i] = read_u8(addr + i);
+    }
 };
 
 #endif /* __XRV1_MEMORY_BASE_HPP__ */
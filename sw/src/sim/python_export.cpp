@@ -1,25 +1,360 @@
 #include <boost/python.hpp>
 #include <boost/python/enum.hpp>
+#include <boost/python/numpy.hpp>
 
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <type_traits>
+#include <vector>
 
 #include "xrv1_soc.hpp"
+#include "xrv1_sampler.hpp"
+#include "xrv1_perf.hpp"
+#include "xrv1_coverage.hpp"
 
-BOOST_PYTHON_MODULE(libdut)
+// fast and debug models are separate modules, libdut and libdut_debug
+#ifndef XRV1_PY_MODULE
+#define XRV1_PY_MODULE libdut
+#endif
+
+namespace np = boost::python::numpy;
+
+// Long running calls drop the GIL, so several instances can simulate on
+// python threads at the same time. The instance mutex is taken after the
+// GIL is released, a thread waiting for a busy instance doesn't block others.
+class gil_release {
+public:
+    gil_release() : m_state(PyEval_SaveThread()) {}
+    ~gil_release() { PyEval_RestoreThread(m_state); }
+private:
+    PyThreadState* m_state;
+};
+
+template <typename Fn>
+static auto nogil(xrv1_soc& soc, Fn fn)
+{
+    gil_release release;
+    std::lock_guard<std::mutex> lock(soc.m_mutex);
+    return fn();
+}
+
+// instance whose mutex guards an object, the sampler drives its dut
+static xrv1_soc& soc_of(xrv1_soc& soc) { return soc; }
+static xrv1_soc& soc_of(xrv1_sampler& sampler) { return sampler.get_soc(); }
+
+// Binds a member function through nogil. Every call which touches the
+// design goes through the instance mutex, so it waits for a
+// run_simulation_async still in flight instead of racing with it.
+// References are returned as copies taken under the lock.
+template <auto Fn>
+struct locked;
+
+template <typename T, typename R, typename... Args, R (T::*Fn)(Args...)>
+struct locked<Fn> {
+    static std::decay_t<R> call(T& obj, Args... args)
+    {
+        return nogil(soc_of(obj), [&]() -> std::decay_t<R> { return (obj.*Fn)(args...); });
+    }
+};
+
+template <typename T, typename R, typename... Args, R (T::*Fn)(Args...) const>
+struct locked<Fn> {
+    static std::decay_t<R> call(T& obj, Args... args)
+    {
+        return nogil(soc_of(obj), [&]() -> std::decay_t<R> { return (obj.*Fn)(args...); });
+    }
+};
+
+// all performance counters of the last run keyed by counter name
+static boost::python::dict get_perf_counters(xrv1_soc& soc)
+{
+    xrv1_perf_counters perf;
+    nogil(soc, [&] { soc.get_perf_counters(perf); });
+    boost::python::dict res;
+    for (int i = 0; i < XRV1_PERF_NUM; i++)
+        res[xrv1_perf_counters::name(i)] = perf[i];
+    return res;
+}
+
+// memory timing statistics of the last run per port, empty if not built in
+static boost::python::dict get_mem_timing_stats(xrv1_soc& soc)
+{
+    boost::python::dict res;
+    std::vector<xrv1_mem_port_stats> stats;
+    nogil(soc, [&] {
+        if (const xrv1_mem_timing* timing = soc.get_mem_timing())
+            for (int i = 0; i < xrv1_mem_timing::NUM_PORTS; i++)
+                stats.push_back(timing->get_stats(i));
+    });
+    for (size_t i = 0; i < stats.size(); i++) {
+        const xrv1_mem_port_stats& s = stats[i];
+        boost::python::dict port;
+        port["accesses"] = s.accesses;
+        port["writes"] = s.writes;
+        port["hits"] = s.hits;
+        port["misses"] = s.misses;
+        port["avg_latency"] = s.avg_latency();
+        port["max_latency"] = s.max_latency;
+        port["bank_conflicts"] = s.bank_conflicts;
+        port["stalls"] = s.stalls;
+        res[xrv1_mem_timing::port_name(i)] = port;
+    }
+    return res;
+}
+
+static void tick(xrv1_soc& soc)
+{
+    nogil(soc, [&] { soc.tick(); });
+}
+
+static bool load_elf(xrv1_soc& soc, const std::string& path, int verbose_lvl)
+{
+    return nogil(soc, [&] { return soc.load_elf(path, verbose_lvl); });
+}
+
+static bool run_simulation(xrv1_soc& soc, int num_cycles, int verbose_lvl)
+{
+    return nogil(soc, [&] { return soc.run_simulation(num_cycles, verbose_lvl); });
+}
+
+static bool continue_simulation(xrv1_soc& soc, int num_cycles, int verbose_lvl)
+{
+    return nogil(soc, [&] { return soc.continue_simulation(num_cycles, verbose_lvl); });
+}
+
+static bool save_checkpoint(xrv1_soc& soc, const std::string& path)
+{
+    return nogil(soc, [&] { return soc.save_checkpoint(path); });
+}
+
+static bool restore_checkpoint(xrv1_soc& soc, const std::string& path)
+{
+    return nogil(soc, [&] { return soc.restore_checkpoint(path); });
+}
+
+// thread pool of the async calls, created on first use
+static boost::python::object async_executor()
+{
+    using namespace boost::python;
+    object module = import(BOOST_PP_STRINGIZE(XRV1_PY_MODULE));
+    object executor = module.attr("_executor");
+    if (executor.is_none()) {
+        executor = import("concurrent.futures").attr("ThreadPoolExecutor")();
+        module.attr("_executor") = executor;
+    }
+    return executor;
+}
+
+// run_simulation on a pool thread, returns a concurrent.futures.Future
+// (awaitable from asyncio through asyncio.wrap_future)
+static boost::python::object run_simulation_async(boost::python::object self, int num_cycles, int verbose_lvl)
+{
+    return async_executor().attr("submit")(self.attr("run_simulation"), num_cycles, verbose_lvl);
+}
+
+static void raise_error(PyObject* type, const char* msg)
+{
+    PyErr_SetString(type, msg);
+    boost::python::throw_error_already_set();
+}
+
+// sums coverage.dat files (or directories of them) into out_path, returns
+// the number of points
+static size_t merge_coverage(boost::python::list inputs, const std::string& out_path)
+{
+    xrv1_coverage cov;
+    for (long i = 0; i < boost::python::len(inputs); i++) {
+        const std::string input = boost::python::extract<std::string>(inputs[i]);
+        const bool ok = std::filesystem::is_directory(input) ? cov.merge_dir(input) >= 0 : cov.merge_file(input);
+        if (!ok)
+            raise_error(PyExc_IOError, ("failed to read coverage " + input).c_str());
+    }
+    if (!cov.write(out_path))
+        raise_error(PyExc_IOError, ("failed to write " + out_path).c_str());
+    return cov.get_num_points();
+}
+
+// one numpy array of n values per record field, filled by get(rec)
+template <typename T, typename Get>
+static np::ndarray rec_field(const std::vector<xrv1_commit_rec>& recs, Get get)
+{
+    np::ndarray arr = np::empty(boost::python::make_tuple(recs.size()), np::dtype::get_builtin<T>());
+    T* data = reinterpret_cast<T*>(arr.get_data());
+    for (size_t i = 0; i < recs.size(); i++)
+        data[i] = get(recs[i]);
+    return arr;
+}
+
+// runs n cycles and returns the retired instructions as a dict of arrays
+static boost::python::dict step(xrv1_soc& soc, int64_t num_cycles)
+{
+    std::vector<xrv1_commit_rec> recs;
+    nogil(soc, [&] { return soc.step(num_cycles, recs); });
+    boost::python::dict res;
+    res["cycle"] = rec_field<uint64_t>(recs, [](const xrv1_commit_rec& r) { return r.cycle; });
+    res["pc"] = rec_field<uint32_t>(recs, [](const xrv1_commit_rec& r) { return r.pc; });
+    res["insn"] = rec_field<uint32_t>(recs, [](const xrv1_commit_rec& r) { return r.insn; });
+    res["wb"] = rec_field<bool>(recs, [](const xrv1_commit_rec& r) { return (r.flags & XRV1_CLOG_F_WB) != 0; });
+    res["rd"] = rec_field<uint8_t>(recs, [](const xrv1_commit_rec& r) { return r.rd; });
+    res["wb_data"] = rec_field<uint32_t>(recs, [](const xrv1_commit_rec& r) { return r.wb_data; });
+    return res;
+}
+
+// uint8 array over the ram image, writes go straight to the design memory.
+// The view keeps the dut object alive. Accesses through it don't take the
+// instance mutex, it mustn't be used while a run is in flight
+static np::ndarray mem_view(boost::python::object self)
+{
+    xrv1_soc& soc = boost::python::extract<xrv1_soc&>(self);
+    uint8_t* ram = nogil(soc, [&] { return soc.get_ram_ptr(); });
+    if (!ram)
+        raise_error(PyExc_RuntimeError, "ram image is not mapped, use read_mem/write_mem");
+    return np::from_data(ram, np::dtype::get_builtin<uint8_t>(),
+                         boost::python::make_tuple(soc.get_ram_size_bits()),
+                         boost::python::make_tuple(1), self);
+}
+
+static np::ndarray read_mem(xrv1_soc& soc, uint32_t addr, uint32_t size)
+{
+    uint32_t ram_size = soc.get_ram_size_bits();
+    if (addr > ram_size || size > ram_size - addr)
+        raise_error(PyExc_IndexError, "read_mem out of ram");
+    np::ndarray arr = np::empty(boost::python::make_tuple(size), np::dtype::get_builtin<uint8_t>());
+    uint8_t* data = reinterpret_cast<uint8_t*>(arr.get_data());
+    nogil(soc, [&] { soc.read_block(addr, data, size); });
+    return arr;
+}
+
+// copies the raw bytes of any contiguous buffer (bytes, bytearray, ndarray)
+static void write_mem(xrv1_soc& soc, uint32_t addr, boost::python::object data)
+{
+    Py_buffer view;
+    if (PyObject_GetBuffer(data.ptr(), &view, PyBUF_C_CONTIGUOUS) != 0)
+        boost::python::throw_error_already_set();
+    uint32_t ram_size = soc.get_ram_size_bits();
+    size_t size = static_cast<size_t>(view.len);
+    bool fits = addr <= ram_size && size <= ram_size - addr;
+    // the buffer is held by view while the GIL is released
+    if (fits)
+        nogil(soc, [&] { soc.write_block(addr, static_cast<const uint8_t*>(view.buf), size); });
+    PyBuffer_Release(&view);
+    if (!fits)
+        raise_error(PyExc_IndexError, "write_mem out of ram");
+}
+
+static np::ndarray get_regs(xrv1_soc& soc)
+{
+    np::ndarray arr = np::empty(boost::python::make_tuple(32), np::dtype::get_builtin<uint32_t>());
+    uint32_t* regs = reinterpret_cast<uint32_t*>(arr.get_data());
+    nogil(soc, [&] { soc.get_regs(regs); });
+    return arr;
+}
+
+BOOST_PYTHON_MODULE(XRV1_PY_MODULE)
 {
     using namespace boost::python;
 
+    np::initialize();
+    scope().attr("_executor") = object();
+    scope().attr("FLAVOR") = xrv1_soc::get_flavor();
+    scope().attr("HAS_COVERAGE") = xrv1_soc::has_coverage();
+
+    def("merge_coverage", &merge_coverage);
+
+    enum_<xrv1_trace_mode>("TraceMode")
+        .value("OFF", xrv1_trace_mode::OFF)
+        .value("VCD", xrv1_trace_mode::VCD)
+        .value("FST", xrv1_trace_mode::FST);
+
+    class_<xrv1_trace_cfg>("TraceConfig")
+        .def_readwrite("mode", &xrv1_trace_cfg::mode)
+        .def_readwrite("path", &xrv1_trace_cfg::path)
+        .def_readwrite("start_cycle", &xrv1_trace_cfg::start_cycle)
+        .def_readwrite("stop_cycle", &xrv1_trace_cfg::stop_cycle)
+        .def_readwrite("start_pc", &xrv1_trace_cfg::start_pc)
+        .def_readwrite("start_retire", &xrv1_trace_cfg::start_retire)
+        .def_readwrite("depth", &xrv1_trace_cfg::depth);
+
+    class_<xrv1_cache_cfg>("CacheConfig")
+        .def_readwrite("enable", &xrv1_cache_cfg::enable)
+        .def_readwrite("size", &xrv1_cache_cfg::size)
+        .def_readwrite("ways", &xrv1_cache_cfg::ways)
+        .def_readwrite("line_size", &xrv1_cache_cfg::line_size)
+        .def_readwrite("hit_latency", &xrv1_cache_cfg::hit_latency)
+        .def_readwrite("miss_penalty", &xrv1_cache_cfg::miss_penalty);
+
+    class_<xrv1_mem_timing_cfg>("MemTimingConfig")
+        .def_readwrite("latency", &xrv1_mem_timing_cfg::latency)
+        .def_readwrite("latency_max", &xrv1_mem_timing_cfg::latency_max)
+        .def_readwrite("seed", &xrv1_mem_timing_cfg::seed)
+        .def_readwrite("max_outstanding", &xrv1_mem_timing_cfg::max_outstanding)
+        .def_readwrite("num_banks", &xrv1_mem_timing_cfg::num_banks)
+        .def_readwrite("bank_busy", &xrv1_mem_timing_cfg::bank_busy)
+        // by reference, so that cfg.icache.enable = True changes cfg
+        .add_property("icache", make_getter(&xrv1_mem_timing_cfg::icache, return_internal_reference<>()),
+                      make_setter(&xrv1_mem_timing_cfg::icache))
+        .add_property("dcache", make_getter(&xrv1_mem_timing_cfg::dcache, return_internal_reference<>()),
+                      make_setter(&xrv1_mem_timing_cfg::dcache));
+
     class_<xrv1_soc, boost::noncopyable>("XRV1", init<>())
-        .def("release_reset", &xrv1_soc::release_reset)
-        .def("get_reset_status", &xrv1_soc::get_reset_status)
-        .def("tick", &xrv1_soc::tick)
-        .def("get_ticks_number", &xrv1_soc::get_ticks_number)
-        .def("load_elf", &xrv1_soc::load_elf)
-        .def("run_simulation", &xrv1_soc::run_simulation)
-        .def("read_byte", &xrv1_soc::read_u8)
-        .def("read_short", &xrv1_soc::read_u16)
-        .def("read_word", &xrv1_soc::read_u32)
-        .def("dump_signature", &xrv1_soc::dump_signature)
-        .def("is_sim_finished", &xrv1_soc::is_simulation_finished)
-        .def("get_reg_val", &xrv1_soc::get_reg_val_u32);
-}
\ No newline at end of file
+        .def("release_reset", &locked<&xrv1_soc::release_reset>::call)
+        .def("get_reset_status", &locked<&xrv1_soc::get_reset_status>::call)
+        .def("tick", &tick)
+        .def("reset_design", &locked<&xrv1_soc::reset_design>::call)
+        .def("step", &step)
+        .def("get_ticks_number", &locked<&xrv1_soc::get_ticks_number>::call)
+        .def("load_elf", &load_elf)
+        .def("run_simulation", &run_simulation)
+        .def("run_simulation_async", &run_simulation_async)
+        .def("continue_simulation", &continue_simulation)
+        .def("save_checkpoint", &save_checkpoint)
+        .def("restore_checkpoint", &restore_checkpoint)
+        .def("get_cycles_per_sec", &locked<&xrv1_soc::get_cycles_per_sec>::call)
+        .def("set_trace", &locked<&xrv1_soc::set_trace>::call)
+        .def("set_commit_log", &locked<&xrv1_soc::set_commit_log>::call)
+        .def("set_mem_timing", &locked<&xrv1_soc::set_mem_timing>::call)
+        .def("get_mem_timing_stats", &get_mem_timing_stats)
+        .def("get_exit_code", &locked<&xrv1_soc::get_exit_code>::call)
+        .def("get_console", &locked<&xrv1_soc::get_console>::call)
+        .def("set_console_echo", &locked<&xrv1_soc::set_console_echo>::call)
+        .def("write_coverage", &locked<&xrv1_soc::write_coverage>::call)
+        .def("clear_coverage", &locked<&xrv1_soc::clear_coverage>::call)
+        .def("set_cosim", &locked<&xrv1_soc::set_cosim>::call)
+        .def("set_cosim_async", &locked<&xrv1_soc::set_cosim_async>::call)
+        .def("get_cosim_report", &locked<&xrv1_soc::get_cosim_report>::call)
+        .def("read_byte", &locked<&xrv1_soc::read_u8>::call)
+        .def("read_short", &locked<&xrv1_soc::read_u16>::call)
+        .def("read_word", &locked<&xrv1_soc::read_u32>::call)
+        .def("dump_signature", &locked<&xrv1_soc::dump_signature>::call)
+        .def("is_sim_finished", &locked<&xrv1_soc::is_simulation_finished>::call)
+        .def("read_mem", &read_mem)
+        .def("write_mem", &write_mem)
+        .def("mem_view", &mem_view)
+        .def("get_reg_val", &locked<&xrv1_soc::get_reg_val_u32>::call)
+        .def("get_regs", &get_regs)
+        .def("set_reg_val", &locked<&xrv1_soc::set_reg_val_u32>::call)
+        .def("set_csr_val", &locked<&xrv1_soc::set_csr_val_u32>::call)
+        .def("set_start_pc", &locked<&xrv1_soc::set_start_pc>::call)
+        .def("clear_state", &locked<&xrv1_soc::clear_state>::call)
+        .def("get_last_run_cycles", &locked<&xrv1_soc::get_last_run_cycles>::call)
+        .def("get_perf_counter", &locked<&xrv1_soc::get_perf_counter>::call)
+        .def("get_perf_counters", &get_perf_counters);
+
+    class_<xrv1_sample_cfg>("SampleConfig")
+        .def_readwrite("skip_insns", &xrv1_sample_cfg::skip_insns)
+        .def_readwrite("start_pc", &xrv1_sample_cfg::start_pc)
+        .def_readwrite("interval_insns", &xrv1_sample_cfg::interval_insns)
+        .def_readwrite("warmup_cycles", &xrv1_sample_cfg::warmup_cycles)
+        .def_readwrite("window_cycles", &xrv1_sample_cfg::window_cycles)
+        .def_readwrite("num_windows", &xrv1_sample_cfg::num_windows);
+
+    // sampler keeps a reference to the dut
+    class_<xrv1_sampler, boost::noncopyable>("Sampler", init<xrv1_soc&>()[with_custodian_and_ward<1, 2>()])
+        .def("init", &locked<&xrv1_sampler::init>::call)
+        .def("run", &locked<&xrv1_sampler::run>::call)
+        .def("get_num_windows", &locked<&xrv1_sampler::get_num_windows>::call)
+        .def("get_window_ipc", &locked<&xrv1_sampler::get_window_ipc>::call)
+        .def("get_ipc", &locked<&xrv1_sampler::get_ipc>::call)
+        .def("get_model_insns", &locked<&xrv1_sampler::get_model_insns>::call);
+}
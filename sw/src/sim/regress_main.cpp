@@ -0,0 +1,243 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+#include "xrv1_soc.hpp"
+#include "xrv1_coverage.hpp"
+
+// Runs a list of elf tests on a pool of threads. Every thread owns one
+// model instance and reuses it for all the tests it picks up.
+
+struct regress_test {
+    std::string elf;
+    // expected arch test signature, optional
+    std::string ref_sig;
+
+    // results
+    bool passed = false;
+    std::string reason;
+    int64_t cycles = 0;
+    // written to tohost, -1 if the test didn't exit that way
+    int exit_code = -1;
+    double wall_time = 0.0;
+};
+
+static bool read_test_list(const std::string& path, std::vector<regress_test>& tests) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        regress_test test;
+        if (!(ss >> test.elf) || test.elf[0] == '#')
+            continue;
+        ss >> test.ref_sig;
+        tests.push_back(test);
+    }
+    return true;
+}
+
+static bool read_file(const std::string& path, std::string& data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    data = ss.str();
+    return true;
+}
+
+static std::string json_escape(const std::string& str) {
+    std::string res;
+    for (char c : str) {
+        switch (c) {
+        case '"':  res += "\\\""; break;
+        case '\\': res += "\\\\"; break;
+        case '\n': res += "\\n"; break;
+        case '\t': res += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                res += buf;
+            } else {
+                res += c;
+            }
+        }
+    }
+    return res;
+}
+
+static std::string test_file(const regress_test& test, size_t idx, const std::string& dir, const char* ext) {
+    return dir + "/" + std::to_string(idx) + "_" + std::filesystem::path(test.elf).stem().string() + ext;
+}
+
+static void run_test(xrv1_soc& soc, regress_test& test, size_t idx, int64_t max_cycles,
+                     bool cosim, const std::string& sig_dir, const std::string& cov_dir) {
+    auto start = std::chrono::steady_clock::now();
+
+    soc.clear_state();
+    if (!cov_dir.empty())
+        soc.clear_coverage();
+    if (!soc.load_elf(test.elf, 0)) {
+        test.reason = "failed to load elf";
+    } else {
+        soc.set_cosim(cosim);
+        bool ok = soc.run_simulation(max_cycles, -1);
+        test.cycles = soc.get_last_run_cycles();
+        test.exit_code = soc.get_exit_code();
+        if (!ok) {
+            test.reason = soc.get_cosim_report();
+            if (test.reason.empty())
+                test.reason = "simulation failed";
+        } else if (!soc.is_simulation_finished()) {
+            test.reason = "timeout";
+        } else if (test.exit_code > 0) {
+            test.reason = "exit code " + std::to_string(test.exit_code);
+        } else if (!test.ref_sig.empty()) {
+            const std::string sig_path = test_file(test, idx, sig_dir, ".sig");
+            std::string sig, ref;
+            if (!soc.dump_signature(sig_path, 0))
+                test.reason = "no signature";
+            else if (!read_file(test.ref_sig, ref))
+                test.reason = "failed to read reference signature";
+            else if (!read_file(sig_path, sig) || sig != ref)
+                test.reason = "signature mismatch";
+            else
+                test.passed = true;
+        } else {
+            test.passed = true;
+        }
+    }
+
+    // every test gets its own file, they're merged when all are done
+    if (!cov_dir.empty() && !soc.write_coverage(test_file(test, idx, cov_dir, ".dat")))
+        printf("Failed to write coverage of %s\n", test.elf.c_str());
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    test.wall_time = elapsed.count();
+}
+
+int main(int argc, char** argv) {
+    CLI::App app("xrv1_regress");
+    std::string list_path;
+    std::string json_path = "regress.json";
+    std::string sig_dir = "regress_sig";
+    int64_t max_cycles = 100000;
+    unsigned jobs = std::thread::hardware_concurrency();
+    bool cosim = false;
+    std::string cov_dir;
+    app.add_option("-l,--list", list_path, "Test list, one '<elf> [reference signature]' per line")
+           ->required()
+           ->check(CLI::ExistingFile);
+    app.add_option("-j,--jobs", jobs, "Number of worker threads");
+    app.add_option("-c,--cycles", max_cycles, "Cycle limit per test");
+    app.add_option("-o,--output", json_path, "JSON summary output");
+    app.add_option("-s,--sig-dir", sig_dir, "Directory for dumped signatures");
+    app.add_flag("--cosim", cosim, "Check tests against isa model");
+    app.add_option("--coverage", cov_dir, "Directory for per test and merged coverage (debug model)");
+    CLI11_PARSE(app, argc, argv);
+
+    if (!cov_dir.empty() && !xrv1_soc::has_coverage()) {
+        printf("--coverage needs the debug model (xrv1_regress_debug), this is the %s one\n",
+               xrv1_soc::get_flavor());
+        return 1;
+    }
+
+    std::vector<regress_test> tests;
+    if (!read_test_list(list_path, tests)) {
+        printf("Failed to read test list %s\n", list_path.c_str());
+        return 1;
+    }
+    std::filesystem::create_directories(sig_dir);
+    if (!cov_dir.empty())
+        std::filesystem::create_directories(cov_dir);
+
+    if (jobs == 0)
+        jobs = 1;
+    if (jobs > tests.size())
+        jobs = tests.size() > 0 ? tests.size() : 1;
+
+    // models are created up front, each worker keeps its own
+    std::vector<std::unique_ptr<xrv1_soc>> models;
+    for (unsigned i = 0; i < jobs; i++) {
+        models.emplace_back(new xrv1_soc);
+        // console output of parallel tests would be interleaved
+        models.back()->set_console_echo(false);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> next_test{0};
+    std::atomic<size_t> done_tests{0};
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < jobs; i++) {
+        workers.emplace_back([&, i]() {
+            while (true) {
+                size_t idx = next_test++;
+                if (idx >= tests.size())
+                    break;
+                run_test(*models[i], tests[idx], idx, max_cycles, cosim, sig_dir, cov_dir);
+                size_t done = ++done_tests;
+                printf("[%zu/%zu] %s %s\n", done, tests.size(),
+                       tests[idx].passed ? "PASS" : "FAIL", tests[idx].elf.c_str());
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t passed = 0;
+    for (const auto& test : tests)
+        passed += test.passed;
+
+    FILE* fp = fopen(json_path.c_str(), "w");
+    if (!fp) {
+        printf("Failed to open %s\n", json_path.c_str());
+        return 1;
+    }
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"total\": %zu,\n", tests.size());
+    fprintf(fp, "  \"passed\": %zu,\n", passed);
+    fprintf(fp, "  \"failed\": %zu,\n", tests.size() - passed);
+    fprintf(fp, "  \"jobs\": %u,\n", jobs);
+    fprintf(fp, "  \"wall_time\": %.3f,\n", elapsed.count());
+    fprintf(fp, "  \"tests\": [\n");
+    for (size_t i = 0; i < tests.size(); i++) {
+        const auto& test = tests[i];
+        fprintf(fp, "    {\"elf\": \"%s\", \"status\": \"%s\", \"reason\": \"%s\", \"cycles\": %lld, \"exit_code\": %d, \"wall_time\": %.3f}%s\n",
+                json_escape(test.elf).c_str(), test.passed ? "pass" : "fail", json_escape(test.reason).c_str(),
+                static_cast<long long>(test.cycles), test.exit_code, test.wall_time, i + 1 < tests.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+    fclose(fp);
+
+    if (!cov_dir.empty()) {
+        xrv1_coverage cov;
+        for (size_t i = 0; i < tests.size(); i++) {
+            const std::string path = test_file(tests[i], i, cov_dir, ".dat");
+            if (!cov.merge_file(path))
+                printf("Failed to read coverage %s\n", path.c_str());
+        }
+        // not a .dat, so that merging the directory again doesn't count it twice
+        const std::string merged_path = cov_dir + "/merged.cov";
+        if (cov.write(merged_path))
+            printf("Merged coverage written to %s\n", merged_path.c_str());
+        cov.print();
+    }
+
+    printf("%zu/%zu tests passed in %.1fs\n", passed, tests.size(), elapsed.count());
+    return passed == tests.size() ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#include "xrv1_commit_log.hpp"
+
+#include <cstring>
+
+bool xrv1_insn_writes_rd(uint32_t insn) {
+    if (((insn >> 7) & 0x1f) == 0)
+        return false;
+    switch (insn & 0x7f) {
+    case 0x37:  // LUI
+    case 0x17:  // AUIPC
+    case 0x6f:  // JAL
+    case 0x67:  // JALR
+    case 0x03:  // LOAD
+    case 0x13:  // OP-IMM
+    case 0x33:  // OP
+        return true;
+    case 0x73:  // SYSTEM, only csr accesses write rd
+        return ((insn >> 12) & 0x7) != 0;
+    default:
+        return false;
+    }
+}
+
+xrv1_commit_log::~xrv1_commit_log() {
+    close();
+}
+
+bool xrv1_commit_log::open(const std::string& path) {
+    close();
+    m_fp = fopen(path.c_str(), "wb");
+    if (!m_fp) {
+        printf("Failed to open commit log: %s\n", path.c_str());
+        return false;
+    }
+
+    xrv1_clog_header hdr;
+    memcpy(hdr.magic, XRV1_CLOG_MAGIC, sizeof(hdr.magic));
+    hdr.version = XRV1_CLOG_VERSION;
+    hdr.rec_size = sizeof(xrv1_commit_rec);
+    fwrite(&hdr, sizeof(hdr), 1, m_fp);
+
+    m_buf.resize(k_buf_records);
+    m_buf_used = 0;
+    return true;
+}
+
+void xrv1_commit_log::close() {
+    if (!m_fp)
+        return;
+    flush();
+    fclose(m_fp);
+    m_fp = nullptr;
+}
+
+void xrv1_commit_log::flush() {
+    if (m_fp && m_buf_used > 0)
+        fwrite(m_buf.data(), sizeof(xrv1_commit_rec), m_buf_used, m_fp);
+    m_buf_used = 0;
+}
@@ -0,0 +1,155 @@
+#ifndef __XRV1_COMMIT_LOG_HPP__
+#define __XRV1_COMMIT_LOG_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "xrv1_observers.hpp"
+
+// must match ITAG_WIDTH_P of xrv1_core
+#define XRV1_ITAG_WIDTH 2
+#define XRV1_NUM_ITAGS  (1 << XRV1_ITAG_WIDTH)
+
+// commit log file header
+#define XRV1_CLOG_MAGIC     "XRV1CLOG"
+#define XRV1_CLOG_VERSION   1
+
+// commit record flags
+#define XRV1_CLOG_F_WB      0x1     // record carries register writeback
+
+// One retired instruction, fixed size so that logs can be indexed
+// and processed without parsing.
+struct xrv1_commit_rec {
+    uint64_t cycle;
+    uint32_t pc;
+    uint32_t insn;
+    uint32_t wb_data;
+    uint8_t  itag;
+    uint8_t  rd;
+    uint8_t  flags;
+    uint8_t  rsvd;
+};
+static_assert(sizeof(xrv1_commit_rec) == 24, "commit record layout changed");
+
+struct xrv1_clog_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t rec_size;
+};
+
+// check whether instruction writes rd
+bool xrv1_insn_writes_rd(uint32_t insn);
+
+// Matches retirements to the pc/insn recorded when their itag was issued.
+// Retire groups are in itag order; the single writeback port result goes
+// to the instruction of the group which writes that register.
+class xrv1_retire_tracker {
+public:
+    // calls sink(const xrv1_commit_rec&) for every retired instruction
+    template <typename Sink>
+    void on_cycle(uint64_t cycle, const xrv1_obs_snapshot& snap, Sink&& sink) {
+        uint8_t ret_cnt = snap.ret_retire_cnt();
+        if (ret_cnt > 0) {
+            bool wb_pending = snap.wb_data_vld();
+            uint8_t itag = snap.iq_retire_itag();
+            for (uint8_t i = 0; i < ret_cnt; i++) {
+                const issue_info& info = m_issued[itag];
+                xrv1_commit_rec rec;
+                rec.cycle = cycle;
+                rec.pc = info.pc;
+                rec.insn = info.insn;
+                rec.itag = itag;
+                rec.rd = 0;
+                rec.wb_data = 0;
+                rec.flags = 0;
+                rec.rsvd = 0;
+                if (wb_pending && info.writes_rd && ((info.insn >> 7) & 0x1f) == snap.wb_rd_addr()) {
+                    rec.rd = snap.wb_rd_addr();
+                    rec.wb_data = snap.wb_data();
+                    rec.flags |= XRV1_CLOG_F_WB;
+                    wb_pending = false;
+                }
+                sink(rec);
+                itag = (itag + 1) & (XRV1_NUM_ITAGS - 1);
+            }
+        }
+        // issue happens at the end of this cycle, after retirement
+        if (snap.if_dec_insn_vld() && snap.idecode_issue_vld()) {
+            issue_info& info = m_issued[snap.idecode_itag() & (XRV1_NUM_ITAGS - 1)];
+            info.pc = snap.if_dec_insn_pc();
+            info.insn = snap.if_dec_insn_data();
+            info.writes_rd = xrv1_insn_writes_rd(info.insn);
+        }
+    }
+
+private:
+    struct issue_info {
+        uint32_t pc = 0;
+        uint32_t insn = 0;
+        bool writes_rd = false;
+    };
+    issue_info m_issued[XRV1_NUM_ITAGS];
+};
+
+// Observer writing binary commit log. Records are collected in a fixed
+// buffer and written out in large chunks.
+class xrv1_commit_log {
+public:
+    static constexpr bool k_needs_snapshot = true;
+    static constexpr size_t k_buf_records = 16384;
+
+    xrv1_commit_log() = default;
+    ~xrv1_commit_log();
+
+    bool open(const std::string& path);
+    void close();
+
+    void on_cycle(uint64_t cycle, const xrv1_obs_snapshot& snap) {
+        m_tracker.on_cycle(cycle, snap, [this](const xrv1_commit_rec& rec) {
+            m_buf[m_buf_used++] = rec;
+            if (m_buf_used == k_buf_records)
+                flush();
+        });
+    }
+
+    // write out buffered records
+    void flush();
+
+private:
+    FILE* m_fp = nullptr;
+    std::vector<xrv1_commit_rec> m_buf;
+    size_t m_buf_used = 0;
+    xrv1_retire_tracker m_tracker;
+};
+
+// Observer collecting commit records in memory for batched stepping. The
+// tracker is kept between runs, so instructions issued at the end of one
+// run are matched when they retire in the next one.
+class xrv1_retire_recorder {
+public:
+    static constexpr bool k_needs_snapshot = true;
+
+    void on_cycle(uint64_t cycle, const xrv1_obs_snapshot& snap) {
+        m_tracker.on_cycle(m_cycle_base + cycle, snap, [this](const xrv1_commit_rec& rec) {
+            m_recs.push_back(rec);
+        });
+    }
+
+    // restart cycle numbering and itag matching, e.g. after a reset
+    void reset() {
+        m_tracker = xrv1_retire_tracker();
+        m_cycle_base = 0;
+        m_recs.clear();
+    }
+
+    std::vector<xrv1_commit_rec> m_recs;
+    // cycles done by earlier runs, records carry cycles since reset
+    uint64_t m_cycle_base = 0;
+
+private:
+    xrv1_retire_tracker m_tracker;
+};
+
+#endif /* __XRV1_COMMIT_LOG_HPP__ */
@@ -0,0 +1,135 @@
+#include "xrv1_cosim.hpp"
+
+#include <cstdarg>
+#include <cstring>
+#include <thread>
+
+#include "isa_sim/riscv_inst_dump.h"
+
+xrv1_cosim::xrv1_cosim(bool* stop_flag) :
+    m_stop_flag(stop_flag)
+{
+}
+
+bool xrv1_cosim::init(Mem32Iface& mem, uint32_t ram_size, uint32_t reset_pc, bool async) {
+    m_runner.stop();
+    m_mem.resize(ram_size);
+    if (!m_model.create_memory(0, ram_size, m_mem.data()))
+        return false;
+    // memory is cleared when attached, so copy the image afterwards
+    mem.read_block(0, m_mem.data(), ram_size);
+    m_model.reset(reset_pc);
+    // program exit must not terminate the simulator
+    m_model.set_exit_on_ctrl(false);
+
+    m_batch_used = 0;
+    m_checked = 0;
+    m_mismatch = false;
+    m_report.clear();
+
+    m_async = async;
+    if (m_async) {
+        // rings stall the model once it is that far ahead of the design
+        m_model.event_subscribe(COSIM_EVENT_RETIRE, COSIM_EVENT_RING_SIZE, true);
+        m_model.event_subscribe(COSIM_EVENT_WRITEBACK, COSIM_EVENT_RING_SIZE, true);
+        m_runner.start(&m_model);
+    }
+    return true;
+}
+
+bool xrv1_cosim::finish() {
+    if (!m_mismatch && m_batch_used > 0)
+        check_batch();
+    m_runner.stop();
+    return !m_mismatch;
+}
+
+bool xrv1_cosim::check_batch() {
+    size_t used = m_batch_used;
+    m_batch_used = 0;
+    if (m_mismatch)
+        return false;
+    for (size_t i = 0; i < used; i++) {
+        if (!check_rec(m_batch[i])) {
+            m_mismatch = true;
+            *m_stop_flag = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool xrv1_cosim::next_model_insn(uint32_t& pc, uint32_t& insn, uint32_t& rd_val) {
+    if (!m_async) {
+        m_model.step();
+        if (m_model.get_fault())
+            return false;
+        pc = m_model.get_pc();
+        insn = m_model.get_opcode();
+        rd_val = m_model.get_register((insn >> 7) & 0x1f);
+        return true;
+    }
+
+    while (!m_model.event_ready(COSIM_EVENT_RETIRE)) {
+        // events pushed before the model stopped are visible once it's seen as stopped
+        if (!m_runner.running() && !m_model.event_ready(COSIM_EVENT_RETIRE))
+            return false;
+        std::this_thread::yield();
+    }
+    cosim_event retire = m_model.event_pop(COSIM_EVENT_RETIRE);
+    cosim_event wb = m_model.event_pop(COSIM_EVENT_WRITEBACK);
+    pc = retire.arg1;
+    insn = retire.arg2;
+    rd_val = wb.arg2;
+    return true;
+}
+
+bool xrv1_cosim::check_rec(const xrv1_commit_rec& rec) {
+    uint32_t model_pc, model_insn, model_val;
+    bool model_ok = next_model_insn(model_pc, model_insn, model_val);
+    m_checked++;
+
+    if (!model_ok) {
+        // the runner only stops early on a fault or program exit
+        report(rec, m_model.get_fault() ? "model fault" : "model stopped");
+        return false;
+    }
+
+    if (model_pc != rec.pc || model_insn != rec.insn) {
+        report(rec, "pc/insn mismatch, model executed 0x%08x: 0x%08x", model_pc, model_insn);
+        return false;
+    }
+
+    bool model_wb = xrv1_insn_writes_rd(model_insn);
+    if (model_wb != static_cast<bool>(rec.flags & XRV1_CLOG_F_WB)) {
+        report(rec, model_wb ? "missing writeback" : "unexpected writeback");
+        return false;
+    }
+    if (model_wb) {
+        if (model_val != rec.wb_data) {
+            report(rec, "writeback mismatch, model RF[%d] = 0x%08x", rec.rd, model_val);
+            return false;
+        }
+    }
+    return true;
+}
+
+void xrv1_cosim::report(const xrv1_commit_rec& rec, const char* fmt, ...) {
+    char dis[1024];
+    char msg[512];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, args);
+    va_end(args);
+
+    riscv_inst_decode(dis, sizeof(dis), rec.pc, rec.insn);
+    char buf[2048];
+    if (rec.flags & XRV1_CLOG_F_WB)
+        snprintf(buf, sizeof(buf), "Cosim mismatch after %llu instructions at cycle %llu: %s\n\tRTL: %s RF[%d] <- 0x%08x\n",
+                 static_cast<unsigned long long>(m_checked), static_cast<unsigned long long>(rec.cycle), msg,
+                 dis, rec.rd, rec.wb_data);
+    else
+        snprintf(buf, sizeof(buf), "Cosim mismatch after %llu instructions at cycle %llu: %s\n\tRTL: %s\n",
+                 static_cast<unsigned long long>(m_checked), static_cast<unsigned long long>(rec.cycle), msg, dis);
+    m_report = buf;
+}
@@ -0,0 +1,71 @@
+#ifndef __XRV1_COSIM_HPP__
+#define __XRV1_COSIM_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "memory_base.hpp"
+#include "xrv1_observers.hpp"
+#include "xrv1_commit_log.hpp"
+#include "isa_sim/riscv.h"
+
+// Lock-step co-simulation against the Riscv ISA model. Retirements are
+// collected into a batch and the model is stepped over the whole batch
+// at once, comparing pc, instruction and register writeback.
+// In async mode the model runs ahead on its own thread and the batch is
+// checked against its retire events instead.
+class xrv1_cosim {
+public:
+    static constexpr bool k_needs_snapshot = true;
+    static constexpr size_t k_batch_size = 256;
+
+    xrv1_cosim(bool* stop_flag);
+    ~xrv1_cosim() = default;
+
+    // copy memory image of the design into the model and reset it
+    bool init(Mem32Iface& mem, uint32_t ram_size, uint32_t reset_pc, bool async = false);
+
+    void on_cycle(uint64_t cycle, const xrv1_obs_snapshot& snap) {
+        m_tracker.on_cycle(cycle, snap, [this](const xrv1_commit_rec& rec) {
+            m_batch[m_batch_used++] = rec;
+            if (m_batch_used == k_batch_size)
+                check_batch();
+        });
+    }
+
+    // check the remaining part of the batch
+    bool finish();
+
+    bool has_mismatch() const { return m_mismatch; }
+    const std::string& get_report() const { return m_report; }
+    uint64_t get_checked() const { return m_checked; }
+
+private:
+    // step the model over batched retirements, stops at the first mismatch
+    bool check_batch();
+    bool check_rec(const xrv1_commit_rec& rec);
+    // next instruction completed by the model, false if it has stopped
+    bool next_model_insn(uint32_t& pc, uint32_t& insn, uint32_t& rd_val);
+    void report(const xrv1_commit_rec& rec, const char* fmt, ...);
+
+    Riscv m_model;
+    // model memory, the model does not own it
+    std::vector<uint8_t> m_mem;
+
+    xrv1_retire_tracker m_tracker;
+    xrv1_commit_rec m_batch[k_batch_size];
+    size_t m_batch_used = 0;
+
+    uint64_t m_checked = 0;
+    bool m_mismatch = false;
+    std::string m_report;
+    // set to stop the run
+    bool* m_stop_flag;
+
+    bool m_async = false;
+    // destroyed before the model it runs
+    cosim_runner m_runner;
+};
+
+#endif /* __XRV1_COSIM_HPP__ */
@@ -0,0 +1,121 @@
+#include "xrv1_coverage.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+// coverage.dat is a header line followed by "C '<key>' <count>" per point,
+// keys are \001 separated "name\002value" fields. Any format version is read
+static const std::string s_cov_magic = "# SystemC::Coverage-";
+static const int s_cov_version = 3;
+static const char s_field_sep = '\001';
+static const char s_value_sep = '\002';
+
+std::string xrv1_coverage::field(const std::string& key, const char* name) {
+    const std::string tag = std::string(1, s_field_sep) + name + s_value_sep;
+    size_t pos = key.find(tag);
+    if (pos == std::string::npos)
+        return std::string();
+    pos += tag.size();
+    const size_t end = key.find(s_field_sep, pos);
+    return key.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
+
+std::string xrv1_coverage::normalize(const std::string& key) {
+    const std::string tag = std::string(1, s_field_sep) + "h" + s_value_sep;
+    const size_t pos = key.find(tag);
+    if (pos == std::string::npos)
+        return key;
+    const size_t start = pos + tag.size();
+    const size_t end = key.find(s_field_sep, start);
+    const size_t dot = key.find('.', start);
+    if (dot == std::string::npos || (end != std::string::npos && dot > end))
+        return key;
+    return key.substr(0, start) + key.substr(dot + 1);
+}
+
+bool xrv1_coverage::merge_file(const std::string& path) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, s_cov_magic.size(), s_cov_magic) != 0)
+        return false;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        const size_t end = line.rfind('\'');
+        if (line.compare(0, 3, "C '") != 0 || end < 3)
+            return false;
+        const uint64_t count = std::strtoull(line.c_str() + end + 1, nullptr, 10);
+        m_points[normalize(line.substr(3, end - 3))] += count;
+    }
+    return true;
+}
+
+int xrv1_coverage::merge_dir(const std::string& path) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".dat")
+            files.push_back(entry.path().string());
+    }
+    if (ec)
+        return -1;
+    // same order on every file system, not that it changes the sums
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        if (!merge_file(file)) {
+            printf("Failed to read coverage %s\n", file.c_str());
+            return -1;
+        }
+    }
+    return static_cast<int>(files.size());
+}
+
+bool xrv1_coverage::write(const std::string& path) const {
+    FILE* fp = fopen(path.c_str(), "w");
+    if (!fp)
+        return false;
+    fprintf(fp, "%s%d\n", s_cov_magic.c_str(), s_cov_version);
+    for (const auto& point : m_points)
+        fprintf(fp, "C '%s' %llu\n", point.first.c_str(), static_cast<unsigned long long>(point.second));
+    return fclose(fp) == 0;
+}
+
+size_t xrv1_coverage::get_num_covered() const {
+    size_t covered = 0;
+    for (const auto& point : m_points)
+        covered += point.second > 0;
+    return covered;
+}
+
+void xrv1_coverage::print(FILE* fp) const {
+    // points and covered points per type and per "type/module" page
+    std::map<std::string, std::pair<size_t, size_t>> types, pages;
+    for (const auto& point : m_points) {
+        const std::string page = field(point.first, "page");
+        const size_t slash = page.find('/');
+        std::string type = page.substr(0, slash);
+        if (type.compare(0, 2, "v_") == 0)
+            type = type.substr(2);
+        auto& t = types[type.empty() ? "other" : type];
+        auto& p = pages[page.empty() ? "other" : page];
+        t.first++;
+        p.first++;
+        t.second += point.second > 0;
+        p.second += point.second > 0;
+    }
+
+    auto print_row = [fp](const std::string& name, const std::pair<size_t, size_t>& cnt) {
+        fprintf(fp, "  %-40s %10zu %10zu %6.1f%%\n", name.c_str(), cnt.second, cnt.first,
+                cnt.first ? 100.0 * cnt.second / cnt.first : 0.0);
+    };
+    fprintf(fp, "Coverage: %zu/%zu points\n", get_num_covered(), get_num_points());
+    fprintf(fp, "  %-40s %10s %10s %7s\n", "type", "covered", "points", "");
+    for (const auto& t : types)
+        print_row(t.first, t.second);
+    fprintf(fp, "  %-40s %10s %10s %7s\n", "type/module", "covered", "points", "");
+    for (const auto& p : pages)
+        print_row(p.first, p.second);
+}
@@ -0,0 +1,39 @@
+#ifndef __XRV1_COVERAGE_HPP__
+#define __XRV1_COVERAGE_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// Coverage points of verilator coverage.dat files. Counts of the same point
+// are summed over all merged files, which makes the result independent of
+// how tests were spread over models and processes.
+class xrv1_coverage
+{
+public:
+    // adds the points of a coverage.dat, returns false if it can't be read
+    bool merge_file(const std::string& path);
+    // merges every *.dat of a directory, returns the number of files merged
+    // or -1 on a bad file
+    int merge_dir(const std::string& path);
+    // writes the points as coverage.dat, readable by verilator_coverage
+    bool write(const std::string& path) const;
+    void clear() { m_points.clear(); }
+
+    size_t get_num_points() const { return m_points.size(); }
+    size_t get_num_covered() const;
+    // covered points by type (line, toggle, branch, ...) and by module
+    void print(FILE* fp = stdout) const;
+
+private:
+    // hierarchy is stored without the model instance name, it differs
+    // between the models of one process (Vxrv1_sim_top, Vxrv1_sim_top_1, ...)
+    static std::string normalize(const std::string& key);
+    static std::string field(const std::string& key, const char* name);
+
+    std::map<std::string, uint64_t> m_points;
+};
+
+#endif /* __XRV1_COVERAGE_HPP__ */
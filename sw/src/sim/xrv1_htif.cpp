@@ -0,0 +1,64 @@
+#include "xrv1_htif.hpp"
+
+#include <cstdio>
+
+#include "svdpi.h"
+#include "verilated.h"
+
+void xrv1_htif::reset() {
+    m_lower = 0;
+    m_upper = 0;
+    m_exit_code = -1;
+    m_console.clear();
+}
+
+void xrv1_htif::tohost_write(bool upper, uint32_t data, uint8_t be) {
+    uint32_t mask = 0;
+    for (int i = 0; i < 4; i++)
+        if (be & (1 << i))
+            mask |= 0xffu << (8 * i);
+
+    if (upper) {
+        m_upper = (m_upper & ~mask) | (data & mask);
+        return;
+    }
+    data = (m_lower & ~mask) | (data & mask);
+    const uint32_t cmd = m_upper;
+    m_lower = 0;
+    m_upper = 0;
+
+    if (cmd == k_console_cmd) {
+        const char c = static_cast<char>(data);
+        m_console += c;
+        if (m_echo) {
+            putchar(c);
+            if (c == '\n')
+                fflush(stdout);
+        }
+    } else if (cmd == 0 && (data & 1)) {
+        // same as $finish, the current tick still completes
+        m_exit_code = static_cast<int>(data >> 1);
+        m_ctx->gotFinish(true);
+    }
+}
+
+void* xrv1_htif::dpi_key() {
+    static char key;
+    return &key;
+}
+
+// DPI imports of xrv1_sim_tcm, a tcm without htif attached has no tohost
+
+static xrv1_htif* scope_htif() {
+    return static_cast<xrv1_htif*>(svGetUserData(svGetScope(), xrv1_htif::dpi_key()));
+}
+
+extern "C" unsigned int xrv1_htif_tohost_addr() {
+    xrv1_htif* htif = scope_htif();
+    return htif ? htif->get_tohost_addr() : xrv1_htif::k_no_addr;
+}
+
+extern "C" void xrv1_htif_tohost_write(svBit upper, unsigned int data, unsigned char be) {
+    if (xrv1_htif* htif = scope_htif())
+        htif->tohost_write(upper, data, be);
+}
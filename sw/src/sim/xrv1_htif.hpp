@@ -0,0 +1,58 @@
+#ifndef __XRV1_HTIF_HPP__
+#define __XRV1_HTIF_HPP__
+
+#include <cstdint>
+#include <string>
+
+class VerilatedContext;
+
+// HTIF style host interface of xrv1_sim_tcm. Stores to the tohost word pair
+// are handed over by a DPI hook as they are accepted, nothing is polled:
+//  - tohost[31:0] with bit 0 set ends the simulation right away, exit code
+//    is tohost[31:1] (riscv-tests protocol, RVMODEL_HALT, bench crt0.S)
+//  - tohost[63:32] = 0x0101_0000 (device 1, command 1) followed by a store
+//    of a character to tohost[31:0] prints that character
+// Stores are merged under their byte enables into the held tohost words,
+// every store to the lower word is a command and clears both words again
+// (as the host acknowledging it would), so a plain "sw val, tohost" after
+// a putchar is an exit again. fromhost isn't written, the target doesn't
+// need to wait for an acknowledge.
+class xrv1_htif
+{
+public:
+    static constexpr uint32_t k_no_addr = ~0u;
+    static constexpr uint32_t k_console_cmd = 0x01010000;
+
+    explicit xrv1_htif(VerilatedContext* ctx) : m_ctx(ctx) {}
+
+    // tohost address the tcm picks up during the next reset
+    void set_tohost_addr(uint32_t addr) { m_tohost_addr = addr; }
+    uint32_t get_tohost_addr() const { return m_tohost_addr; }
+    // forget exit code, console output and a pending upper word
+    void reset();
+
+    // console output is collected and echoed to stdout unless disabled
+    void set_console_echo(bool echo) { m_echo = echo; }
+    const std::string& get_console() const { return m_console; }
+
+    // exit code written by the target, -1 if it didn't exit through tohost
+    int get_exit_code() const { return m_exit_code; }
+
+    // store of the design to tohost (upper = tohost[63:32]), data bytes
+    // are only valid where be is set
+    void tohost_write(bool upper, uint32_t data, uint8_t be);
+
+    // key of the svPutUserData entry pointing to the htif of a tcm scope
+    static void* dpi_key();
+
+private:
+    VerilatedContext* m_ctx = nullptr;
+    uint32_t m_tohost_addr = k_no_addr;
+    uint32_t m_lower = 0;
+    uint32_t m_upper = 0;
+    int m_exit_code = -1;
+    bool m_echo = true;
+    std::string m_console;
+};
+
+#endif /* __XRV1_HTIF_HPP__ */
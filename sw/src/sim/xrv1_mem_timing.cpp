@@ -0,0 +1,179 @@
+#include "xrv1_mem_timing.hpp"
+
+#include <algorithm>
+
+#include "svdpi.h"
+
+void xrv1_cache_tags::configure(const xrv1_cache_cfg& cfg) {
+    m_ways = std::max<uint32_t>(cfg.ways, 1);
+    m_line_bits = 2;
+    while ((2u << m_line_bits) <= cfg.line_size)
+        m_line_bits++;
+    m_sets = std::max<uint32_t>(cfg.size / (m_ways << m_line_bits), 1);
+    m_tags.assign(m_sets * m_ways, 0);
+    m_used.assign(m_sets * m_ways, 0);
+    m_stamp = 0;
+}
+
+void xrv1_cache_tags::invalidate() {
+    std::fill(m_tags.begin(), m_tags.end(), 0);
+    std::fill(m_used.begin(), m_used.end(), 0);
+    m_stamp = 0;
+}
+
+bool xrv1_cache_tags::access(uint32_t addr) {
+    const uint32_t line = addr >> m_line_bits;
+    const uint32_t tag = line + 1;
+    const uint32_t base = (line % m_sets) * m_ways;
+    uint32_t victim = base;
+    m_stamp++;
+    for (uint32_t i = base; i < base + m_ways; i++) {
+        if (m_tags[i] == tag) {
+            m_used[i] = m_stamp;
+            return true;
+        }
+        if (m_used[i] < m_used[victim])
+            victim = i;
+    }
+    m_tags[victim] = tag;
+    m_used[victim] = m_stamp;
+    return false;
+}
+
+void xrv1_mem_timing::configure(const xrv1_mem_timing_cfg& cfg) {
+    m_cfg = cfg;
+    m_cache[IMEM].configure(cfg.icache);
+    m_cache[DMEM].configure(cfg.dcache);
+    m_bank_free.assign(std::max<uint32_t>(cfg.num_banks, 1), 0);
+    reset();
+}
+
+void xrv1_mem_timing::reset() {
+    for (auto& cache : m_cache)
+        cache.invalidate();
+    for (auto& stats : m_stats)
+        stats = xrv1_mem_port_stats();
+    std::fill(m_bank_free.begin(), m_bank_free.end(), 0);
+    m_rng.seed(m_cfg.seed);
+    m_fetch_busy = false;
+    m_fetch_ready = 0;
+}
+
+uint32_t xrv1_mem_timing::memory_latency(uint64_t cycle, uint32_t addr, int port) {
+    uint32_t lat = m_cfg.latency;
+    if (m_cfg.latency_max > m_cfg.latency)
+        lat = std::uniform_int_distribution<uint32_t>(m_cfg.latency, m_cfg.latency_max)(m_rng);
+
+    if (m_cfg.bank_busy > 0) {
+        uint64_t& free = m_bank_free[(addr >> 2) % m_bank_free.size()];
+        const uint64_t wait = free > cycle ? free - cycle : 0;
+        m_stats[port].bank_conflicts += wait;
+        free = cycle + wait + m_cfg.bank_busy;
+        lat += static_cast<uint32_t>(wait);
+    }
+    return lat;
+}
+
+uint32_t xrv1_mem_timing::access(int port, uint64_t cycle, uint32_t addr, bool write) {
+    const xrv1_cache_cfg& cache = port == IMEM ? m_cfg.icache : m_cfg.dcache;
+    xrv1_mem_port_stats& stats = m_stats[port];
+    uint32_t lat;
+    // stores allocate like loads, write back traffic isn't modelled
+    if (!cache.enable) {
+        lat = memory_latency(cycle, addr, port);
+    } else if (m_cache[port].access(addr)) {
+        stats.hits++;
+        lat = cache.hit_latency;
+    } else {
+        stats.misses++;
+        lat = cache.miss_penalty + memory_latency(cycle, addr, port);
+    }
+    lat = std::max<uint32_t>(lat, 1);
+
+    stats.accesses++;
+    if (write)
+        stats.writes++;
+    stats.latency += lat;
+    stats.max_latency = std::max<uint64_t>(stats.max_latency, lat);
+    return lat;
+}
+
+bool xrv1_mem_timing::imem_poll(uint64_t cycle, uint32_t addr) {
+    // a new address (next fetch or redirect) starts once the port is free,
+    // the old access isn't cancelled
+    if (!m_fetch_busy || addr != m_fetch_addr) {
+        const uint64_t start = m_fetch_busy ? std::max(cycle, m_fetch_ready - 1) : cycle;
+        m_fetch_ready = start + access(IMEM, start, addr, false);
+        m_fetch_addr = addr;
+        m_fetch_busy = true;
+    }
+    if (cycle + 1 >= m_fetch_ready) {
+        m_fetch_busy = false;
+        return true;
+    }
+    m_stats[IMEM].stalls++;
+    return false;
+}
+
+uint32_t xrv1_mem_timing::dmem_access(uint64_t cycle, uint32_t addr, bool write) {
+    return access(DMEM, cycle, addr, write);
+}
+
+const char* xrv1_mem_timing::port_name(int port) {
+    return port == IMEM ? "imem" : "dmem";
+}
+
+void xrv1_mem_timing::print(FILE* fp) const {
+    fprintf(fp, "Memory timing: latency %u", m_cfg.latency);
+    if (m_cfg.latency_max > m_cfg.latency)
+        fprintf(fp, "-%u", m_cfg.latency_max);
+    fprintf(fp, ", %u banks (busy %u), max outstanding %u\n",
+            static_cast<unsigned>(m_bank_free.size()), m_cfg.bank_busy, m_cfg.max_outstanding);
+    fprintf(fp, "  %-4s %12s %12s %12s %6s %8s %8s %12s %12s\n",
+            "port", "accesses", "hits", "misses", "hit%", "avg_lat", "max_lat", "bank_wait", "stalls");
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const xrv1_mem_port_stats& s = m_stats[i];
+        const bool cached = (i == IMEM ? m_cfg.icache : m_cfg.dcache).enable;
+        fprintf(fp, "  %-4s %12llu %12llu %12llu %5.1f%% %8.2f %8llu %12llu %12llu\n", port_name(i),
+                static_cast<unsigned long long>(s.accesses),
+                static_cast<unsigned long long>(s.hits),
+                static_cast<unsigned long long>(s.misses),
+                cached && s.accesses ? 100.0 * s.hits / s.accesses : 0.0,
+                s.avg_latency(),
+                static_cast<unsigned long long>(s.max_latency),
+                static_cast<unsigned long long>(s.bank_conflicts),
+                static_cast<unsigned long long>(s.stalls));
+    }
+}
+
+void* xrv1_mem_timing::dpi_key() {
+    static char key;
+    return &key;
+}
+
+// DPI imports of xrv1_sim_tcm in MEM_TIMING builds, the calling tcm
+// instance tells which model's timing to use
+
+static xrv1_mem_timing* scope_timing() {
+    return static_cast<xrv1_mem_timing*>(svGetUserData(svGetScope(), xrv1_mem_timing::dpi_key()));
+}
+
+extern "C" svBit xrv1_mem_imem_poll(unsigned long long cycle, unsigned int addr) {
+    return scope_timing()->imem_poll(cycle, addr);
+}
+
+extern "C" unsigned int xrv1_mem_dmem_access(unsigned long long cycle, unsigned int addr, svBit write) {
+    return scope_timing()->dmem_access(cycle, addr, write);
+}
+
+extern "C" unsigned int xrv1_mem_dmem_limit() {
+    return scope_timing()->dmem_max_outstanding();
+}
+
+extern "C" void xrv1_mem_dmem_stall() {
+    scope_timing()->dmem_stall();
+}
+
+extern "C" void xrv1_mem_reset() {
+    scope_timing()->reset();
+}
@@ -0,0 +1,117 @@
+#ifndef __XRV1_MEM_TIMING_HPP__
+#define __XRV1_MEM_TIMING_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Tag-only set-associative cache with LRU replacement, data stays in the tcm
+struct xrv1_cache_cfg {
+    bool enable = false;
+    uint32_t size = 4096;
+    uint32_t ways = 2;
+    uint32_t line_size = 32;
+    // cycles from request to response on a hit
+    uint32_t hit_latency = 1;
+    // cycles added to the memory latency on a miss
+    uint32_t miss_penalty = 8;
+};
+
+// Timing of xrv1_sim_tcm in MEM_TIMING builds. The defaults describe the
+// ideal tcm (every request answered in the next cycle).
+struct xrv1_mem_timing_cfg {
+    // memory latency in cycles, uniformly random in [latency, latency_max]
+    // if latency_max is larger than latency
+    uint32_t latency = 1;
+    uint32_t latency_max = 0;
+    uint32_t seed = 1;
+    // data requests in flight, 0 is as many as the tcm queue holds
+    uint32_t max_outstanding = 0;
+    // word interleaved banks shared by both ports, a memory access keeps
+    // its bank busy for bank_busy cycles
+    uint32_t num_banks = 1;
+    uint32_t bank_busy = 0;
+    xrv1_cache_cfg icache;
+    xrv1_cache_cfg dcache;
+};
+
+struct xrv1_mem_port_stats {
+    uint64_t accesses = 0;
+    uint64_t writes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // summed latency of all accesses and the worst one
+    uint64_t latency = 0;
+    uint64_t max_latency = 0;
+    // cycles accesses waited for a busy bank
+    uint64_t bank_conflicts = 0;
+    // cycles the core waited on this port (fetch retries, dmem not ready)
+    uint64_t stalls = 0;
+
+    double avg_latency() const { return accesses ? static_cast<double>(latency) / accesses : 0.0; }
+};
+
+class xrv1_cache_tags
+{
+public:
+    void configure(const xrv1_cache_cfg& cfg);
+    void invalidate();
+    // looks addr up and allocates it on a miss, returns true on a hit
+    bool access(uint32_t addr);
+
+private:
+    uint32_t m_sets = 0;
+    uint32_t m_ways = 0;
+    uint32_t m_line_bits = 0;
+    // per way tag (line address + 1, 0 is invalid) and last use stamp
+    std::vector<uint32_t> m_tags;
+    std::vector<uint64_t> m_used;
+    uint64_t m_stamp = 0;
+};
+
+class xrv1_mem_timing
+{
+public:
+    enum port_e { IMEM = 0, DMEM = 1, NUM_PORTS };
+
+    xrv1_mem_timing() { configure(xrv1_mem_timing_cfg()); }
+
+    // applies cfg, drops cache contents and statistics
+    void configure(const xrv1_mem_timing_cfg& cfg);
+    const xrv1_mem_timing_cfg& get_cfg() const { return m_cfg; }
+    // starts over with cold caches and idle banks, called on design reset
+    void reset();
+
+    // instruction fetch asks for addr every cycle until it gets an answer,
+    // returns true if the data is delivered in the next cycle
+    bool imem_poll(uint64_t cycle, uint32_t addr);
+    // latency (>= 1) of a data request accepted in cycle
+    uint32_t dmem_access(uint64_t cycle, uint32_t addr, bool write);
+    uint32_t dmem_max_outstanding() const { return m_cfg.max_outstanding; }
+    void dmem_stall() { m_stats[DMEM].stalls++; }
+
+    const xrv1_mem_port_stats& get_stats(int port) const { return m_stats[port]; }
+    void print(FILE* fp = stdout) const;
+
+    static const char* port_name(int port);
+    // key of the svPutUserData entry pointing to the model of a tcm scope
+    static void* dpi_key();
+
+private:
+    uint32_t access(int port, uint64_t cycle, uint32_t addr, bool write);
+    uint32_t memory_latency(uint64_t cycle, uint32_t addr, int port);
+
+    xrv1_mem_timing_cfg m_cfg;
+    xrv1_cache_tags m_cache[NUM_PORTS];
+    xrv1_mem_port_stats m_stats[NUM_PORTS];
+    std::vector<uint64_t> m_bank_free;
+    std::mt19937 m_rng;
+
+    // fetch in progress and the cycle its data is delivered
+    bool m_fetch_busy = false;
+    uint32_t m_fetch_addr = 0;
+    uint64_t m_fetch_ready = 0;
+};
+
+#endif /* __XRV1_MEM_TIMING_HPP__ */
@@ -0,0 +1,101 @@
+#ifndef __XRV1_OBSERVERS_HPP__
+#define __XRV1_OBSERVERS_HPP__
+
+#include <cstdint>
+#include <cstdio>
+
+#include "isa_sim/riscv_inst_dump.h"
+
+// number of 32-bit words returned by get_obs_snapshot dpi task
+#define XRV1_OBS_SNAPSHOT_WORDS 9
+
+// Per-cycle observation of the core, sampled with a single dpi call.
+// Word layout matches get_obs_snapshot() in xrv1_core.sv.
+struct xrv1_obs_snapshot
+{
+    uint32_t w[XRV1_OBS_SNAPSHOT_WORDS];
+
+    bool imem_req_vld() const { return w[0] & 0x1; }
+    bool imem_resp_vld() const { return w[0] & 0x2; }
+    bool ifetch_insn_vld() const { return w[0] & 0x4; }
+    bool if_dec_insn_vld() const { return w[0] & 0x8; }
+    bool idecode_issue_vld() const { return w[0] & 0x10; }
+    bool wb_data_vld() const { return w[0] & 0x20; }
+    uint8_t idecode_itag() const { return (w[0] >> 8) & 0xff; }
+    uint8_t ret_retire_cnt() const { return (w[0] >> 16) & 0xff; }
+    uint8_t iq_retire_itag() const { return (w[0] >> 24) & 0xff; }
+    uint8_t wb_rd_addr() const { return w[1] & 0xff; }
+    uint32_t imem_req_addr() const { return w[2]; }
+    uint32_t imem_resp_data() const { return w[3]; }
+    uint32_t ifetch_insn_pc() const { return w[4]; }
+    uint32_t ifetch_insn_data() const { return w[5]; }
+    uint32_t if_dec_insn_pc() const { return w[6]; }
+    uint32_t if_dec_insn_data() const { return w[7]; }
+    uint32_t wb_data() const { return w[8]; }
+};
+
+// Observers are passed to xrv1_soc::run_cycles as template parameters.
+// Each one declares whether it needs the snapshot; if none of them do,
+// the run loop does not sample the design at all.
+//
+// struct observer {
+//     static constexpr bool k_needs_snapshot = ...;
+//     void on_cycle(uint64_t cycle, const xrv1_obs_snapshot& snap);
+// };
+
+// counts retired instructions
+struct xrv1_retire_counter
+{
+    static constexpr bool k_needs_snapshot = true;
+
+    uint64_t m_retired = 0;
+
+    void on_cycle(uint64_t, const xrv1_obs_snapshot& snap) {
+        m_retired += snap.ret_retire_cnt();
+    }
+};
+
+// prints pipeline activity, same output as verbose run_simulation
+struct xrv1_pipe_printer
+{
+    static constexpr bool k_needs_snapshot = true;
+
+    uint32_t m_prev_fetch_addr = ~0u;
+    uint64_t m_retired = 0;
+    char m_buf[1024];
+
+    void on_cycle(uint64_t, const xrv1_obs_snapshot& snap) {
+        if (snap.imem_resp_vld()) {
+            riscv_inst_decode(m_buf, sizeof(m_buf), m_prev_fetch_addr, snap.imem_resp_data());
+            printf("[IF] %s\n", m_buf);
+        }
+
+        if (snap.imem_req_vld())
+            m_prev_fetch_addr = snap.imem_req_addr();
+
+        if (snap.ifetch_insn_vld()) {
+            riscv_inst_decode(m_buf, sizeof(m_buf), snap.ifetch_insn_pc(), snap.ifetch_insn_data());
+            printf("(IF->DEC) %s\n", m_buf);
+        }
+
+        if (snap.if_dec_insn_vld()) {
+            riscv_inst_decode(m_buf, sizeof(m_buf), snap.if_dec_insn_pc(), snap.if_dec_insn_data());
+            printf("[IF/DEC] %s", m_buf);
+            if (snap.idecode_issue_vld())
+                printf(" itag=%d", snap.idecode_itag());
+            printf("\n");
+        }
+
+        uint8_t ret_cnt = snap.ret_retire_cnt();
+        if (ret_cnt > 0) {
+            m_retired += ret_cnt;
+            printf("RETIRE(%d) %llu itag=%d", ret_cnt, static_cast<unsigned long long>(m_retired), snap.iq_retire_itag());
+            if (snap.wb_data_vld())
+                printf(" (WB) RF[%d] <- 0x%x", snap.wb_rd_addr(), snap.wb_data());
+            printf("\n");
+        }
+        printf("================================================================================\n");
+    }
+};
+
+#endif /* __XRV1_OBSERVERS_HPP__ */
@@ -0,0 +1,63 @@
+#include "xrv1_perf.hpp"
+
+static const char* s_perf_names[XRV1_PERF_NUM] = {
+    "cycles",
+    "instret",
+    "issue",
+    "stall_fetch",
+    "stall_redirect",
+    "stall_iq_full",
+    "stall_raw",
+    "stall_lsu",
+    "stall_fu",
+    "fetch_bubble",
+    "ifq_empty",
+    "iq_occupancy",
+    "lsu_busy",
+    "lsu_dmem_stall",
+    "spec_redirect",
+    "jump_redirect",
+    "branch_redirect",
+};
+
+const char* xrv1_perf_counters::name(int idx) {
+    return (idx >= 0 && idx < XRV1_PERF_NUM) ? s_perf_names[idx] : "unknown";
+}
+
+double xrv1_perf_counters::cpi() const {
+    return cpi_of(XRV1_PERF_CYCLES);
+}
+
+double xrv1_perf_counters::cpi_of(int idx) const {
+    return v[XRV1_PERF_INSTRET] ? static_cast<double>(v[idx]) / v[XRV1_PERF_INSTRET] : 0.0;
+}
+
+void xrv1_perf_counters::print(FILE* fp) const {
+    const uint64_t cycles = v[XRV1_PERF_CYCLES];
+    auto pct = [cycles](uint64_t n) {
+        return cycles ? 100.0 * n / cycles : 0.0;
+    };
+
+    fprintf(fp, "CPI stack: %llu cycles, %llu instructions, CPI %.3f\n",
+            static_cast<unsigned long long>(cycles),
+            static_cast<unsigned long long>(v[XRV1_PERF_INSTRET]), cpi());
+    for (int i = XRV1_PERF_ISSUE; i <= XRV1_PERF_STALL_FU; i++)
+        fprintf(fp, "  %-16s %12llu  %6.3f  %5.1f%%\n", name(i),
+                static_cast<unsigned long long>(v[i]), cpi_of(i), pct(v[i]));
+
+    fprintf(fp, "Frontend:\n");
+    for (int i = XRV1_PERF_FETCH_BUBBLE; i <= XRV1_PERF_IFQ_EMPTY; i++)
+        fprintf(fp, "  %-16s %12llu  %5.1f%%\n", name(i),
+                static_cast<unsigned long long>(v[i]), pct(v[i]));
+
+    fprintf(fp, "Backend:\n");
+    fprintf(fp, "  %-16s %12.3f\n", "iq_avg_occupancy",
+            cycles ? static_cast<double>(v[XRV1_PERF_IQ_OCCUPANCY]) / cycles : 0.0);
+    for (int i = XRV1_PERF_LSU_BUSY; i <= XRV1_PERF_LSU_DMEM_STALL; i++)
+        fprintf(fp, "  %-16s %12llu  %5.1f%%\n", name(i),
+                static_cast<unsigned long long>(v[i]), pct(v[i]));
+
+    fprintf(fp, "Redirects:\n");
+    for (int i = XRV1_PERF_SPEC_REDIRECT; i <= XRV1_PERF_BRANCH_REDIRECT; i++)
+        fprintf(fp, "  %-16s %12llu\n", name(i), static_cast<unsigned long long>(v[i]));
+}
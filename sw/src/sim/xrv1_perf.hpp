@@ -0,0 +1,49 @@
+#ifndef __XRV1_PERF_HPP__
+#define __XRV1_PERF_HPP__
+
+#include <cstdint>
+#include <cstdio>
+
+// Performance counters of xrv1_core, read with the get_perf_counter dpi
+// task. Order must match xrv_perf_e in xrv1_pkg.sv.
+enum xrv1_perf_counter {
+    XRV1_PERF_CYCLES = 0,
+    XRV1_PERF_INSTRET,
+    // decode slot of every cycle is counted in exactly one of these
+    XRV1_PERF_ISSUE,
+    XRV1_PERF_STALL_FETCH,
+    XRV1_PERF_STALL_REDIRECT,
+    XRV1_PERF_STALL_IQ_FULL,
+    XRV1_PERF_STALL_RAW,
+    XRV1_PERF_STALL_LSU,
+    XRV1_PERF_STALL_FU,
+    // frontend
+    XRV1_PERF_FETCH_BUBBLE,
+    XRV1_PERF_IFQ_EMPTY,
+    // backend, occupancy is summed over cycles
+    XRV1_PERF_IQ_OCCUPANCY,
+    XRV1_PERF_LSU_BUSY,
+    XRV1_PERF_LSU_DMEM_STALL,
+    // redirects by fetch speculation, decode (jalr) and branch resolution
+    XRV1_PERF_SPEC_REDIRECT,
+    XRV1_PERF_JUMP_REDIRECT,
+    XRV1_PERF_BRANCH_REDIRECT,
+    XRV1_PERF_NUM
+};
+
+// Counter values of one run, counters restart on every reset.
+struct xrv1_perf_counters {
+    uint64_t v[XRV1_PERF_NUM] = {};
+
+    uint64_t operator[](int idx) const { return v[idx]; }
+    double cpi() const;
+    // cycles of counter idx per retired instruction
+    double cpi_of(int idx) const;
+    // prints cpi stack followed by the rest of the counters
+    void print(FILE* fp = stdout) const;
+
+    // short lowercase name used in reports and python dicts
+    static const char* name(int idx);
+};
+
+#endif /* __XRV1_PERF_HPP__ */
@@ -0,0 +1,95 @@
+#include "xrv1_sampler.hpp"
+
+#include "xrv1_soc.hpp"
+#include "xrv1_observers.hpp"
+
+xrv1_sampler::xrv1_sampler(xrv1_soc& soc) :
+    m_soc(soc)
+{
+}
+
+bool xrv1_sampler::init() {
+    uint32_t ram_size = m_soc.get_ram_size_bits();
+    m_mem.resize(ram_size);
+    if (!m_model.create_memory(0, ram_size, m_mem.data()))
+        return false;
+    // memory is cleared when attached, so copy the image afterwards
+    m_soc.read_block(0, m_mem.data(), ram_size);
+    m_model.reset(m_soc.get_reset_addr());
+    // the program end is detected by the sampler
+    m_model.set_exit_on_ctrl(false);
+
+    m_insns = 0;
+    m_ended = false;
+    m_windows.clear();
+    return true;
+}
+
+bool xrv1_sampler::fast_forward(uint64_t num_insns, int64_t stop_pc) {
+    for (uint64_t i = 0; ; i++) {
+        bool at_pc = stop_pc == -1 || m_model.get_register(RISCV_REGNO_PC) == static_cast<uint32_t>(stop_pc);
+        if (i >= num_insns && at_pc)
+            break;
+        m_model.step();
+        m_insns++;
+        // the design finishes on any system instruction other than csr access
+        if (m_model.get_fault() || m_model.get_exited() || (m_model.get_opcode() & 0x707f) == 0x73) {
+            m_ended = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+void xrv1_sampler::inject_state() {
+    m_soc.clear_state();
+    m_soc.write_block(0, m_mem.data(), m_mem.size());
+    for (int i = 1; i < 32; i++)
+        m_soc.set_reg_val_u32(i, m_model.get_register(i));
+    m_soc.set_start_pc(m_model.get_register(RISCV_REGNO_PC));
+
+    m_soc.reset_design();
+    // csrs are cleared by reset
+    m_soc.set_csr_val_u32(CSR_MTVEC, m_model.get_register(RISCV_REGNO_CSR0 + CSR_MTVEC));
+}
+
+bool xrv1_sampler::run(const xrv1_sample_cfg& cfg) {
+    m_windows.clear();
+    if (!fast_forward(cfg.skip_insns, cfg.start_pc))
+        return false;
+
+    for (int w = 0; w < cfg.num_windows && !m_ended; w++) {
+        xrv1_sample_window window;
+        window.start_insn = m_insns;
+        window.start_pc = m_model.get_register(RISCV_REGNO_PC);
+
+        inject_state();
+        m_soc.run_cycles(cfg.warmup_cycles);
+        xrv1_retire_counter counter;
+        window.cycles = m_soc.run_cycles(cfg.window_cycles, counter);
+        window.retired = counter.m_retired;
+        if (window.cycles > 0)
+            m_windows.push_back(window);
+
+        fast_forward(cfg.interval_insns, -1);
+    }
+
+    // following runs start from the regular reset address again
+    m_soc.set_start_pc(m_soc.get_reset_addr());
+    return !m_windows.empty();
+}
+
+double xrv1_sampler::get_window_ipc(size_t idx) const {
+    const xrv1_sample_window& window = m_windows.at(idx);
+    return window.cycles > 0 ? static_cast<double>(window.retired) / window.cycles : 0.0;
+}
+
+double xrv1_sampler::get_ipc() const {
+    uint64_t retired = 0;
+    int64_t cycles = 0;
+    for (const auto& window : m_windows) {
+        retired += window.retired;
+        cycles += window.cycles;
+    }
+    return cycles > 0 ? static_cast<double>(retired) / cycles : 0.0;
+}
@@ -0,0 +1,75 @@
+#ifndef __XRV1_SAMPLER_HPP__
+#define __XRV1_SAMPLER_HPP__
+
+#include <cstdint>
+#include <vector>
+
+#include "isa_sim/riscv.h"
+
+class xrv1_soc;
+
+// Sampling configuration, instruction counts are the ones of the isa model.
+struct xrv1_sample_cfg {
+    // instructions to skip before the first window
+    uint64_t skip_insns = 0;
+    // then skip until this pc is reached, -1 to ignore
+    int64_t start_pc = -1;
+    // instructions executed on the isa model between window starts
+    uint64_t interval_insns = 1000000;
+    // detailed cycles to fill the pipeline before measuring
+    int64_t warmup_cycles = 100;
+    // measured cycles of every window
+    int64_t window_cycles = 10000;
+    // maximal number of windows
+    int num_windows = 10;
+};
+
+struct xrv1_sample_window {
+    // isa model instruction count and pc at the window start
+    uint64_t start_insn;
+    uint32_t start_pc;
+    int64_t cycles;
+    uint64_t retired;
+};
+
+// Sampled simulation: the workload runs on the Riscv isa model and at
+// the start of every window its architectural state (registers, pc,
+// csrs, memory) is moved into the design, which then runs in detail
+// for a short window to measure ipc.
+class xrv1_sampler {
+public:
+    xrv1_sampler(xrv1_soc& soc);
+    ~xrv1_sampler() = default;
+
+    // take memory image of the design (elf must be loaded) as the
+    // initial state of the isa model
+    bool init();
+    // run all of the windows, false if no window could be measured
+    bool run(const xrv1_sample_cfg& cfg);
+
+    const std::vector<xrv1_sample_window>& get_windows() const { return m_windows; }
+    size_t get_num_windows() const { return m_windows.size(); }
+    double get_window_ipc(size_t idx) const;
+    // ipc over all measured windows
+    double get_ipc() const;
+    // instructions executed by the isa model
+    uint64_t get_model_insns() const { return m_insns; }
+    xrv1_soc& get_soc() { return m_soc; }
+
+private:
+    // step the isa model, returns false once the program has ended
+    bool fast_forward(uint64_t num_insns, int64_t stop_pc);
+    // restart the design from the current isa model state
+    void inject_state();
+
+    xrv1_soc& m_soc;
+    Riscv m_model;
+    // model memory, the model does not own it
+    std::vector<uint8_t> m_mem;
+    uint64_t m_insns = 0;
+    bool m_ended = false;
+
+    std::vector<xrv1_sample_window> m_windows;
+};
+
+#endif /* __XRV1_SAMPLER_HPP__ */
@@ -1,15 +1,35 @@
 #include <string>
+#include <cstring>
+#include <vector>
 
 #include "xrv1_soc.hpp"
-#include "isa_sim/riscv_inst_dump.h"
 
 // verilator includes
 #include "Vxrv1_sim_top.h"
 #include "verilated.h"
-#include "verilated_vcd_c.h"
+#include "verilated_syms.h"
+#ifdef XRV1_SAVABLE
+#include "verilated_save.h"
+#endif
+#ifdef XRV1_COVERAGE
+#include "verilated_cov.h"
+#endif
+
+#ifndef XRV1_MODEL_FLAVOR
+#define XRV1_MODEL_FLAVOR "fast"
+#endif
+
+#include <atomic>
+
+// used to give every model instance its own scope names
+static std::atomic<int> s_instance_cnt{0};
 
 xrv1_soc::xrv1_soc() : m_elf_loader(this) {
-    const std::string prefix{VERILATOR_PREFIX};
+    const int instance_id = s_instance_cnt++;
+    // keep the plain name for the first instance
+    m_name = std::string(VERILATOR_PREFIX);
+    if (instance_id > 0)
+        m_name += "_" + std::to_string(instance_id);
     const std::string top_module{TOP_MODULE};
 
     // allocate verilated context
@@ -17,163 +37,284 @@ xrv1_soc::xrv1_soc() : m_elf_loader(this) {
     assert(m_ctx);
 
     // allocate rtl design
-    m_rtl = new Vxrv1_sim_top(m_ctx, prefix.c_str());
+    m_rtl = new Vxrv1_sim_top(m_ctx, m_name.c_str());
     assert(m_rtl);
 
-    Verilated::traceEverOn(true);
-    m_vcd = new VerilatedVcdC;
-    assert(m_vcd);
-    m_rtl->trace(m_vcd, 99);
-
-    // set systemverilog scope to be able to access dpi functions
-    const std::string scope_name = prefix + "." + top_module;
-    auto* scope = svGetScopeFromName(scope_name.c_str());
-    assert(scope);
-    svSetScope(scope);
+    // dpi scope of this instance, it's set before every dpi call as
+    // the current scope is per thread and other instances may change it
+    const std::string scope_name = m_name + "." + top_module;
+    m_scope = svGetScopeFromName(scope_name.c_str());
+    assert(m_scope);
+
+#ifdef XRV1_SPARSE_RAM
+    map_sparse_ram();
+#else
+    map_ram();
+#endif
+#ifdef XRV1_MEM_TIMING
+    map_mem_timing();
+#endif
+    map_htif();
 
     m_ticks_passed_ = 0;
 }
 
 xrv1_soc::~xrv1_soc() {
+    m_tracer.reset();
     delete m_rtl;
     delete m_ctx;
-    delete m_vcd;
+}
+
+void xrv1_soc::map_ram() {
+    const std::string ram_scope_name = m_name + "." + TOP_MODULE + ".tcm_i.itcm_i";
+    auto* ram_scope = static_cast<const VerilatedScope*>(svGetScopeFromName(ram_scope_name.c_str()));
+    if (!ram_scope)
+        return;
+    auto* ram_var = ram_scope->varFind("ram");
+    if (!ram_var || ram_var->entSize() != 1)
+        return;
+    uint32_t ram_size = get_ram_size_bits();
+    if (ram_var->totalSize() < ram_size)
+        return;
+    m_ram = static_cast<uint8_t*>(ram_var->datap());
+    m_ram_size = ram_size;
+}
+
+void xrv1_soc::map_sparse_ram() {
+    const std::string ram_scope_name = m_name + "." + TOP_MODULE + ".tcm_i.itcm_i";
+    svScope ram_scope = svGetScopeFromName(ram_scope_name.c_str());
+    assert(ram_scope);
+    m_sparse.reset(new xrv1_sparse_mem);
+    svPutUserData(ram_scope, xrv1_sparse_mem::dpi_key(), m_sparse.get());
+}
+
+void xrv1_soc::map_mem_timing() {
+    const std::string tcm_scope_name = m_name + "." + TOP_MODULE + ".tcm_i";
+    svScope tcm_scope = svGetScopeFromName(tcm_scope_name.c_str());
+    assert(tcm_scope);
+    m_mem_timing.reset(new xrv1_mem_timing);
+    svPutUserData(tcm_scope, xrv1_mem_timing::dpi_key(), m_mem_timing.get());
+}
+
+void xrv1_soc::map_htif() {
+    const std::string tcm_scope_name = m_name + "." + TOP_MODULE + ".tcm_i";
+    svScope tcm_scope = svGetScopeFromName(tcm_scope_name.c_str());
+    assert(tcm_scope);
+    m_htif.reset(new xrv1_htif(m_ctx));
+    svPutUserData(tcm_scope, xrv1_htif::dpi_key(), m_htif.get());
 }
 
 void xrv1_soc::write_u8(uint32_t addr, uint8_t data) {
+    if (m_sparse) {
+        m_sparse->write_u8(addr, data);
+        return;
+    }
+    if (m_ram && addr < m_ram_size) {
+        m_ram[addr] = data;
+        return;
+    }
+    svSetScope(m_scope);
     m_rtl->write_u8(addr, data);
 }
 
 uint8_t xrv1_soc::read_u8(uint32_t addr) {
+    if (m_sparse)
+        return m_sparse->read_u8(addr);
+    if (m_ram && addr < m_ram_size)
+        return m_ram[addr];
     char data;
+    svSetScope(m_scope);
     m_rtl->read_u8(addr, &data);
     return static_cast<uint8_t>(data);
 }
 
+void xrv1_soc::write_block(uint32_t addr, const uint8_t* data, size_t size) {
+    if (m_sparse) {
+        m_sparse->write_block(addr, data, size);
+        return;
+    }
+    if (m_ram && addr <= m_ram_size && size <= m_ram_size - addr) {
+        memcpy(m_ram + addr, data, size);
+        return;
+    }
+    Mem32Iface::write_block(addr, data, size);
+}
+
+void xrv1_soc::read_block(uint32_t addr, uint8_t* data, size_t size) {
+    if (m_sparse) {
+        m_sparse->read_block(addr, data, size);
+        return;
+    }
+    if (m_ram && addr <= m_ram_size && size <= m_ram_size - addr) {
+        memcpy(data, m_ram + addr, size);
+        return;
+    }
+    Mem32Iface::read_block(addr, data, size);
+}
+
 uint32_t xrv1_soc::get_ram_size_bits() const {
     int bits;
+    svSetScope(m_scope);
     m_rtl->get_ram_size_bits(&bits);
     return static_cast<uint32_t>(bits);
 }
 
+uint32_t xrv1_soc::get_reset_addr() const {
+    int addr;
+    svSetScope(m_scope);
+    m_rtl->get_reset_addr(&addr);
+    return static_cast<uint32_t>(addr);
+}
+
 uint16_t xrv1_soc::read_u16(uint32_t addr) {
     uint8_t bytes[2];
-    for (int i = 0; i < 2; i++)
-        bytes[i] = read_u8(addr + i);
+    read_block(addr, bytes, sizeof(bytes));
     uint16_t res = ((bytes[1] << 8) | bytes[0]);
     return res;
 }
 
 uint32_t xrv1_soc::read_u32(uint32_t addr) {
     uint8_t bytes[4];
-    for (int i = 0; i < 4; i++)
-        bytes[i] = read_u8(addr + i);
+    read_block(addr, bytes, sizeof(bytes));
     uint32_t res = (bytes[3] << 24) | (bytes[2] << 16) | (bytes[1] << 8) | (bytes[0]);
     return res;
 }
 
 bool xrv1_soc::get_imem_resp_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_imem_resp_vld(&valid);
     return valid;
 }
 
 uint32_t xrv1_soc::get_imem_resp_data() {
     int32_t data;
+    svSetScope(m_scope);
     m_rtl->get_imem_resp_data(&data);
     return static_cast<uint32_t>(data);
 }
 
 bool xrv1_soc::get_imem_req_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_imem_req_vld(&valid);
     return valid;
 }
 
 uint32_t xrv1_soc::get_imem_req_addr() {
-    char valid;
-    m_rtl->get_imem_req_vld(&valid);
-    return valid;
+    int32_t addr;
+    svSetScope(m_scope);
+    m_rtl->get_imem_req_addr(&addr);
+    return static_cast<uint32_t>(addr);
 }
 
 uint32_t xrv1_soc::get_ifetch_insn_data() {
     int32_t data;
+    svSetScope(m_scope);
     m_rtl->get_ifetch_insn_data(&data);
     return static_cast<uint32_t>(data);
 }
 
 uint32_t xrv1_soc::get_ifetch_insn_pc() {
     int32_t pc;
+    svSetScope(m_scope);
     m_rtl->get_ifetch_insn_pc(&pc);
     return static_cast<uint32_t>(pc);
 }
 
 bool xrv1_soc::get_ifetch_insn_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_ifetch_insn_vld(&valid);
     return valid;
 }
 
 uint32_t xrv1_soc::get_if_dec_insn_data() {
     int32_t data;
+    svSetScope(m_scope);
     m_rtl->get_if_dec_insn_data(&data);
     return static_cast<uint32_t>(data);
 }
 
 uint32_t xrv1_soc::get_if_dec_insn_pc() {
     int32_t pc;
+    svSetScope(m_scope);
     m_rtl->get_if_dec_insn_pc(&pc);
     return static_cast<uint32_t>(pc);
 }
 
 bool xrv1_soc::get_if_dec_insn_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_if_dec_insn_vld(&valid);
     return valid;
 }
 
 bool xrv1_soc::get_wb_data_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_wb_data_vld(&valid);
     return valid;
 }
 
 uint32_t xrv1_soc::get_wb_data() {
     int32_t data;
+    svSetScope(m_scope);
     m_rtl->get_wb_data(&data);
     return static_cast<uint32_t>(data);
 }
 
 uint8_t xrv1_soc::get_wb_rd_addr() {
     char addr;
+    svSetScope(m_scope);
     m_rtl->get_wb_rd_addr(&addr);
     return static_cast<uint8_t>(addr);
 }
 
 bool xrv1_soc::get_idecode_issue_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_idecode_issue_vld(&valid);
     return valid;
 }
 
 uint8_t xrv1_soc::get_idecode_itag() {
     char itag;
+    svSetScope(m_scope);
     m_rtl->get_idecode_itag(&itag);
     return static_cast<uint8_t>(itag);
 }
 
 uint8_t xrv1_soc::get_ret_retire_cnt() {
     char cnt;
+    svSetScope(m_scope);
     m_rtl->get_ret_retire_cnt(&cnt);
     return static_cast<uint8_t>(cnt);
 }
 
 uint8_t xrv1_soc::get_iq_retire_itag() {
     char itag;
+    svSetScope(m_scope);
     m_rtl->get_iq_retire_itag(&itag);
     return static_cast<uint8_t>(itag);
 }
 
+void xrv1_soc::get_obs_snapshot(xrv1_obs_snapshot& snap) {
+    svSetScope(m_scope);
+    m_rtl->get_obs_snapshot(reinterpret_cast<svBitVecVal*>(snap.w));
+}
+
+uint64_t xrv1_soc::get_perf_counter(int idx) {
+    long long val = 0;
+    svSetScope(m_scope);
+    m_rtl->get_perf_counter(idx, &val);
+    return static_cast<uint64_t>(val);
+}
+
+void xrv1_soc::get_perf_counters(xrv1_perf_counters& perf) {
+    for (int i = 0; i < XRV1_PERF_NUM; i++)
+        perf.v[i] = get_perf_counter(i);
+}
 
 void xrv1_soc::release_reset() {
     m_rtl->rst_i = 0;
@@ -188,8 +329,8 @@ void xrv1_soc::tick() {
     m_rtl->eval();
     m_rtl->clk_i = !m_rtl->clk_i;
     m_rtl->eval();
-    if (m_vcd)
-        m_vcd->dump(static_cast<uint64_t>(m_ticks_passed_));
+    if (m_tracer)
+        m_tracer->dump(static_cast<uint64_t>(m_ticks_passed_));
     m_ticks_passed_++;
 }
 
@@ -215,13 +356,22 @@ bool xrv1_soc::dump_signature(const std::string& path, int verbose_lvl) {
     auto sig_begin = read_u32(sig_begin_addr);
     auto sig_end = read_u32(sig_end_addr);
     
+    if (sig_end < sig_begin)
+        return false;
+
+    // fetch the whole signature region at once
+    const uint32_t sig_words = (sig_end - sig_begin + 3) / 4;
+    std::vector<uint8_t> sig(sig_words * 4);
+    read_block(sig_begin, sig.data(), sig.size());
+
     auto* fp = fopen(path.c_str(), "w");
     assert(fp);
 
-    for (uint32_t addr = sig_begin; addr < sig_end; addr += 4) {
-        auto val = read_u32(addr);
+    for (uint32_t i = 0; i < sig_words; i++) {
+        const uint8_t* bytes = &sig[i * 4];
+        uint32_t val = (bytes[3] << 24) | (bytes[2] << 16) | (bytes[1] << 8) | (bytes[0]);
         if (verbose_lvl > 0)
-            printf("Mem [0x%08x] : 0x%08x\n", addr, val);
+            printf("Mem [0x%08x] : 0x%08x\n", sig_begin + i * 4, val);
         fprintf(fp, "%08x\n", val);
     }
     fclose(fp);
@@ -234,97 +384,341 @@ bool xrv1_soc::is_simulation_finished() const {
 
 uint32_t xrv1_soc::get_reg_val_u32(uint32_t addr) const {
     int32_t val = 0;
+    svSetScope(m_scope);
     m_rtl->read_register(addr, &val);
     return static_cast<uint32_t>(val);
 }
 
-bool xrv1_soc::run_simulation(int num_cycles, int verbose_lvl) {
-    char inst_dec_buf [1024];
+void xrv1_soc::set_reg_val_u32(uint32_t addr, uint32_t val) {
+    svSetScope(m_scope);
+    m_rtl->write_register(addr, val);
+}
+
+void xrv1_soc::get_regs(uint32_t* regs) const {
+    for (uint32_t i = 0; i < 32; i++)
+        regs[i] = get_reg_val_u32(i);
+}
+
+void xrv1_soc::set_csr_val_u32(uint32_t addr, uint32_t val) {
+    svSetScope(m_scope);
+    m_rtl->write_csr(addr, val);
+}
 
-    if (m_vcd)
-        m_vcd->open("out.vcd");
+void xrv1_soc::set_start_pc(uint32_t pc) {
+    svSetScope(m_scope);
+    m_rtl->set_reset_addr(pc);
+}
 
-    uint32_t prev_fetch_addr = ~0u;
+void xrv1_soc::reset_design() {
+    // tcm takes the tohost address of the loaded elf during reset
+    m_htif->set_tohost_addr(m_elf_loader.get_address_tohost());
+    m_htif->reset();
 
     // set reset to 1, clk to 0 and evaluate design
     m_rtl->clk_i = 0;
     m_rtl->rst_i = 1;
     tick();
     tick();
-    
+
     // release design reset
     release_reset();
+    m_step_recorder.reset();
+}
 
-    // number of instructions retired
-    uint32_t icnt = 0;
-    // number of cycles passed
-    uint32_t ccnt = 0;
+void xrv1_soc::clear_state() {
+    m_ctx->gotFinish(false);
 
-    while (true) {
-        // check if we need to stop simulation
-        if (((ccnt >= num_cycles) && (num_cycles != -1)) || m_ctx->gotFinish()) {
-            break;
-        }
+    if (m_sparse) {
+        m_sparse->clear();
+    } else {
+        std::vector<uint8_t> zeros(get_ram_size_bits(), 0);
+        write_block(0, zeros.data(), zeros.size());
+    }
 
-        if (get_imem_resp_vld()) {
-            uint32_t idata = get_imem_resp_data();
-            riscv_inst_decode(inst_dec_buf, prev_fetch_addr, idata);
-            if (verbose_lvl > 0)
-                printf("[IF] %s\n", inst_dec_buf);
-        }
+    for (uint32_t i = 1; i < 32; i++)
+        set_reg_val_u32(i, 0);
+}
 
-        if (get_imem_req_vld()) {
-            prev_fetch_addr = get_imem_req_addr();
-            //printf("(IF->IMEM) 0x%x\n", prev_fetch_addr);
-        }
+int64_t xrv1_soc::get_last_run_cycles() const {
+    return m_last_run_cycles;
+}
+
+double xrv1_soc::get_cycles_per_sec() const {
+    return m_cycles_per_sec;
+}
+
+const char* xrv1_soc::get_flavor() {
+    return XRV1_MODEL_FLAVOR;
+}
+
+bool xrv1_soc::has_coverage() {
+#ifdef XRV1_COVERAGE
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool xrv1_soc::write_coverage(const std::string& path) {
+#ifdef XRV1_COVERAGE
+    // coverage points are per context, so parallel models don't mix
+    m_ctx->coveragep()->write(path.c_str());
+    return true;
+#else
+    (void)path;
+    printf("Coverage is not compiled in, use the debug model\n");
+    return false;
+#endif
+}
+
+void xrv1_soc::clear_coverage() {
+#ifdef XRV1_COVERAGE
+    m_ctx->coveragep()->zero();
+#endif
+}
+
+bool xrv1_soc::set_trace(const xrv1_trace_cfg& cfg) {
+    // verilator requires tracing to be turned on before time 0
+    if (m_ticks_passed_ > 0 && !m_trace_ever_on) {
+        printf("Tracing must be configured before the simulation starts\n");
+        return false;
+    }
+    m_tracer.reset();
+    if (cfg.mode == xrv1_trace_mode::OFF)
+        return true;
+    if (!xrv1_tracer::is_supported(cfg.mode)) {
+        printf("Requested trace format is not compiled in, see TRACE_FORMAT cmake option\n");
+        return false;
+    }
+
+    m_ctx->traceEverOn(true);
+    m_trace_ever_on = true;
+
+    m_tracer.reset(new xrv1_tracer(cfg));
+    if (!m_tracer->open(m_rtl)) {
+        m_tracer.reset();
+        return false;
+    }
+    return true;
+}
+
+bool xrv1_soc::set_commit_log(const std::string& path) {
+    m_commit_log.reset();
+    if (path.empty())
+        return true;
+    m_commit_log.reset(new xrv1_commit_log);
+    if (!m_commit_log->open(path)) {
+        m_commit_log.reset();
+        return false;
+    }
+    return true;
+}
+
+bool xrv1_soc::set_mem_timing(const xrv1_mem_timing_cfg& cfg) {
+    if (!m_mem_timing) {
+        printf("Memory timing is not compiled in, see MEM_TIMING cmake option\n");
+        return false;
+    }
+    m_mem_timing->configure(cfg);
+    return true;
+}
+
+void xrv1_soc::set_cosim(bool enable) {
+    m_cosim_enabled = enable;
+}
+
+void xrv1_soc::set_cosim_async(bool enable) {
+    m_cosim_async = enable;
+}
+
+std::string xrv1_soc::get_cosim_report() const {
+    return m_cosim ? m_cosim->get_report() : std::string();
+}
+
+void xrv1_soc::request_stop() {
+    m_stop_requested = true;
+}
+
+int64_t xrv1_soc::step(int64_t num_cycles, std::vector<xrv1_commit_rec>& recs) {
+    m_step_recorder.m_recs.clear();
+    int64_t ccnt = run_cycles(num_cycles, m_step_recorder);
+    m_step_recorder.m_cycle_base += ccnt;
+    m_last_run_cycles = ccnt;
+    recs.swap(m_step_recorder.m_recs);
+    return ccnt;
+}
+
+bool xrv1_soc::run_simulation(int num_cycles, int verbose_lvl) {
+    return run(num_cycles, verbose_lvl, true);
+}
+
+bool xrv1_soc::continue_simulation(int num_cycles, int verbose_lvl) {
+    return run(num_cycles, verbose_lvl, false);
+}
 
-        if (get_ifetch_insn_vld()) {
-            uint32_t i_data = get_ifetch_insn_data();
-            uint32_t i_pc = get_ifetch_insn_pc();
-            riscv_inst_decode(inst_dec_buf, i_pc, i_data);
-            if (verbose_lvl > 0)
-                printf("(IF->DEC) %s\n", inst_dec_buf);
+bool xrv1_soc::run(int num_cycles, int verbose_lvl, bool from_reset) {
+    m_cosim.reset();
+    // isa model starts from reset, it can't pick up a running design
+    if (m_cosim_enabled && !from_reset && verbose_lvl >= 0)
+        printf("Cosim is skipped when continuing simulation\n");
+    if (m_cosim_enabled && from_reset) {
+        m_cosim.reset(new xrv1_cosim(&m_stop_requested));
+        if (!m_cosim->init(*this, get_ram_size_bits(), get_reset_addr(), m_cosim_async)) {
+            printf("Failed to set up cosim model\n");
+            return false;
         }
+    }
 
-        if (get_if_dec_insn_vld()) {
-            uint32_t i_data = get_if_dec_insn_data();
-            uint32_t i_pc = get_if_dec_insn_pc();
-            riscv_inst_decode(inst_dec_buf, i_pc, i_data);
-            if (verbose_lvl > 0)
-                printf("[IF/DEC] %s", inst_dec_buf);
-            if (get_idecode_issue_vld()) {
-                if (verbose_lvl > 0)
-                    printf(" itag=%d", get_idecode_itag());
-            }
-            if (verbose_lvl > 0)
-                printf("\n");
+    if (from_reset)
+        reset_design();
+
+    // decode and print pipeline activity only if asked to
+    xrv1_pipe_printer printer;
+    int64_t ccnt = run_optional(num_cycles, std::tuple<>(),
+                                verbose_lvl > 0 ? &printer : nullptr,
+                                m_tracer.get(),
+                                m_commit_log.get(),
+                                m_cosim.get());
+
+    m_last_run_cycles = ccnt;
+    if (verbose_lvl >= 0)
+        printf("Simulation finished in %d cycles (%.0f cycles/sec)\n", static_cast<int>(ccnt), m_cycles_per_sec);
+    if (verbose_lvl >= 0 && get_exit_code() >= 0)
+        printf("Program exited with code %d\n", get_exit_code());
+    if (verbose_lvl >= 0) {
+        xrv1_perf_counters perf;
+        get_perf_counters(perf);
+        perf.print();
+        if (m_mem_timing)
+            m_mem_timing->print();
+    }
+
+    // waveform and commit log are complete once the run is over
+    m_tracer.reset();
+    m_commit_log.reset();
+
+    if (m_cosim) {
+        if (!m_cosim->finish()) {
+            if (verbose_lvl >= 0)
+                printf("%s", m_cosim->get_report().c_str());
+            return false;
         }
+        if (verbose_lvl >= 0)
+            printf("Cosim passed, %llu instructions checked\n",
+                   static_cast<unsigned long long>(m_cosim->get_checked()));
+    }
 
-	    uint8_t ret_cnt = get_ret_retire_cnt();
-        if (ret_cnt > 0) {
-            icnt += ret_cnt;
-            if (verbose_lvl > 0)
-                printf("RETIRE(%d) %d itag=%d", ret_cnt, icnt, get_iq_retire_itag());
-            if (get_wb_data_vld()) {
-                uint8_t wb_rd = get_wb_rd_addr();
-                uint32_t wb_data = get_wb_data();
-                if (verbose_lvl > 0)
-                    printf(" (WB) RF[%d] <- 0x%x", wb_rd, wb_data);
-            }
-            if (verbose_lvl > 0)
-                printf("\n");
+    return true;
+}
+
+#ifdef XRV1_SAVABLE
+// checkpoint file header, followed by verilated model state and, for the
+// sparse ram, the page count and the number and data of each allocated page
+#define XRV1_CKPT_MAGIC     "XRV1CKPT"
+#define XRV1_CKPT_VERSION   3
+
+struct xrv1_ckpt_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t ram_size;
+    int64_t  ticks;
+    uint32_t addr_tohost;
+    uint32_t addr_fromhost;
+    uint32_t addr_sig_begin;
+    uint32_t addr_sig_end;
+};
+
+bool xrv1_soc::save_checkpoint(const std::string& path) {
+    VerilatedSave os;
+    os.open(path.c_str());
+    if (!os.isOpen()) {
+        printf("Failed to open checkpoint: %s\n", path.c_str());
+        return false;
+    }
+
+    xrv1_ckpt_header hdr;
+    memcpy(hdr.magic, XRV1_CKPT_MAGIC, sizeof(hdr.magic));
+    hdr.version = XRV1_CKPT_VERSION;
+    hdr.ram_size = get_ram_size_bits();
+    hdr.ticks = m_ticks_passed_;
+    hdr.addr_tohost = m_elf_loader.get_address_tohost();
+    hdr.addr_fromhost = m_elf_loader.get_address_fromhost();
+    hdr.addr_sig_begin = m_elf_loader.get_address_sig_begin();
+    hdr.addr_sig_end = m_elf_loader.get_address_sig_end();
+    os.write(&hdr, sizeof(hdr));
+
+    // array rams are part of the model state
+    os << *m_rtl;
+
+    // the sparse store lives outside of the model, untouched pages are skipped
+    if (m_sparse) {
+        uint32_t num_pages = m_sparse->get_num_pages();
+        os.write(&num_pages, sizeof(num_pages));
+        for (uint32_t num = 0; num < m_sparse->get_max_pages(); num++) {
+            const uint8_t* page = m_sparse->get_page(num);
+            if (!page)
+                continue;
+            os.write(&num, sizeof(num));
+            os.write(page, xrv1_sparse_mem::k_page_size);
         }
-        if (verbose_lvl > 0)
-            printf("================================================================================\n");
+    }
+
+    os.close();
+    return true;
+}
+
+bool xrv1_soc::restore_checkpoint(const std::string& path) {
+    VerilatedRestore os;
+    os.open(path.c_str());
+    if (!os.isOpen()) {
+        printf("Failed to open checkpoint: %s\n", path.c_str());
+        return false;
+    }
 
-        tick();
-        ccnt++;
+    xrv1_ckpt_header hdr;
+    os.read(&hdr, sizeof(hdr));
+    if (memcmp(hdr.magic, XRV1_CKPT_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.version != XRV1_CKPT_VERSION ||
+        hdr.ram_size != get_ram_size_bits()) {
+        printf("Checkpoint %s doesn't match this model\n", path.c_str());
+        return false;
     }
 
-    printf("Simulation finished in %d cycles\n", ccnt);
+    // verilator itself checks that the model matches the saved one
+    os >> *m_rtl;
+
+    if (m_sparse) {
+        m_sparse->clear();
+        uint32_t num_pages = 0;
+        os.read(&num_pages, sizeof(num_pages));
+        for (uint32_t i = 0; i < num_pages; i++) {
+            uint32_t num = 0;
+            os.read(&num, sizeof(num));
+            if (num >= m_sparse->get_max_pages()) {
+                printf("Checkpoint %s has a bad ram page\n", path.c_str());
+                return false;
+            }
+            os.read(m_sparse->alloc_page(num), xrv1_sparse_mem::k_page_size);
+        }
+    }
 
-    if (m_vcd)
-        m_vcd->close();
+    os.close();
 
+    m_ticks_passed_ = hdr.ticks;
+    m_elf_loader.set_section_addresses(hdr.addr_tohost, hdr.addr_fromhost,
+                                       hdr.addr_sig_begin, hdr.addr_sig_end);
     return true;
-}
\ No newline at end of file
+}
+#else
+bool xrv1_soc::save_checkpoint(const std::string& path) {
+    (void)path;
+    printf("Checkpoints are not compiled in, see SAVABLE cmake option\n");
+    return false;
+}
+
+bool xrv1_soc::restore_checkpoint(const std::string& path) {
+    (void)path;
+    printf("Checkpoints are not compiled in, see SAVABLE cmake option\n");
+    return false;
+}
+#endif
@@ -4,12 +4,23 @@
 #include "xrv1_soc.hpp"
 #include "elf_loader.hpp"
 #include "memory_base.hpp"
+#include "xrv1_observers.hpp"
+#include "xrv1_trace.hpp"
+#include "xrv1_commit_log.hpp"
+#include "xrv1_cosim.hpp"
+#include "xrv1_perf.hpp"
+#include "xrv1_sparse_mem.hpp"
+#include "xrv1_mem_timing.hpp"
+#include "xrv1_htif.hpp"
 
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <tuple>
 
 class Vxrv1_sim_top;
 class VerilatedContext;
-class VerilatedVcdC;
 
 class xrv1_soc: public Mem32Iface
 {
@@ -42,14 +53,33 @@ public:
     uint8_t get_ret_retire_cnt();
     uint8_t get_iq_retire_itag();
 
+    // sample all of the above with one dpi call
+    void get_obs_snapshot(xrv1_obs_snapshot& snap);
+
+    // performance counter of xrv1_perf_counter, zero in non-simulation builds
+    uint64_t get_perf_counter(int idx);
+    void get_perf_counters(xrv1_perf_counters& perf);
+
     void write_u8(uint32_t addr, uint8_t data);
     uint8_t read_u8(uint32_t addr);
+    void write_block(uint32_t addr, const uint8_t* data, size_t size) override;
+    void read_block(uint32_t addr, uint8_t* data, size_t size) override;
     uint16_t read_u16(uint32_t addr);
     uint32_t read_u32(uint32_t addr);
 
+    // direct pointer to the ram image, nullptr if it's only reachable through dpi
+    uint8_t* get_ram_ptr() { return m_ram; }
     uint32_t get_ram_size_bits() const;
+    uint32_t get_reset_addr() const;
 
     uint32_t get_reg_val_u32(uint32_t addr) const;
+    void set_reg_val_u32(uint32_t addr, uint32_t val);
+    // all 32 integer registers, x0 included
+    void get_regs(uint32_t* regs) const;
+    // write csr directly, only csrs implemented by the design are affected
+    void set_csr_val_u32(uint32_t addr, uint32_t val);
+    // pc the design starts from after the next reset (simulation builds only)
+    void set_start_pc(uint32_t pc);
 
 
     // release reset for design
@@ -62,8 +92,62 @@ public:
     int64_t get_ticks_number() const;
     // load elf
     bool load_elf(const std::string& elf_path, int verbose_lvl);
-    // runs simulation
+    // hold design in reset for two cycles and release it
+    void reset_design();
+    // clear memory, registers and finish flag so that the instance
+    // could run another test
+    void clear_state();
+    // runs simulation, verbose_lvl < 0 suppresses all output
     bool run_simulation(int num_cycles, int verbose_lvl = 0);
+    // same as run_simulation but continues from the current state
+    // (e.g. a restored checkpoint) instead of resetting the design
+    bool continue_simulation(int num_cycles, int verbose_lvl = 0);
+    // save design state, memory and tick count, needs SAVABLE build
+    bool save_checkpoint(const std::string& path);
+    // restore state written by save_checkpoint of the same build
+    bool restore_checkpoint(const std::string& path);
+    // run num_cycles from the current state collecting retired instructions
+    // into recs (replaced, not appended), returns number of cycles done.
+    // A new program is started with reset_design
+    int64_t step(int64_t num_cycles, std::vector<xrv1_commit_rec>& recs);
+    // number of cycles done by the last run_simulation call
+    int64_t get_last_run_cycles() const;
+    // tick for num_cycles (-1 means until $finish) calling observers every cycle,
+    // returns number of cycles done
+    template <typename... Observers>
+    int64_t run_cycles(int64_t num_cycles, Observers&... observers);
+    // simulation speed of the last run_cycles call
+    double get_cycles_per_sec() const;
+    // configure waveform tracing, must be done before the first tick
+    bool set_trace(const xrv1_trace_cfg& cfg);
+    // write binary commit log of the next run, empty path turns it off
+    bool set_commit_log(const std::string& path);
+    // memory timing of the tcm, needs MEM_TIMING build. Takes effect at
+    // the next reset, caches start cold on every reset
+    bool set_mem_timing(const xrv1_mem_timing_cfg& cfg);
+    // timing model with the statistics of the last run, nullptr if not built in
+    const xrv1_mem_timing* get_mem_timing() const { return m_mem_timing.get(); }
+    // model flavor of this build, "fast" or "debug" (coverage and tracing)
+    static const char* get_flavor();
+    static bool has_coverage();
+    // write coverage counts collected since the last clear_coverage as
+    // coverage.dat, needs the debug flavor
+    bool write_coverage(const std::string& path);
+    void clear_coverage();
+    // exit code the program wrote to tohost in the last run, -1 if it
+    // ended (or timed out) some other way
+    int get_exit_code() const { return m_htif->get_exit_code(); }
+    // tohost console output of the last run, echoed to stdout by default
+    const std::string& get_console() const { return m_htif->get_console(); }
+    void set_console_echo(bool echo) { m_htif->set_console_echo(echo); }
+    // check retired instructions against the isa model during runs
+    void set_cosim(bool enable);
+    // run the isa model ahead on its own thread instead of stepping it in lock-step
+    void set_cosim_async(bool enable);
+    // description of the first cosim mismatch, empty if there was none
+    std::string get_cosim_report() const;
+    // make run_cycles return after the current cycle
+    void request_stop();
     // dump arch test signature
     bool dump_signature(const std::string& path, int verbose_lvl);
     // check if simulation is really finished
@@ -72,12 +156,101 @@ public:
 public:
     Vxrv1_sim_top* m_rtl = nullptr;
     VerilatedContext* m_ctx = nullptr;
-    VerilatedVcdC* m_vcd = nullptr;
+    // waveform tracer, null if tracing is off
+    std::unique_ptr<xrv1_tracer> m_tracer;
+    // commit log writer, null if commit log is off
+    std::unique_ptr<xrv1_commit_log> m_commit_log;
+    // isa model checker of the last run
+    std::unique_ptr<xrv1_cosim> m_cosim;
 
     // number of cycles passed from the simulation start
     int64_t m_ticks_passed_ = -1;
     // elf loader
     ElfLoaderArchTests m_elf_loader;
+    // instances are independent, but one instance must be driven by one
+    // thread at a time. Held by the python binding around calls which run
+    // without the GIL
+    std::mutex m_mutex;
+
+private:
+    // unique model name of this instance
+    std::string m_name;
+    // dpi scope of the top module
+    void* m_scope = nullptr;
+
+    // find verilated ram array to access it without dpi calls
+    void map_ram();
+    // attach the paged store to the ram instance of SPARSE_RAM builds
+    void map_sparse_ram();
+    // attach the timing model to the tcm instance of MEM_TIMING builds
+    void map_mem_timing();
+    // attach the tohost handler to the tcm instance
+    void map_htif();
+    // run observers over num_cycles, optionally after reset
+    bool run(int num_cycles, int verbose_lvl, bool from_reset);
+
+    // run_cycles with the given observers plus the non-null optional ones
+    template <typename... Active>
+    int64_t run_optional(int64_t num_cycles, std::tuple<Active&...> active);
+    template <typename... Active, typename T, typename... Rest>
+    int64_t run_optional(int64_t num_cycles, std::tuple<Active&...> active, T* opt, Rest*... rest);
+
+    // retirements seen by step since the last reset
+    xrv1_retire_recorder m_step_recorder;
+
+    // direct pointer to the ram image or nullptr if it's not available
+    uint8_t* m_ram = nullptr;
+    uint32_t m_ram_size = 0;
+    // backing store of the sparse ram, nullptr in array ram builds
+    std::unique_ptr<xrv1_sparse_mem> m_sparse;
+    // tcm timing model, nullptr in ideal memory builds
+    std::unique_ptr<xrv1_mem_timing> m_mem_timing;
+    // tohost stores of the design
+    std::unique_ptr<xrv1_htif> m_htif;
+
+    double m_cycles_per_sec = 0.0;
+    int64_t m_last_run_cycles = 0;
+    // tracing has been enabled in verilated context
+    bool m_trace_ever_on = false;
+    bool m_cosim_enabled = false;
+    bool m_cosim_async = false;
+    bool m_stop_requested = false;
 };
 
+template <typename... Observers>
+int64_t xrv1_soc::run_cycles(int64_t num_cycles, Observers&... observers) {
+    // skip sampling altogether if nobody looks at it
+    constexpr bool needs_snapshot = (false || ... || Observers::k_needs_snapshot);
+    xrv1_obs_snapshot snap;
+    int64_t ccnt = 0;
+    m_stop_requested = false;
+
+    auto start = std::chrono::steady_clock::now();
+    while ((num_cycles == -1 || ccnt < num_cycles) && !is_simulation_finished() && !m_stop_requested) {
+        if constexpr (needs_snapshot)
+            get_obs_snapshot(snap);
+        (observers.on_cycle(ccnt, snap), ...);
+        tick();
+        ccnt++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    m_cycles_per_sec = elapsed.count() > 0 ? ccnt / elapsed.count() : 0.0;
+
+    return ccnt;
+}
+
+template <typename... Active>
+int64_t xrv1_soc::run_optional(int64_t num_cycles, std::tuple<Active&...> active) {
+    return std::apply([&](Active&... observers) {
+        return run_cycles(num_cycles, observers...);
+    }, active);
+}
+
+template <typename... Active, typename T, typename... Rest>
+int64_t xrv1_soc::run_optional(int64_t num_cycles, std::tuple<Active&...> active, T* opt, Rest*... rest) {
+    if (opt)
+        return run_optional(num_cycles, std::tuple_cat(active, std::tie(*opt)), rest...);
+    return run_optional(num_cycles, active, rest...);
+}
+
 #endif /* __XRV1_SOC_HPP__ */
@@ -0,0 +1,73 @@
+#include "xrv1_sparse_mem.hpp"
+
+#include <algorithm>
+
+#include "svdpi.h"
+
+uint8_t* xrv1_sparse_mem::page(uint32_t addr) {
+    auto& page = m_pages[addr >> k_page_bits];
+    if (!page) {
+        page.reset(new uint8_t[k_page_size]());
+        m_num_pages++;
+    }
+    return page.get();
+}
+
+void xrv1_sparse_mem::write_u8(uint32_t addr, uint8_t data) {
+    page(addr)[addr & k_page_mask] = data;
+}
+
+uint8_t xrv1_sparse_mem::read_u8(uint32_t addr) {
+    const uint8_t* page = m_pages[addr >> k_page_bits].get();
+    return page ? page[addr & k_page_mask] : 0;
+}
+
+void xrv1_sparse_mem::write_block(uint32_t addr, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        size_t chunk = std::min<size_t>(size, k_page_size - (addr & k_page_mask));
+        memcpy(page(addr) + (addr & k_page_mask), data, chunk);
+        addr += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+void xrv1_sparse_mem::read_block(uint32_t addr, uint8_t* data, size_t size) {
+    while (size > 0) {
+        size_t chunk = std::min<size_t>(size, k_page_size - (addr & k_page_mask));
+        const uint8_t* page = m_pages[addr >> k_page_bits].get();
+        if (page)
+            memcpy(data, page + (addr & k_page_mask), chunk);
+        else
+            memset(data, 0, chunk);
+        addr += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+void xrv1_sparse_mem::clear() {
+    for (auto& page : m_pages)
+        page.reset();
+    m_num_pages = 0;
+}
+
+void* xrv1_sparse_mem::dpi_key() {
+    static char key;
+    return &key;
+}
+
+// DPI imports of xrv1_sim_sparse_ram, the calling ram instance tells
+// which model's store to use
+
+static xrv1_sparse_mem* scope_mem() {
+    return static_cast<xrv1_sparse_mem*>(svGetUserData(svGetScope(), xrv1_sparse_mem::dpi_key()));
+}
+
+extern "C" unsigned int xrv1_sparse_read32(unsigned int addr) {
+    return scope_mem()->read32(addr);
+}
+
+extern "C" void xrv1_sparse_write32(unsigned int addr, unsigned int data, unsigned char be) {
+    scope_mem()->write32(addr, data, be);
+}
@@ -0,0 +1,62 @@
+#ifndef __XRV1_SPARSE_MEM_HPP__
+#define __XRV1_SPARSE_MEM_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "memory_base.hpp"
+
+// Paged backing store of xrv1_sim_sparse_ram (SPARSE_RAM builds). Pages
+// are allocated and zeroed on first write, reads of untouched pages return
+// zeros, so only the used part of a large address space costs memory.
+class xrv1_sparse_mem: public Mem32Iface
+{
+public:
+    static constexpr uint32_t k_page_bits = 16;
+    static constexpr uint32_t k_page_size = 1u << k_page_bits;
+    static constexpr uint32_t k_page_mask = k_page_size - 1;
+
+    xrv1_sparse_mem() : m_pages(1u << (32 - k_page_bits)) {}
+
+    // word access of the design, addr is word aligned, little endian host
+    uint32_t read32(uint32_t addr) const {
+        const uint8_t* page = m_pages[addr >> k_page_bits].get();
+        uint32_t val = 0;
+        if (page)
+            memcpy(&val, page + (addr & k_page_mask), sizeof(val));
+        return val;
+    }
+    void write32(uint32_t addr, uint32_t data, uint8_t be) {
+        uint8_t* p = page(addr) + (addr & k_page_mask);
+        for (int i = 0; i < 4; i++)
+            if (be & (1 << i))
+                p[i] = static_cast<uint8_t>(data >> (8 * i));
+    }
+
+    void write_u8(uint32_t addr, uint8_t data) override;
+    uint8_t read_u8(uint32_t addr) override;
+    void write_block(uint32_t addr, const uint8_t* data, size_t size) override;
+    void read_block(uint32_t addr, uint8_t* data, size_t size) override;
+
+    // drop all pages, memory reads as zeros afterwards
+    void clear();
+    size_t get_num_pages() const { return m_num_pages; }
+
+    // page by number (addr >> k_page_bits), null if never written
+    const uint8_t* get_page(uint32_t num) const { return m_pages[num].get(); }
+    uint8_t* alloc_page(uint32_t num) { return page(num << k_page_bits); }
+    uint32_t get_max_pages() const { return static_cast<uint32_t>(m_pages.size()); }
+
+    // key of the svPutUserData entry pointing to the store of a ram scope
+    static void* dpi_key();
+
+private:
+    uint8_t* page(uint32_t addr);
+
+    std::vector<std::unique_ptr<uint8_t[]>> m_pages;
+    size_t m_num_pages = 0;
+};
+
+#endif /* __XRV1_SPARSE_MEM_HPP__ */
@@ -1,53 +1,69 @@
 #include "xrv1_tb.hpp"
 #include "elf_loader.hpp"
+#include "xrv1_perf.hpp"
 #include "isa_sim/riscv_inst_dump.h"
 
-// verilator includes
-#include "Vxrv1_sim_top.h"
+#include <algorithm>
+#include <chrono>
 
-xrv1_tb::xrv1_tb(sc_module_name name, const std::string elf_filename, uint64_t cycle_count) :
+xrv1_tb::xrv1_tb(sc_module_name name, const xrv1_tb_cfg& cfg) :
     sc_module(name),
-    m_elf_filename(elf_filename),
-    m_cycle_count(cycle_count)
+    m_cfg(cfg)
 {
-    SC_CTHREAD(process, clk);
+    if (m_cfg.quantum > 0) {
+        SC_THREAD(process_decoupled);
+    } else {
+        SC_CTHREAD(process, clk);
+    }
 
     m_dut = new xrv1_top("dut");
-    m_ctx = new VerilatedContext;
     m_dut->clk_i(clk);
     m_dut->rst_i(rst_i);
 }
 
-void xrv1_tb::process() {
-
+bool xrv1_tb::load_elf() {
     printf("================================================================================\n");
-    ElfLoader elf_loader(m_elf_filename.c_str(), m_dut);
-    if (!elf_loader.load()) {
+    // no ram size check, the tcm size is a parameter of the verilated design
+    ElfLoaderArchTests elf_loader(m_dut);
+    const bool ok = elf_loader.load_data(m_cfg.elf_filename.c_str(), ~0u, 0);
+    if (!ok) {
         std::cout << "Failed to load!" << std::endl;
     }
+    // programs writing tohost end the run as soon as they're done
+    m_dut->get_htif()->set_tohost_addr(elf_loader.get_address_tohost());
     printf("================================================================================\n\n");
+    return ok;
+}
+
+void xrv1_tb::process() {
+    load_elf();
+    const auto start = std::chrono::steady_clock::now();
 
     char inst_dec_buf [1024];
 
-    uint32_t cycle_count;
+    int64_t cycle_count = 0;
     uint32_t prev_fetch_addr = ~0u;
+    const bool verbose = m_cfg.verbose > 0;
 
     rst_i.write(true);
     wait();
     rst_i.write(false);
 
     uint32_t icnt = 0;
-    uint32_t ccnt = 0;
-
 
     while (true) {
         cycle_count += 1;
-        if ((cycle_count >= m_cycle_count && m_cycle_count != -1) || m_ctx->gotFinish())
+        if ((cycle_count >= m_cfg.cycle_count && m_cfg.cycle_count != -1) || m_dut->is_finished())
             break;
 
+        if (!verbose) {
+            wait();
+            continue;
+        }
+
         if (m_dut->get_imem_resp_vld()) {
             uint32_t idata = m_dut->get_imem_resp_data();
-            riscv_inst_decode(inst_dec_buf, prev_fetch_addr, idata);
+            riscv_inst_decode(inst_dec_buf, sizeof(inst_dec_buf), prev_fetch_addr, idata);
             printf("[IF] %s\n", inst_dec_buf);
         }
 
@@ -59,14 +75,14 @@ void xrv1_tb::process() {
         if (m_dut->get_ifetch_insn_vld()) {
             uint32_t i_data = m_dut->get_ifetch_insn_data();
             uint32_t i_pc = m_dut->get_ifetch_insn_pc();
-            riscv_inst_decode(inst_dec_buf, i_pc, i_data);
+            riscv_inst_decode(inst_dec_buf, sizeof(inst_dec_buf), i_pc, i_data);
             printf("(IF->DEC) %s\n", inst_dec_buf);
         }
 
         if (m_dut->get_if_dec_insn_vld()) {
             uint32_t i_data = m_dut->get_if_dec_insn_data();
             uint32_t i_pc = m_dut->get_if_dec_insn_pc();
-            riscv_inst_decode(inst_dec_buf, i_pc, i_data);
+            riscv_inst_decode(inst_dec_buf, sizeof(inst_dec_buf), i_pc, i_data);
             printf("[IF/DEC] %s", inst_dec_buf);
             if (m_dut->get_idecode_issue_vld()) {
                 printf(" itag=%d", m_dut->get_idecode_itag());
@@ -74,7 +90,7 @@ void xrv1_tb::process() {
             printf("\n");
         }
 
-	uint8_t ret_cnt = m_dut->get_ret_retire_cnt();
+        uint8_t ret_cnt = m_dut->get_ret_retire_cnt();
         if (ret_cnt > 0) {
             icnt += ret_cnt;
             printf("RETIRE(%d) %d itag=%d", ret_cnt, icnt, m_dut->get_iq_retire_itag());
@@ -87,11 +103,51 @@ void xrv1_tb::process() {
         }
 
         wait();
-        ccnt++;
         printf("================================================================================\n");
     }
 
-    printf("IPC: %f\n", float(icnt)/float(ccnt));
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    summary(m_dut->get_cycles(), wall.count());
+}
+
+void xrv1_tb::process_decoupled() {
+    load_elf();
+    const auto start = std::chrono::steady_clock::now();
+    const sc_time period(m_cfg.period_ns, SC_NS);
+
+    m_dut->set_decoupled(true);
+    m_dut->reset();
+
+    uint64_t remaining = m_cfg.cycle_count < 0 ? UINT64_MAX : static_cast<uint64_t>(m_cfg.cycle_count);
+    while (remaining > 0 && !m_dut->is_finished()) {
+        const uint64_t ran = m_dut->run_cycles(std::min(m_cfg.quantum, remaining));
+        remaining -= ran;
+        // sync with the kernel, other modules see the time the dut spent
+        wait(period * static_cast<double>(ran));
+    }
+
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    summary(m_dut->get_cycles(), wall.count());
+}
+
+void xrv1_tb::summary(uint64_t cycles, double wall_s) {
+    xrv1_perf_counters perf;
+    for (int i = 0; i < XRV1_PERF_NUM; i++)
+        perf.v[i] = m_dut->get_perf_counter(i);
+
+    const uint64_t instret = perf.v[XRV1_PERF_INSTRET];
+    printf("Cycles: %llu instret: %llu IPC: %f\n",
+           static_cast<unsigned long long>(cycles),
+           static_cast<unsigned long long>(instret),
+           cycles ? double(instret) / double(cycles) : 0.0);
+    printf("Wall time: %.3f s, %.1f kHz simulated\n",
+           wall_s, wall_s > 0 ? cycles / wall_s / 1e3 : 0.0);
+    if (m_dut->get_htif()->get_exit_code() >= 0)
+        printf("Program exited with code %d\n", m_dut->get_htif()->get_exit_code());
+
+    perf.print();
+    if (m_dut->get_mem_timing())
+        m_dut->get_mem_timing()->print();
 
     sc_stop();
 }
@@ -2,12 +2,23 @@
 #define __XRV1_TB_7612_HPP__
 
 #include <systemc.h>
-#include "verilated.h"
-#include "verilated_vcd_sc.h"
 
 #include "xrv1_top.hpp"
 
 
+struct xrv1_tb_cfg {
+    std::string elf_filename;
+    // cycles to run, -1 runs until $finish
+    int64_t cycle_count = 100;
+    // cycles the model runs per SystemC activation, 0 steps it on every
+    // clock edge
+    uint64_t quantum = 0;
+    // > 0 prints the pipeline every cycle (cycle mode only)
+    int verbose = 0;
+    // simulated clock period
+    double period_ns = 10;
+};
+
 class xrv1_tb : public sc_module {
 public:
     sc_in<bool> clk;
@@ -16,17 +27,21 @@ public:
     sc_signal<bool> rst_i;
 
     xrv1_top* m_dut = nullptr;
-    VerilatedContext* m_ctx = nullptr;
 
     SC_HAS_PROCESS(xrv1_tb);
-    xrv1_tb(sc_module_name name, const std::string elf_filename, uint64_t cycle_count);
+    xrv1_tb(sc_module_name name, const xrv1_tb_cfg& cfg);
 
+    // one wait() per clock, the dut follows clk
     void process();
+    // temporally decoupled: the dut runs up to a quantum of cycles ahead and
+    // the thread then waits for the simulated time of the cycles done
+    void process_decoupled();
 
 protected:
-    const std::string m_elf_filename;
-    uint64_t m_cycle_count;
-    VerilatedVcdC* m_verilate_vcd = nullptr;
+    bool load_elf();
+    void summary(uint64_t cycles, double wall_s);
+
+    const xrv1_tb_cfg m_cfg;
 };
 
 
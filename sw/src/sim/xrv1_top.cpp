@@ -4,139 +4,224 @@
 
 // verilator includes
 #include "Vxrv1_sim_top.h"
+#include "verilated.h"
 
 xrv1_top::xrv1_top(sc_module_name name) : sc_module(name)
 {
-    m_rtl = new Vxrv1_sim_top("Vxrv1_sim_top");
+    // plain C++ model driven from here, so that it can run ahead of the
+    // SystemC kernel in decoupled mode
+    m_ctx = new VerilatedContext;
+    m_rtl = new Vxrv1_sim_top(m_ctx, this->name());
 
-    std::string scope_name{"tb.dut."};
-    scope_name += std::string(VERILATOR_PREFIX) + "." + std::string(TOP_MODULE);
+    const std::string scope_name = std::string(this->name()) + "." + TOP_MODULE;
+    m_scope = svGetScopeFromName(scope_name.c_str());
+    assert(m_scope);
 
-    auto* scope = svGetScopeFromName(scope_name.c_str());
-    assert(scope);
-    svSetScope(scope);
+#ifdef XRV1_SPARSE_RAM
+    auto* ram_scope = svGetScopeFromName((scope_name + ".tcm_i.itcm_i").c_str());
+    assert(ram_scope);
+    m_sparse.reset(new xrv1_sparse_mem);
+    svPutUserData(ram_scope, xrv1_sparse_mem::dpi_key(), m_sparse.get());
+#endif
+#ifdef XRV1_MEM_TIMING
+    auto* tcm_scope = svGetScopeFromName((scope_name + ".tcm_i").c_str());
+    assert(tcm_scope);
+    m_mem_timing.reset(new xrv1_mem_timing);
+    svPutUserData(tcm_scope, xrv1_mem_timing::dpi_key(), m_mem_timing.get());
+#endif
+    auto* htif_scope = svGetScopeFromName((scope_name + ".tcm_i").c_str());
+    assert(htif_scope);
+    m_htif.reset(new xrv1_htif(m_ctx));
+    svPutUserData(htif_scope, xrv1_htif::dpi_key(), m_htif.get());
 
-    m_rtl->clk_i(m_clk_i);
-    m_rtl->rst_i(m_rst_i);
+    m_rtl->clk_i = 0;
+    m_rtl->rst_i = 0;
 
-    SC_METHOD(async_outputs);
-    sensitive << clk_i;
-    sensitive << rst_i;
+    SC_METHOD(clock_edge);
+    sensitive << clk_i.pos();
+    dont_initialize();
 }
 
-void xrv1_top::async_outputs(void) {
-    m_clk_i.write(clk_i.read());
-    m_rst_i.write(rst_i.read());
+xrv1_top::~xrv1_top() {
+    delete m_rtl;
+    delete m_ctx;
+}
+
+void xrv1_top::clock_edge(void) {
+    if (m_decoupled)
+        return;
+    m_rtl->rst_i = rst_i.read();
+    tick();
+}
+
+void xrv1_top::tick() {
+    m_rtl->clk_i = 1;
+    m_rtl->eval();
+    m_rtl->clk_i = 0;
+    m_rtl->eval();
+    m_cycles++;
+}
+
+void xrv1_top::reset() {
+    m_rtl->rst_i = 1;
+    tick();
+    tick();
+    m_rtl->rst_i = 0;
+}
+
+uint64_t xrv1_top::run_cycles(uint64_t num_cycles) {
+    uint64_t ccnt = 0;
+    while (ccnt < num_cycles && !m_ctx->gotFinish()) {
+        tick();
+        ccnt++;
+    }
+    return ccnt;
+}
+
+bool xrv1_top::is_finished() const {
+    return m_ctx->gotFinish();
 }
 
 void xrv1_top::write_u8(uint32_t addr, uint8_t data) {
+    if (m_sparse) {
+        m_sparse->write_u8(addr, data);
+        return;
+    }
+    svSetScope(m_scope);
     m_rtl->write_u8(addr, data);
 }
 
 uint8_t xrv1_top::read_u8(uint32_t addr) {
+    if (m_sparse)
+        return m_sparse->read_u8(addr);
     char data;
+    svSetScope(m_scope);
     m_rtl->read_u8(addr, &data);
     return static_cast<uint8_t>(data);
 }
 
 bool xrv1_top::get_imem_resp_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_imem_resp_vld(&valid);
     return valid;
 }
 
 uint32_t xrv1_top::get_imem_resp_data() {
     int32_t data;
+    svSetScope(m_scope);
     m_rtl->get_imem_resp_data(&data);
     return static_cast<uint32_t>(data);
 }
 
 bool xrv1_top::get_imem_req_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_imem_req_vld(&valid);
     return valid;
 }
 
 uint32_t xrv1_top::get_imem_req_addr() {
-    char valid;
-    m_rtl->get_imem_req_vld(&valid);
-    return valid;
+    int32_t addr;
+    svSetScope(m_scope);
+    m_rtl->get_imem_req_addr(&addr);
+    return static_cast<uint32_t>(addr);
 }
 
 uint32_t xrv1_top::get_ifetch_insn_data() {
     int32_t data;
+    svSetScope(m_scope);
     m_rtl->get_ifetch_insn_data(&data);
     return static_cast<uint32_t>(data);
 }
 
 uint32_t xrv1_top::get_ifetch_insn_pc() {
     int32_t pc;
+    svSetScope(m_scope);
     m_rtl->get_ifetch_insn_pc(&pc);
     return static_cast<uint32_t>(pc);
 }
 
 bool xrv1_top::get_ifetch_insn_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_ifetch_insn_vld(&valid);
     return valid;
 }
 
 uint32_t xrv1_top::get_if_dec_insn_data() {
     int32_t data;
+    svSetScope(m_scope);
     m_rtl->get_if_dec_insn_data(&data);
     return static_cast<uint32_t>(data);
 }
 
 uint32_t xrv1_top::get_if_dec_insn_pc() {
     int32_t pc;
+    svSetScope(m_scope);
     m_rtl->get_if_dec_insn_pc(&pc);
     return static_cast<uint32_t>(pc);
 }
 
 bool xrv1_top::get_if_dec_insn_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_if_dec_insn_vld(&valid);
     return valid;
 }
 
 bool xrv1_top::get_wb_data_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_wb_data_vld(&valid);
     return valid;
 }
 
 uint32_t xrv1_top::get_wb_data() {
     int32_t data;
+    svSetScope(m_scope);
     m_rtl->get_wb_data(&data);
     return static_cast<uint32_t>(data);
 }
 
 uint8_t xrv1_top::get_wb_rd_addr() {
     char addr;
+    svSetScope(m_scope);
     m_rtl->get_wb_rd_addr(&addr);
     return static_cast<uint8_t>(addr);
 }
 
 bool xrv1_top::get_idecode_issue_vld() {
     char valid;
+    svSetScope(m_scope);
     m_rtl->get_idecode_issue_vld(&valid);
     return valid;
 }
 
 uint8_t xrv1_top::get_idecode_itag() {
     char itag;
+    svSetScope(m_scope);
     m_rtl->get_idecode_itag(&itag);
     return static_cast<uint8_t>(itag);
 }
 
 uint8_t xrv1_top::get_ret_retire_cnt() {
     char cnt;
+    svSetScope(m_scope);
     m_rtl->get_ret_retire_cnt(&cnt);
     return static_cast<uint8_t>(cnt);
 }
 
 uint8_t xrv1_top::get_iq_retire_itag() {
     char itag;
+    svSetScope(m_scope);
     m_rtl->get_iq_retire_itag(&itag);
     return static_cast<uint8_t>(itag);
 }
+
+uint64_t xrv1_top::get_perf_counter(int idx) {
+    long long val = 0;
+    svSetScope(m_scope);
+    m_rtl->get_perf_counter(idx, &val);
+    return static_cast<uint64_t>(val);
+}
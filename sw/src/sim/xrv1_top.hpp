@@ -1,11 +1,15 @@
 #ifndef __XRV1_TOP_21700_HPP__
 #define __XRV1_TOP_21700_HPP__
 
+#include <memory>
 #include <systemc.h>
 #include "memory_base.hpp"
+#include "xrv1_sparse_mem.hpp"
+#include "xrv1_mem_timing.hpp"
+#include "xrv1_htif.hpp"
 
 class Vxrv1_sim_top;
-class VerilatedVcdC;
+class VerilatedContext;
 
 class xrv1_top: public sc_module,
                 public Mem32Iface
@@ -16,8 +20,21 @@ public:
 
     SC_HAS_PROCESS(xrv1_top);
     xrv1_top(sc_module_name name);
+    ~xrv1_top();
 
-    void async_outputs(void);
+    // one cycle per rising clk_i edge unless decoupled
+    void clock_edge(void);
+
+    // In decoupled mode the clock is ignored and the owner runs the model
+    // ahead of SystemC time with run_cycles
+    void set_decoupled(bool decoupled) { m_decoupled = decoupled; }
+    // hold the design in reset for two cycles and release it
+    void reset();
+    // tick up to num_cycles or until $finish, returns number of cycles done
+    uint64_t run_cycles(uint64_t num_cycles);
+    bool is_finished() const;
+    // cycles done since construction, reset included
+    uint64_t get_cycles() const { return m_cycles; }
 
     bool get_imem_req_vld();
     uint32_t get_imem_req_addr();
@@ -43,17 +60,30 @@ public:
     uint8_t get_ret_retire_cnt();
     uint8_t get_iq_retire_itag();
 
+    uint64_t get_perf_counter(int idx);
+
     void write_u8(uint32_t addr, uint8_t data);
     uint8_t read_u8(uint32_t addr);
 
+    // tcm timing model, nullptr in ideal memory builds
+    xrv1_mem_timing* get_mem_timing() { return m_mem_timing.get(); }
+    // tohost handler, its address is taken by the tcm during reset
+    xrv1_htif* get_htif() { return m_htif.get(); }
+
 public:
     Vxrv1_sim_top* m_rtl = nullptr;
-#if 0
-    VerilatedVcdC  * m_vcd;
-#endif
+    VerilatedContext* m_ctx = nullptr;
 private:
-    sc_signal<bool> m_clk_i;
-    sc_signal<bool> m_rst_i;
+    void tick();
+
+    // dpi scope of the top module
+    void* m_scope = nullptr;
+    bool m_decoupled = false;
+    uint64_t m_cycles = 0;
+    // backing store of the sparse ram, nullptr in array ram builds
+    std::unique_ptr<xrv1_sparse_mem> m_sparse;
+    std::unique_ptr<xrv1_mem_timing> m_mem_timing;
+    std::unique_ptr<xrv1_htif> m_htif;
 };
 
 #endif /* __XRV1_TOP_21700_HPP__ */
@@ -0,0 +1,221 @@
+#include "xrv1_trace.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// verilator includes
+#include "Vxrv1_sim_top.h"
+#include "verilated.h"
+#ifdef XRV1_TRACE_VCD
+#include "verilated_vcd_c.h"
+#endif
+#ifdef XRV1_TRACE_FST
+#include "verilated_fst_c.h"
+#endif
+
+#ifdef XRV1_TRACE_VCD
+// VCD output file which hands buffers over to a writer thread, so that
+// simulation only waits for the disk once k_max_pending buffers are queued.
+class xrv1_async_vcd_file : public VerilatedVcdFile {
+public:
+    // buffers queued for the writer before write() blocks
+    static constexpr size_t k_max_pending = 64;
+    // written buffers kept for reuse
+    static constexpr size_t k_max_free = 8;
+
+    xrv1_async_vcd_file() = default;
+    ~xrv1_async_vcd_file() override {
+        close();
+    }
+
+    bool open(const std::string& name) override {
+        m_fp = fopen(name.c_str(), "wb");
+        if (!m_fp)
+            return false;
+        m_stop = false;
+        m_writer = std::thread(&xrv1_async_vcd_file::writer_loop, this);
+        return true;
+    }
+
+    void close() override {
+        if (!m_fp)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_writer.join();
+        fclose(m_fp);
+        m_fp = nullptr;
+    }
+
+    ssize_t write(const char* bufp, ssize_t len) override {
+        std::vector<char> buf;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            // reuse buffers the writer is done with
+            if (!m_free.empty()) {
+                buf = std::move(m_free.back());
+                m_free.pop_back();
+            }
+        }
+        buf.assign(bufp, bufp + len);
+        {
+            // dropping would corrupt the dump, wait for the writer instead
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_cv.wait(lock, [this] { return m_pending.size() < k_max_pending; });
+            m_pending.push_back(std::move(buf));
+        }
+        m_cv.notify_all();
+        return len;
+    }
+
+private:
+    void writer_loop() {
+        std::unique_lock<std::mutex> lock(m_lock);
+        while (true) {
+            m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+            if (m_pending.empty() && m_stop)
+                break;
+            std::vector<char> buf = std::move(m_pending.front());
+            m_pending.pop_front();
+            lock.unlock();
+            m_cv.notify_all();
+            fwrite(buf.data(), 1, buf.size(), m_fp);
+            lock.lock();
+            if (m_free.size() < k_max_free)
+                m_free.push_back(std::move(buf));
+        }
+    }
+
+    FILE* m_fp = nullptr;
+    std::thread m_writer;
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    std::deque<std::vector<char>> m_pending;
+    std::vector<std::vector<char>> m_free;
+    bool m_stop = false;
+};
+#endif
+
+xrv1_tracer::xrv1_tracer(const xrv1_trace_cfg& cfg) :
+    m_cfg(cfg)
+{
+}
+
+xrv1_tracer::~xrv1_tracer() {
+    close();
+}
+
+bool xrv1_tracer::is_supported(xrv1_trace_mode mode) {
+    switch (mode) {
+    case xrv1_trace_mode::OFF:
+        return true;
+    case xrv1_trace_mode::VCD:
+#ifdef XRV1_TRACE_VCD
+        return true;
+#else
+        return false;
+#endif
+    case xrv1_trace_mode::FST:
+#ifdef XRV1_TRACE_FST
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool xrv1_tracer::open(Vxrv1_sim_top* rtl) {
+    if (!is_supported(m_cfg.mode)) {
+        printf("Requested trace format is not compiled in, see TRACE_FORMAT cmake option\n");
+        return false;
+    }
+
+#ifdef XRV1_TRACE_VCD
+    if (m_cfg.mode == xrv1_trace_mode::VCD) {
+        const std::string path = m_cfg.path.empty() ? "out.vcd" : m_cfg.path;
+        m_vcd_file = new xrv1_async_vcd_file;
+        m_vcd = new VerilatedVcdC(m_vcd_file);
+        rtl->trace(m_vcd, m_cfg.depth);
+        m_vcd->open(path.c_str());
+        if (!m_vcd->isOpen()) {
+            printf("Failed to open trace file: %s\n", path.c_str());
+            close();
+            return false;
+        }
+    }
+#endif
+#ifdef XRV1_TRACE_FST
+    if (m_cfg.mode == xrv1_trace_mode::FST) {
+        const std::string path = m_cfg.path.empty() ? "out.fst" : m_cfg.path;
+        m_fst = new VerilatedFstC;
+        rtl->trace(m_fst, m_cfg.depth);
+        m_fst->open(path.c_str());
+        if (!m_fst->isOpen()) {
+            printf("Failed to open trace file: %s\n", path.c_str());
+            close();
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+void xrv1_tracer::close() {
+    m_active = false;
+#ifdef XRV1_TRACE_VCD
+    if (m_vcd) {
+        m_vcd->close();
+        delete m_vcd;
+        m_vcd = nullptr;
+    }
+    delete m_vcd_file;
+    m_vcd_file = nullptr;
+#endif
+#ifdef XRV1_TRACE_FST
+    if (m_fst) {
+        m_fst->close();
+        delete m_fst;
+        m_fst = nullptr;
+    }
+#endif
+}
+
+void xrv1_tracer::on_cycle(uint64_t cycle, const xrv1_obs_snapshot& snap) {
+    if (m_done)
+        return;
+
+    m_retired += snap.ret_retire_cnt();
+    if (snap.if_dec_insn_vld() && snap.if_dec_insn_pc() == static_cast<uint32_t>(m_cfg.start_pc))
+        m_pc_hit = true;
+
+    if (m_cfg.stop_cycle != -1 && static_cast<int64_t>(cycle) >= m_cfg.stop_cycle) {
+        m_active = false;
+        m_done = true;
+        return;
+    }
+
+    if (!m_active) {
+        m_active = static_cast<int64_t>(cycle) >= m_cfg.start_cycle &&
+                   (m_cfg.start_pc == -1 || m_pc_hit) &&
+                   (m_cfg.start_retire == -1 || static_cast<int64_t>(m_retired) >= m_cfg.start_retire);
+    }
+}
+
+void xrv1_tracer::dump_now(uint64_t time) {
+#ifdef XRV1_TRACE_VCD
+    if (m_vcd)
+        m_vcd->dump(time);
+#endif
+#ifdef XRV1_TRACE_FST
+    if (m_fst)
+        m_fst->dump(time);
+#endif
+}
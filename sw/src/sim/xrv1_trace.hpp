@@ -0,0 +1,81 @@
+#ifndef __XRV1_TRACE_HPP__
+#define __XRV1_TRACE_HPP__
+
+#include <cstdint>
+#include <string>
+
+#include "xrv1_observers.hpp"
+
+class Vxrv1_sim_top;
+class VerilatedVcdC;
+class VerilatedFstC;
+class xrv1_async_vcd_file;
+
+enum class xrv1_trace_mode {
+    OFF,
+    VCD,
+    FST
+};
+
+// Runtime trace configuration. Cycles are counted from reset release,
+// the window opens once all of the start conditions are met and closes
+// at stop_cycle.
+struct xrv1_trace_cfg {
+    xrv1_trace_mode mode = xrv1_trace_mode::OFF;
+    // output file, "out.vcd" or "out.fst" if empty
+    std::string path;
+    // first cycle to dump
+    int64_t start_cycle = 0;
+    // cycle to stop dumping at, -1 means never
+    int64_t stop_cycle = -1;
+    // start once instruction with this pc reaches decode, -1 to ignore
+    int64_t start_pc = -1;
+    // start once this many instructions retired, -1 to ignore
+    int64_t start_retire = -1;
+    // hierarchy depth passed to verilator
+    int depth = 99;
+};
+
+// Owns the waveform writer and decides which cycles go into it.
+// Used as an observer of xrv1_soc::run_cycles.
+class xrv1_tracer {
+public:
+    static constexpr bool k_needs_snapshot = true;
+
+    xrv1_tracer(const xrv1_trace_cfg& cfg);
+    ~xrv1_tracer();
+
+    // attach to the design and open the output file
+    bool open(Vxrv1_sim_top* rtl);
+    // flush and close the output file
+    void close();
+
+    // update trace window state
+    void on_cycle(uint64_t cycle, const xrv1_obs_snapshot& snap);
+    // dump design state if inside trace window
+    void dump(uint64_t time) {
+        if (m_active)
+            dump_now(time);
+    }
+
+    // check whether format is compiled into the model
+    static bool is_supported(xrv1_trace_mode mode);
+
+private:
+    void dump_now(uint64_t time);
+
+    xrv1_trace_cfg m_cfg;
+    // currently dumping
+    bool m_active = false;
+    // start pc has been seen
+    bool m_pc_hit = false;
+    // window has been closed for good
+    bool m_done = false;
+    uint64_t m_retired = 0;
+
+    VerilatedVcdC* m_vcd = nullptr;
+    VerilatedFstC* m_fst = nullptr;
+    xrv1_async_vcd_file* m_vcd_file = nullptr;
+};
+
+#endif /* __XRV1_TRACE_HPP__ */
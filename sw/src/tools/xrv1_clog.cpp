@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "CLI/CLI.hpp"
+#include "isa_sim/riscv_inst_dump.h"
+#include "xrv1_commit_log.hpp"
+
+// Decoder of binary commit logs written by xrv1_soc::set_commit_log.
+// Input may be plain or gzip compressed, output is text which could
+// be gzip compressed on the fly.
+
+class text_out {
+public:
+    bool open(const std::string& path, bool compress) {
+        if (compress) {
+            m_gz = gzopen(path.c_str(), "wb6");
+            return m_gz != nullptr;
+        }
+        m_fp = path.empty() ? stdout : fopen(path.c_str(), "w");
+        return m_fp != nullptr;
+    }
+    void close() {
+        if (m_gz)
+            gzclose(m_gz);
+        if (m_fp && m_fp != stdout)
+            fclose(m_fp);
+        m_gz = nullptr;
+        m_fp = nullptr;
+    }
+    void write(const char* str, size_t len) {
+        if (m_gz)
+            gzwrite(m_gz, str, len);
+        else
+            fwrite(str, 1, len, m_fp);
+    }
+private:
+    gzFile m_gz = nullptr;
+    FILE* m_fp = nullptr;
+};
+
+int main(int argc, char** argv) {
+    CLI::App app("xrv1_clog");
+    std::string in_path;
+    std::string out_path;
+    uint32_t pc_min = 0;
+    uint32_t pc_max = ~0u;
+    bool compress = false;
+    bool no_disasm = false;
+    app.add_option("-i,--input", in_path, "Binary commit log")
+           ->required()
+           ->check(CLI::ExistingFile);
+    app.add_option("-o,--output", out_path, "Text output, stdout if not set");
+    app.add_option("--pc-min", pc_min, "Lowest pc to print");
+    app.add_option("--pc-max", pc_max, "Highest pc to print");
+    app.add_flag("-z,--gzip", compress, "Gzip compress output");
+    app.add_flag("--no-disasm", no_disasm, "Print raw instruction words");
+    CLI11_PARSE(app, argc, argv);
+
+    if (compress && out_path.empty()) {
+        printf("Compressed output needs an output file\n");
+        return 1;
+    }
+
+    // gzread reads uncompressed files as is
+    gzFile in = gzopen(in_path.c_str(), "rb");
+    if (!in) {
+        printf("Failed to open %s\n", in_path.c_str());
+        return 1;
+    }
+
+    xrv1_clog_header hdr;
+    if (gzread(in, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+        memcmp(hdr.magic, XRV1_CLOG_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.version != XRV1_CLOG_VERSION ||
+        hdr.rec_size != sizeof(xrv1_commit_rec)) {
+        printf("%s is not a supported commit log\n", in_path.c_str());
+        gzclose(in);
+        return 1;
+    }
+
+    text_out out;
+    if (!out.open(out_path, compress)) {
+        printf("Failed to open %s\n", out_path.c_str());
+        gzclose(in);
+        return 1;
+    }
+
+    std::vector<xrv1_commit_rec> recs(4096);
+    char dis[1024];
+    char line[1280];
+    uint64_t total = 0;
+    uint64_t printed = 0;
+
+    while (true) {
+        int bytes = gzread(in, recs.data(), recs.size() * sizeof(xrv1_commit_rec));
+        if (bytes <= 0)
+            break;
+        size_t num = bytes / sizeof(xrv1_commit_rec);
+        total += num;
+        for (size_t i = 0; i < num; i++) {
+            const xrv1_commit_rec& rec = recs[i];
+            // filter before doing any formatting
+            if (rec.pc < pc_min || rec.pc > pc_max)
+                continue;
+            if (no_disasm)
+                snprintf(dis, sizeof(dis), "%08x: %08x", rec.pc, rec.insn);
+            else
+                riscv_inst_decode(dis, sizeof(dis), rec.pc, rec.insn);
+            int len;
+            if (rec.flags & XRV1_CLOG_F_WB)
+                len = snprintf(line, sizeof(line), "%10llu %s itag=%d RF[%d] <- 0x%x\n",
+                               static_cast<unsigned long long>(rec.cycle), dis, rec.itag, rec.rd, rec.wb_data);
+            else
+                len = snprintf(line, sizeof(line), "%10llu %s itag=%d\n",
+                               static_cast<unsigned long long>(rec.cycle), dis, rec.itag);
+            out.write(line, len);
+            printed++;
+        }
+    }
+
+    out.close();
+    gzclose(in);
+
+    fprintf(stderr, "%llu records, %llu printed\n",
+            static_cast<unsigned long long>(total), static_cast<unsigned long long>(printed));
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+#include "xrv1_coverage.hpp"
+
+// Merges coverage.dat files of debug model runs (e.g. per test files of
+// xrv1_regress_debug --coverage) into one file and prints a summary.
+// verilator_coverage --annotate gives per source line reports of the result.
+
+int main(int argc, char** argv) {
+    CLI::App app("xrv1_covmerge");
+    std::vector<std::string> inputs;
+    std::string out_path;
+    bool quiet = false;
+    app.add_option("inputs", inputs, "coverage.dat files or directories of them")
+           ->required()
+           ->check(CLI::ExistingPath);
+    app.add_option("-o,--output", out_path, "Merged coverage.dat");
+    app.add_flag("-q,--quiet", quiet, "Don't print the summary");
+    CLI11_PARSE(app, argc, argv);
+
+    xrv1_coverage cov;
+    size_t num_files = 0;
+    for (const auto& input : inputs) {
+        if (std::filesystem::is_directory(input)) {
+            const int merged = cov.merge_dir(input);
+            if (merged < 0)
+                return 1;
+            num_files += merged;
+        } else if (cov.merge_file(input)) {
+            num_files++;
+        } else {
+            printf("Failed to read coverage %s\n", input.c_str());
+            return 1;
+        }
+    }
+
+    if (!out_path.empty() && !cov.write(out_path)) {
+        printf("Failed to write %s\n", out_path.c_str());
+        return 1;
+    }
+    if (!quiet) {
+        printf("Merged %zu files\n", num_files);
+        cov.print();
+    }
+    return 0;
+}